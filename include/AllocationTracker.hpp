@@ -0,0 +1,96 @@
+/**
+ * @file AllocationTracker.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-05-05
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include <cstdint>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief The heap allocations made by a thread while it was tracked
+ *
+ * Sizes are the usable sizes of the blocks, which may exceed the requested sizes.
+ */
+struct AllocationStats {
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t allocatedBytes = 0;
+    uint64_t freedBytes = 0;
+    /// the highest number of live bytes above the start of the tracking
+    uint64_t peakBytes = 0;
+    /// false if the allocations were not tracked
+    bool measured = false;
+
+    /**
+     * @brief Get the bytes allocated but not freed while tracked
+     *
+     * Memory freed by another thread or after the tracking ended counts as leaked.
+     *
+     * @return int64_t the leaked bytes, negative if more was freed than allocated
+     */
+    inline int64_t leakedBytes() const { return static_cast<int64_t>(allocatedBytes - freedBytes); }
+};
+
+/**
+ * @brief Counts the allocations of threads through the global operator new and delete
+ *
+ * The replacements of the global operators are only part of the library if
+ * it is built with PIDGEON_PULSE_TRACK_ALLOCATIONS, which is off by default
+ * as they replace the operators of every program linking the library. They
+ * need malloc_usable_size() or malloc_size() to size freed blocks. The counters are
+ * thread local, so tracking needs neither locks nor atomics, and threads
+ * outside of a Scope only pay for a single check.
+ * malloc() and free() are not counted.
+ */
+class AllocationTracker {
+public:
+    /**
+     * @brief Counts the allocations of the current thread while it is alive
+     *
+     * Scopes can be nested, every scope sees the allocations since its construction.
+     * A scope has to be destroyed on the thread that created it.
+     */
+    class Scope {
+    private:
+        AllocationStats mStart;
+        int64_t mStartLive;
+        int64_t mOuterPeak;
+
+    public:
+        Scope();
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /**
+         * @brief Get the allocations since the scope was created
+         *
+         * @return AllocationStats the allocations of this thread
+         */
+        AllocationStats stats() const;
+    };
+
+    /**
+     * @brief Check if the library replaces the global operator new and delete
+     *
+     * @return true allocations are counted
+     * @return false every Scope reports no allocations
+     */
+    static bool available();
+
+    /**
+     * @brief Warn once that allocation assertions are not checked
+     */
+    static void warnUnavailable();
+};
+
+} // namespace PidgeonPulse
@@ -0,0 +1,207 @@
+/**
+ * @file AppendList.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-05-03
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <thread>
+#include <utility>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief A list that many threads can append to without locks
+ *
+ * Used for the registration of collections and tests, which may happen from
+ * concurrent static initializers. An append claims a slot with a single
+ * atomic increment. The slots live in chunks of doubling size that are never
+ * moved, so references to the elements stay valid.
+ * Reading and clearing the list must not race with appends, which holds for
+ * running the tests after they were registered.
+ *
+ * @tparam T the type of the elements, default constructible
+ */
+template<typename T>
+class AppendList {
+private:
+    static constexpr size_t FIRST_CHUNK_BITS = 6;
+    static constexpr size_t CHUNK_COUNT = 48;
+
+    /**
+     * @brief An element and whether its append finished
+     */
+    struct Slot {
+        T value{};
+        std::atomic<bool> ready = false;
+    };
+
+    std::array<std::atomic<Slot*>, CHUNK_COUNT> mChunks{};
+    std::atomic<size_t> mSize = 0;
+
+    static constexpr size_t chunkSize(size_t chunk) {
+        return size_t(1) << (FIRST_CHUNK_BITS + chunk);
+    }
+
+    /**
+     * @brief Get the slot of an index, allocating its chunk if needed
+     *
+     * @param index the index of the element
+     * @return Slot& the slot
+     */
+    Slot& slotAt(size_t index) {
+        size_t position = index + chunkSize(0);
+        size_t chunk = static_cast<size_t>(std::bit_width(position)) - 1 - FIRST_CHUNK_BITS;
+        size_t offset = position - chunkSize(chunk);
+
+        Slot* slots = mChunks[chunk].load(std::memory_order_acquire);
+        if ( slots == nullptr ) {
+            Slot* allocated = new Slot[chunkSize(chunk)];
+            if ( mChunks[chunk].compare_exchange_strong(slots, allocated, std::memory_order_acq_rel) ) {
+                slots = allocated;
+            } else {
+                // another thread allocated the chunk first
+                delete[] allocated;
+            }
+        }
+        return slots[offset];
+    }
+
+    const Slot& slotAt(size_t index) const {
+        return const_cast<AppendList*>(this)->slotAt(index);
+    }
+
+public:
+    /**
+     * @brief Iterates over the elements in the order their slots were claimed
+     *
+     * @tparam List the list, const for a const_iterator
+     * @tparam Value the type of the elements
+     */
+    template<typename List, typename Value>
+    class Iterator {
+    private:
+        List* mList;
+        size_t mIndex;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        Iterator(): mList(nullptr), mIndex(0) {}
+        Iterator(List* list, size_t index): mList(list), mIndex(index) {}
+
+        reference operator*() const { return (*mList)[mIndex]; }
+        pointer operator->() const { return &(*mList)[mIndex]; }
+
+        Iterator& operator++() {
+            mIndex++;
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator previous = *this;
+            mIndex++;
+            return previous;
+        }
+
+        bool operator==(const Iterator& other) const { return mIndex == other.mIndex; }
+        bool operator!=(const Iterator& other) const { return mIndex != other.mIndex; }
+    };
+
+    using iterator = Iterator<AppendList, T>;
+    using const_iterator = Iterator<const AppendList, const T>;
+
+    AppendList() = default;
+
+    ~AppendList() {
+        for ( auto& chunk : mChunks ) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    AppendList(const AppendList&) = delete;
+    AppendList& operator=(const AppendList&) = delete;
+
+    /**
+     * @brief Append an element, safe to call from any number of threads
+     *
+     * @param value the element
+     * @return size_t the index of the element
+     */
+    size_t push_back(T value) {
+        size_t index = mSize.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slotAt(index);
+        slot.value = std::move(value);
+        slot.ready.store(true, std::memory_order_release);
+        return index;
+    }
+
+    /**
+     * @brief Get an element
+     *
+     * Waits for an append that claimed the slot but did not store the element yet.
+     *
+     * @param index the index of the element, less than size()
+     * @return T& the element
+     */
+    T& operator[](size_t index) {
+        Slot& slot = slotAt(index);
+        while ( !slot.ready.load(std::memory_order_acquire) ) {
+            std::this_thread::yield();
+        }
+        return slot.value;
+    }
+
+    const T& operator[](size_t index) const {
+        return const_cast<AppendList&>(*this)[index];
+    }
+
+    /**
+     * @brief Get the number of claimed slots
+     *
+     * @return size_t the number of elements
+     */
+    inline size_t size() const { return mSize.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Check if nothing was appended
+     *
+     * @return true the list is empty
+     */
+    inline bool empty() const { return size() == 0; }
+
+    /**
+     * @brief Remove all elements, keeping the chunks for reuse
+     *
+     * @note Must not race with appends or reads.
+     */
+    void clear() {
+        size_t size = mSize.exchange(0, std::memory_order_acq_rel);
+        for ( size_t index = 0; index < size; index++ ) {
+            Slot& slot = slotAt(index);
+            slot.value = T{};
+            slot.ready.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+};
+
+} // namespace PidgeonPulse
@@ -0,0 +1,331 @@
+/**
+ * @file Assertion.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <ostream>
+#include <ranges>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief Types that can be written to an output stream
+ */
+template<typename T>
+concept Streamable = requires (std::ostream& os, const T& value) {
+    os << value;
+};
+
+/**
+ * @brief Tuple like types that are not ranges, e.g. std::pair and std::tuple
+ */
+template<typename T>
+concept TupleLike = !std::ranges::range<const T> && requires {
+    std::tuple_size<T>::value;
+};
+
+/**
+ * @brief Outputs that text can be appended to, e.g. std::string or MessageBuffer
+ */
+template<typename T>
+concept TextOutput = requires (T& output, std::string_view text) {
+    output.append(text);
+};
+
+/**
+ * @brief A fixed size buffer that failure messages are formatted into
+ *
+ * Text beyond the capacity is cut off and marked with "...",
+ * so formatting a failure never touches the heap.
+ */
+class MessageBuffer {
+public:
+    static constexpr size_t CAPACITY = 4096;
+
+private:
+    static constexpr std::string_view ELLIPSIS = "...";
+
+    char mText[CAPACITY];
+    size_t mSize = 0;
+    bool mTruncated = false;
+
+public:
+    MessageBuffer() = default;
+
+    MessageBuffer(const MessageBuffer&) = delete;
+    MessageBuffer& operator=(const MessageBuffer&) = delete;
+
+    /**
+     * @brief Append text, as far as it fits
+     *
+     * @param text the text
+     */
+    void append(std::string_view text) {
+        size_t space = CAPACITY - ELLIPSIS.size() - mSize;
+        if ( text.size() > space ) {
+            text = text.substr(0, space);
+            mTruncated = true;
+        }
+        text.copy(mText + mSize, text.size());
+        mSize += text.size();
+    }
+
+    /**
+     * @brief Get the formatted text
+     *
+     * @return std::string_view the text, ending in "..." if it was cut off
+     */
+    std::string_view text() {
+        if ( mTruncated ) {
+            ELLIPSIS.copy(mText + mSize, ELLIPSIS.size());
+            return {mText, mSize + ELLIPSIS.size()};
+        }
+        return {mText, mSize};
+    }
+};
+
+/**
+ * @brief Forwards the output of a stream to a TextOutput
+ *
+ * @tparam Output the type of the output
+ */
+template<TextOutput Output>
+class OutputStreamBuffer : public std::streambuf {
+private:
+    Output& mOutput;
+
+protected:
+    int_type overflow(int_type character) override {
+        if ( !traits_type::eq_int_type(character, traits_type::eof()) ) {
+            char text = traits_type::to_char_type(character);
+            mOutput.append(std::string_view(&text, 1));
+        }
+        return traits_type::not_eof(character);
+    }
+
+    std::streamsize xsputn(const char* text, std::streamsize count) override {
+        mOutput.append(std::string_view(text, static_cast<size_t>(count)));
+        return count;
+    }
+
+public:
+    explicit OutputStreamBuffer(Output& output): mOutput(output) {}
+};
+
+/**
+ * @brief Write a value as text for a failure message
+ *
+ * The formatter is picked at compile time: strings are quoted, numbers are
+ * written with to_chars, streamable types use their operator<<, ranges
+ * are written element by element and tuples as "(a, b)".
+ * Anything else is shown as "{?}".
+ * This is only called once an assertion failed.
+ *
+ * @tparam Output the type of the output
+ * @tparam T the type of the value
+ * @param output the output to append the text to
+ * @param value the value
+ */
+template<TextOutput Output, typename T>
+void stringify(Output& output, const T& value) {
+    if constexpr ( std::is_same_v<T, bool> ) {
+        output.append(value ? "true" : "false");
+    } else if constexpr ( std::is_same_v<T, std::nullptr_t> ) {
+        output.append("nullptr");
+    } else if constexpr ( std::is_same_v<T, char> ) {
+        const char text[] = {'\'', value, '\''};
+        output.append(std::string_view(text, sizeof(text)));
+    } else if constexpr ( std::is_convertible_v<const T&, std::string_view> ) {
+        if constexpr ( std::is_pointer_v<T> ) {
+            if ( value == nullptr ) {
+                output.append("nullptr");
+                return;
+            }
+        }
+        output.append("\"");
+        output.append(std::string_view(value));
+        output.append("\"");
+    } else if constexpr ( std::is_arithmetic_v<T> ) {
+        char digits[64];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        output.append(std::string_view(digits, result.ptr - digits));
+    } else if constexpr ( std::is_enum_v<T> ) {
+        stringify(output, static_cast<std::underlying_type_t<T>>(value));
+    } else if constexpr ( Streamable<T> ) {
+        OutputStreamBuffer<Output> buffer(output);
+        std::ostream stream(&buffer);
+        stream << value;
+    } else if constexpr ( std::ranges::range<const T> ) {
+        output.append("{");
+        bool first = true;
+        for ( const auto& element : value ) {
+            output.append(first ? " " : ", ");
+            stringify(output, element);
+            first = false;
+        }
+        output.append(first ? "}" : " }");
+    } else if constexpr ( TupleLike<T> ) {
+        output.append("(");
+        std::apply([&output](const auto&... elements) {
+            bool first = true;
+            ((output.append(first ? "" : ", "), stringify(output, elements), first = false), ...);
+        }, value);
+        output.append(")");
+    } else {
+        output.append("{?}");
+    }
+}
+
+/**
+ * @brief Convert a value to a string
+ *
+ * @tparam T the type of the value
+ * @param value the value
+ * @return std::string the text of the value
+ */
+template<typename T>
+std::string stringify(const T& value) {
+    std::string text;
+    stringify(text, value);
+    return text;
+}
+
+/**
+ * @brief A decomposed comparison of two operands
+ *
+ * The comparison is evaluated once on construction, the operands are only
+ * turned into text by expand() when the assertion failed.
+ *
+ * @tparam L the type of the left operand
+ * @tparam R the type of the right operand
+ */
+template<typename L, typename R>
+class BinaryExpression {
+private:
+    const L& mLhs;
+    const R& mRhs;
+    const char* mOperator;
+    bool mResult;
+
+public:
+    BinaryExpression(const L& lhs, const char* op, const R& rhs, bool result)
+    : mLhs(lhs), mRhs(rhs), mOperator(op), mResult(result) {}
+
+    explicit operator bool() const { return mResult; }
+
+    /**
+     * @brief Write the expression with the operands replaced by their values
+     *
+     * @param output the output to append the expanded expression to
+     */
+    template<TextOutput Output>
+    void expand(Output& output) const {
+        stringify(output, mLhs);
+        output.append(" ");
+        output.append(mOperator);
+        output.append(" ");
+        stringify(output, mRhs);
+    }
+
+    // chained comparisons like a == b == c do not mean what they look like
+    template<typename T> void operator==(const T&) const = delete;
+    template<typename T> void operator!=(const T&) const = delete;
+    template<typename T> void operator&&(const T&) const = delete;
+    template<typename T> void operator||(const T&) const = delete;
+};
+
+/**
+ * @brief The left operand of a decomposed expression
+ *
+ * Comparing it with a right operand yields a BinaryExpression. Used on its
+ * own it stands for an expression that is converted to bool.
+ *
+ * @tparam L the type of the operand
+ */
+template<typename L>
+class UnaryExpression {
+private:
+    const L& mValue;
+
+public:
+    explicit UnaryExpression(const L& value): mValue(value) {}
+
+    explicit operator bool() const { return static_cast<bool>(mValue); }
+
+    /**
+     * @brief Write the value of the expression as text
+     *
+     * @param output the output to append the expanded expression to
+     */
+    template<TextOutput Output>
+    void expand(Output& output) const { stringify(output, mValue); }
+
+    template<typename R>
+    BinaryExpression<L, R> operator==(const R& rhs) const { return {mValue, "==", rhs, static_cast<bool>(mValue == rhs)}; }
+
+    template<typename R>
+    BinaryExpression<L, R> operator!=(const R& rhs) const { return {mValue, "!=", rhs, static_cast<bool>(mValue != rhs)}; }
+
+    template<typename R>
+    BinaryExpression<L, R> operator<(const R& rhs) const { return {mValue, "<", rhs, static_cast<bool>(mValue < rhs)}; }
+
+    template<typename R>
+    BinaryExpression<L, R> operator<=(const R& rhs) const { return {mValue, "<=", rhs, static_cast<bool>(mValue <= rhs)}; }
+
+    template<typename R>
+    BinaryExpression<L, R> operator>(const R& rhs) const { return {mValue, ">", rhs, static_cast<bool>(mValue > rhs)}; }
+
+    template<typename R>
+    BinaryExpression<L, R> operator>=(const R& rhs) const { return {mValue, ">=", rhs, static_cast<bool>(mValue >= rhs)}; }
+
+    // a && b can not be decomposed, wrap it in parentheses
+    template<typename R> void operator&&(const R&) const = delete;
+    template<typename R> void operator||(const R&) const = delete;
+};
+
+/**
+ * @brief Captures the left operand of an assertion
+ *
+ * `Decomposer() <= a == b` binds as `(Decomposer() <= a) == b`,
+ * which splits the expression into its operands.
+ */
+struct Decomposer {
+    template<typename L>
+    UnaryExpression<L> operator<=(const L& value) const { return UnaryExpression<L>(value); }
+};
+
+} // namespace PidgeonPulse
+
+/**
+ * @brief Assert an expression inside of a test, stopping the test if it fails
+ *
+ * On failure the report contains the expression and the values of its operands.
+ */
+#define PIDGEON_PULSE_ASSERT(...) \
+    this->assert_expression(::PidgeonPulse::Decomposer() <= __VA_ARGS__, #__VA_ARGS__, true)
+
+/**
+ * @brief Check an expression inside of a test, continuing the test if it fails
+ */
+#define PIDGEON_PULSE_CHECK(...) \
+    this->assert_expression(::PidgeonPulse::Decomposer() <= __VA_ARGS__, #__VA_ARGS__, false)
+
+#ifndef PIDGEON_PULSE_NO_SHORT_MACROS
+#define PP_ASSERT(...) PIDGEON_PULSE_ASSERT(__VA_ARGS__)
+#define PP_CHECK(...) PIDGEON_PULSE_CHECK(__VA_ARGS__)
+#endif
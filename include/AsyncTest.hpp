@@ -0,0 +1,459 @@
+/**
+ * @file AsyncTest.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-05-06
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include "Scheduler.hpp"
+#include "Testable.hpp"
+#include "VirtualClock.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief Resumes the coroutines of one run of an AsyncTest.
+ *
+ * Either hands suspended coroutines back to the workers of a Scheduler,
+ * or queues them for the thread that blocks in drain().
+ */
+class AsyncContext {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    Scheduler* mScheduler = nullptr;
+    VirtualClock* mClock = nullptr;
+    std::function<void()> mFinished;
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<std::coroutine_handle<>> mReady;
+    bool mDone = false;
+
+public:
+    /**
+     * @brief Construct a context that is drained by the calling thread.
+     */
+    AsyncContext() = default;
+
+    /**
+     * @brief Construct a context that resumes on the workers of a Scheduler.
+     *
+     * Every resume makes the clock of the test the current clock of the worker.
+     *
+     * @param scheduler the scheduler to resume on.
+     * @param clock the clock of the test.
+     * @param finished called once the task of the test finished.
+     */
+    AsyncContext(Scheduler& scheduler, VirtualClock& clock, std::function<void()> finished);
+
+    AsyncContext(const AsyncContext&) = delete;
+    AsyncContext& operator=(const AsyncContext&) = delete;
+
+    /**
+     * @brief Resume a suspended coroutine.
+     *
+     * Can be called from any thread, the coroutine does not run on the caller.
+     *
+     * @param handle the coroutine to resume.
+     */
+    void resume(std::coroutine_handle<> handle);
+
+    /**
+     * @brief Resume a suspended coroutine once a duration passed.
+     *
+     * All contexts share one timer thread, so sleeping tests neither
+     * hold on to a worker nor need a thread of their own.
+     *
+     * @param delay the duration to wait.
+     * @param handle the coroutine to resume.
+     */
+    void resume_after(Clock::duration delay, std::coroutine_handle<> handle);
+
+    /**
+     * @brief Called by the task of the test once it finished.
+     */
+    void finish();
+
+    /**
+     * @brief Resume queued coroutines on the calling thread until the task finished.
+     */
+    void drain();
+};
+
+template<typename T = void>
+class Task;
+
+namespace detail {
+
+/**
+ * @brief The part of the promise of a Task that does not depend on the result.
+ */
+struct TaskPromiseBase {
+    AsyncContext* context = nullptr;
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+
+    /**
+     * @brief Continues with the awaiting coroutine, or tells the context that the test finished.
+     */
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            TaskPromiseBase& promise = handle.promise();
+            if ( promise.continuation ) {
+                return promise.continuation;
+            }
+            // the frame may be destroyed by finish(), it is not touched afterwards
+            promise.context->finish();
+            return std::noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() { exception = std::current_exception(); }
+};
+
+template<typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+    void return_value(T result) { value.emplace(std::move(result)); }
+};
+
+template<>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+    void return_void() {}
+};
+
+/**
+ * @brief Get the context of the awaiting coroutine.
+ *
+ * The built in awaitables can only be awaited by a Task.
+ */
+template<typename Promise>
+AsyncContext& context_of(std::coroutine_handle<Promise> handle) {
+    static_assert(std::is_base_of_v<TaskPromiseBase, Promise>, "only a Task can await this");
+    return *handle.promise().context;
+}
+
+}
+
+/**
+ * @brief A lazily started coroutine that returns a T.
+ *
+ * The coroutine starts once the Task is awaited and continues the awaiting
+ * coroutine without going through the scheduler once it finished.
+ * Exceptions are rethrown to the awaiting coroutine.
+ *
+ * @tparam T the type of the result.
+ */
+template<typename T>
+class Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+private:
+    Handle mHandle;
+
+public:
+    explicit Task(Handle handle): mHandle(handle) {}
+
+    Task(Task&& other) noexcept: mHandle(std::exchange(other.mHandle, nullptr)) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if ( this != &other ) {
+            if ( mHandle ) {
+                mHandle.destroy();
+            }
+            mHandle = std::exchange(other.mHandle, nullptr);
+        }
+        return *this;
+    }
+
+    ~Task() {
+        if ( mHandle ) {
+            mHandle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return !mHandle || mHandle.done(); }
+
+    template<typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> awaiting) noexcept {
+        mHandle.promise().context = &detail::context_of(awaiting);
+        mHandle.promise().continuation = awaiting;
+        return mHandle;
+    }
+
+    T await_resume() {
+        if ( mHandle.promise().exception ) {
+            std::rethrow_exception(mHandle.promise().exception);
+        }
+        if constexpr ( !std::is_void_v<T> ) {
+            return std::move(*mHandle.promise().value);
+        }
+    }
+
+    /**
+     * @brief Start the coroutine as the task of a test.
+     *
+     * @param context the context that resumes the coroutine and is told once it finished.
+     */
+    void start(AsyncContext& context) {
+        mHandle.promise().context = &context;
+        context.resume(mHandle);
+    }
+
+    /**
+     * @brief Get the exception the finished coroutine ended with.
+     *
+     * @return std::exception_ptr the exception, null if it returned.
+     */
+    std::exception_ptr exception() const { return mHandle.promise().exception; }
+};
+
+namespace detail {
+
+template<typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+}
+
+/**
+ * @brief Suspend the awaiting Task for a duration without blocking its worker.
+ */
+class SleepAwaiter {
+private:
+    AsyncContext::Clock::duration mDelay;
+
+public:
+    explicit SleepAwaiter(AsyncContext::Clock::duration delay): mDelay(delay) {}
+
+    bool await_ready() const noexcept { return mDelay <= AsyncContext::Clock::duration::zero(); }
+
+    template<typename Promise>
+    void await_suspend(std::coroutine_handle<Promise> handle) {
+        detail::context_of(handle).resume_after(mDelay, handle);
+    }
+
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Sleep without blocking the worker.
+ *
+ * The timers have a resolution of a millisecond.
+ *
+ * @param delay the duration to sleep.
+ * @return SleepAwaiter the awaitable.
+ */
+template<typename Rep, typename Period>
+SleepAwaiter sleep_for(std::chrono::duration<Rep, Period> delay) {
+    return SleepAwaiter(std::chrono::duration_cast<AsyncContext::Clock::duration>(delay));
+}
+
+/**
+ * @brief Give the worker to other tests and continue later.
+ */
+class YieldAwaiter {
+public:
+    bool await_ready() const noexcept { return false; }
+
+    template<typename Promise>
+    void await_suspend(std::coroutine_handle<Promise> handle) {
+        detail::context_of(handle).resume(handle);
+    }
+
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Give the worker to other tests and continue later.
+ *
+ * @return YieldAwaiter the awaitable.
+ */
+inline YieldAwaiter yield_now() {
+    return {};
+}
+
+/**
+ * @brief A value that is set once, possibly from another thread, and awaited by a single Task.
+ *
+ * Bridges callbacks of the code under test, e.g. an I/O completion, into a Task.
+ *
+ * @tparam T the type of the value.
+ */
+template<typename T = std::monostate>
+class Completion {
+private:
+    std::mutex mMutex;
+    std::optional<T> mValue;
+    std::coroutine_handle<> mWaiter;
+    AsyncContext* mContext = nullptr;
+
+public:
+    Completion() = default;
+
+    Completion(const Completion&) = delete;
+    Completion& operator=(const Completion&) = delete;
+
+    /**
+     * @brief Set the value and resume the awaiting Task.
+     *
+     * @param value the value.
+     */
+    void set(T value = T{}) {
+        std::coroutine_handle<> waiter;
+        AsyncContext* context;
+        {
+            std::lock_guard lock(mMutex);
+            mValue.emplace(std::move(value));
+            waiter = std::exchange(mWaiter, nullptr);
+            context = mContext;
+        }
+        if ( waiter ) {
+            context->resume(waiter);
+        }
+    }
+
+    /**
+     * @brief Check if the value was set.
+     *
+     * @return true set() was called.
+     */
+    bool is_set() {
+        std::lock_guard lock(mMutex);
+        return mValue.has_value();
+    }
+
+    bool await_ready() noexcept { return is_set(); }
+
+    template<typename Promise>
+    bool await_suspend(std::coroutine_handle<Promise> handle) {
+        std::lock_guard lock(mMutex);
+        if ( mValue ) {
+            return false;
+        }
+        mWaiter = handle;
+        mContext = &detail::context_of(handle);
+        return true;
+    }
+
+    T await_resume() {
+        std::lock_guard lock(mMutex);
+        return std::move(*mValue);
+    }
+};
+
+/**
+ * @brief Simulate an I/O operation that completes after a latency.
+ *
+ * Like a real operation, the awaiting Task gives up its worker while the
+ * operation is pending and continues on any worker once it completed.
+ *
+ * @tparam T the type of the result.
+ * @param latency the time until the operation completes.
+ * @param result the result of the operation.
+ * @return Task<T> the operation.
+ */
+template<typename T, typename Rep, typename Period>
+Task<T> simulate_io(std::chrono::duration<Rep, Period> latency, T result) {
+    co_await sleep_for(latency);
+    co_return result;
+}
+
+/**
+ * @brief A test whose body is a coroutine.
+ *
+ * Assertions and failures work as in a Testable. While the body is suspended
+ * on one of the awaitables above, its worker runs other tests, so thousands
+ * of sleeping tests share the workers of the TestController.
+ *
+ * Tests with a timeout, tests run in isolation and tests that are called
+ * directly block a thread until their body finished.
+ * The cpu time, the allocations and the hardware events are only measured
+ * for those, a body that moves between workers has no thread to measure.
+ */
+class AsyncTest : public Testable {
+private:
+    std::optional<Task<>> mTask;
+    std::unique_ptr<AsyncContext> mContext;
+    RunPhase mPhase;
+
+protected:
+    /**
+     * @brief The body of the test.
+     *
+     * @return Task<> the coroutine to run.
+     */
+    virtual Task<> run_async() = 0;
+
+public:
+    /**
+     * @brief Construct a new AsyncTest object.
+     *
+     * @param name the name of the test.
+     */
+    AsyncTest(std::string name);
+
+    /**
+     * @brief Run the body of the test and block until it finished.
+     *
+     * The coroutines of the body are resumed on the calling thread.
+     */
+    void run() override;
+
+    /**
+     * @brief Start a run of the test without waiting for it.
+     *
+     * Sets the test up and queues the body on the calling worker. Once the
+     * body finished, the test is torn down on the worker that resumed it last,
+     * then finished is called.
+     *
+     * The body moves between workers, so neither its cpu time nor its allocations
+     * nor its hardware events are measured, the metrics report them as not measured.
+     *
+     * @param stopToken the stop token of the run.
+     * @param scheduler the scheduler to resume the body on.
+     * @param finished called once the run finished.
+     */
+    void start(std::stop_token stopToken, Scheduler& scheduler, std::function<void()> finished);
+};
+
+} // namespace PidgeonPulse
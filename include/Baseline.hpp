@@ -0,0 +1,125 @@
+/**
+ * @file Baseline.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-05-04
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include "Reporter.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief Timing results of earlier runs that later runs are compared against
+ *
+ * Tests are identified by the key of the TimingCache. A benchmark keeps the
+ * ns/op of every sample of its last recorded run, any other test keeps a
+ * window of the durations of its last runs in seconds.
+ * The baseline is stored as a versioned binary file.
+ */
+class Baseline {
+private:
+    std::unordered_map<uint64_t, std::vector<float>> mSamples;
+
+public:
+    /// number of durations kept for a test that is no benchmark
+    static constexpr size_t WINDOW = 32;
+    /// number of samples needed before a test is compared at all
+    static constexpr size_t MIN_SAMPLES = 5;
+    /// slowdown in seconds of a test that is never reported, its duration is mostly noise
+    static constexpr double DURATION_NOISE_FLOOR = 0.001;
+    /// the p-value below which a slowdown is considered significant
+    static constexpr double SIGNIFICANCE = 0.05;
+
+    /**
+     * @brief Load the baseline from a file
+     *
+     * @param path the path of the baseline file
+     * @return true the baseline was loaded
+     * @return false the file does not exist or is no valid baseline of this version
+     */
+    bool load(const std::string& path);
+
+    /**
+     * @brief Save the baseline to a file
+     *
+     * The file is replaced atomically, so concurrent runs never see a partial baseline.
+     *
+     * @param path the path of the baseline file
+     * @return true the baseline was saved
+     * @return false the file could not be written
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Replace the samples of a test, used for benchmarks
+     *
+     * @param key the key of the test
+     * @param samples the samples of the current run
+     */
+    void replace(uint64_t key, const std::vector<double>& samples);
+
+    /**
+     * @brief Add a duration to the window of a test, dropping the oldest one
+     *
+     * @param key the key of the test
+     * @param sample the duration of the current run
+     */
+    void append(uint64_t key, double sample);
+
+    /**
+     * @brief Get the recorded samples of a test
+     *
+     * @param key the key of the test
+     * @return const std::vector<float>* the samples, nullptr if the test is unknown
+     */
+    const std::vector<float>* lookup(uint64_t key) const;
+
+    /**
+     * @brief Get the number of known tests
+     *
+     * @return size_t the number of tests
+     */
+    inline size_t size() const { return mSamples.size(); }
+
+    /**
+     * @brief Get the one-sided p-value of the current samples being larger
+     *
+     * Uses the Mann-Whitney U test with the normal approximation and a
+     * correction for ties. A single current sample is ranked exactly against
+     * the baseline instead.
+     *
+     * @param baseline the samples of the baseline
+     * @param current the samples of the current run
+     * @return double the p-value, 1 if either side has no samples
+     */
+    static double slowerPValue(const std::vector<float>& baseline, const std::vector<double>& current);
+
+    /**
+     * @brief Compare the current samples of a test with its baseline
+     *
+     * A test regressed if its median grew by more than the tolerance and
+     * by more than the noise floor, and the slowdown is significant.
+     *
+     * @param baseline the samples of the baseline
+     * @param current the samples of the current run
+     * @param tolerance the allowed relative slowdown, e.g. 0.1 for 10%
+     * @param noiseFloor the difference of the medians that is never reported
+     * @return BaselineComparison the result of the comparison
+     */
+    static BaselineComparison compare(const std::vector<float>& baseline, const std::vector<double>& current,
+                                      double tolerance, double noiseFloor = 0);
+};
+
+} // namespace PidgeonPulse
@@ -0,0 +1,173 @@
+/**
+ * @file Benchmark.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-21
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include "Testable.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief Prevent the compiler from optimizing away a value.
+ *
+ * The value is treated as if it was read by code the compiler can not see.
+ *
+ * @tparam T the type of the value.
+ * @param value the value to keep alive.
+ */
+template<typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static const volatile void* sink;
+    sink = &value;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+/**
+ * @brief Prevent the compiler from optimizing away a value.
+ *
+ * The value is treated as if it was read and modified by code the compiler can not see.
+ *
+ * @tparam T the type of the value.
+ * @param value the value to keep alive.
+ */
+template<typename T>
+inline void do_not_optimize(T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : "+m"(value) : : "memory");
+#else
+    static volatile void* sink;
+    sink = &value;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+/**
+ * @brief Force all pending writes to memory.
+ *
+ * Prevents the compiler from removing stores that are never read again.
+ */
+inline void clobber() {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+/**
+ * @brief Options controlling how a Benchmark is measured.
+ */
+struct BenchmarkOptions {
+    /// number of samples to take
+    uint32_t samples = 30;
+    /// time spent running the benchmark before measuring
+    std::chrono::nanoseconds warmup_time = std::chrono::milliseconds(100);
+    /// target duration of a single sample, used to calibrate the iteration count
+    std::chrono::nanoseconds sample_time = std::chrono::milliseconds(10);
+    /// upper bound for the number of iterations per sample
+    uint64_t max_iterations = uint64_t(1) << 32;
+};
+
+/**
+ * @brief The results of a Benchmark.
+ *
+ * All times are in nanoseconds per operation.
+ */
+struct BenchmarkStats {
+    uint64_t iterations = 0;
+    double min = 0;
+    double median = 0;
+    double p99 = 0;
+    double mean = 0;
+    double stddev = 0;
+    std::vector<double> samples;
+};
+
+/**
+ * @brief A Testable that measures the time of an operation.
+ *
+ * Derived classes implement iteration() with the code to measure.
+ * The benchmark is warmed up, the number of iterations per sample is
+ * calibrated to the configured sample time and the configured number of
+ * samples is taken. Assertions can still be used to fail the benchmark.
+ * The TestController runs benchmarks one at a time once all other tests
+ * finished, so the samples do not include the load of other workers.
+ */
+class Benchmark : public Testable {
+private:
+    BenchmarkOptions mOptions;
+    BenchmarkStats mStats;
+
+    /**
+     * @brief Measure a number of iterations.
+     *
+     * @param iterations the number of iterations to run.
+     * @return std::chrono::nanoseconds the time it took.
+     */
+    std::chrono::nanoseconds measure(uint64_t iterations);
+
+    /**
+     * @brief Find the number of iterations that fills one sample.
+     *
+     * @return uint64_t the number of iterations per sample.
+     */
+    uint64_t calibrate();
+
+protected:
+    /**
+     * @brief The operation to measure.
+     *
+     * Use do_not_optimize() and clobber() to keep the compiler from
+     * removing the measured code.
+     */
+    virtual void iteration() = 0;
+
+    /**
+     * @brief Run a batch of iterations.
+     *
+     * Derived classes can override this to run the operation in a loop
+     * without the virtual call to iteration().
+     *
+     * @param count the number of iterations to run.
+     */
+    virtual void iterations(uint64_t count);
+
+public:
+    /**
+     * @brief Construct a new Benchmark object.
+     *
+     * @param name the name of the benchmark.
+     * @param options the options for measuring the benchmark.
+     */
+    Benchmark(std::string name, BenchmarkOptions options = {});
+
+    /**
+     * @brief Warm up, calibrate and sample the benchmark.
+     */
+    void run() final;
+
+    /**
+     * @brief Get the results of the benchmark.
+     *
+     * @return const BenchmarkStats& the results.
+     */
+    const BenchmarkStats& get_stats() const;
+};
+
+} // namespace PidgeonPulse
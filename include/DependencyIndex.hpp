@@ -0,0 +1,111 @@
+/**
+ * @file DependencyIndex.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-05-02
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief Remembers the source files every test depends on
+ *
+ * Used to run only the tests a change can affect. The index is stored as a
+ * text file with one line per test, `collection<TAB>test<TAB>file<TAB>file...`,
+ * so it can also be written by tools, e.g. from per-test coverage data.
+ * Paths are relative to the root of the repository, a path ending in `/`
+ * stands for every file below that directory.
+ */
+class DependencyIndex {
+private:
+    std::unordered_map<std::string, std::vector<std::string>> mDependencies;
+
+    /**
+     * @brief Get the key of a test
+     *
+     * @param collection the name of the collection
+     * @param test the name of the test
+     * @return std::string the key of the test
+     */
+    static std::string key(std::string_view collection, std::string_view test);
+
+public:
+    /**
+     * @brief Bring a path into the form used by the index
+     *
+     * Removes leading `./`, so `./src/a.cpp` and `src/a.cpp` are the same file.
+     *
+     * @param path the path
+     * @return std::string_view the normalized path, a view into path
+     */
+    static std::string_view normalize(std::string_view path);
+
+    /**
+     * @brief Load the index from a file
+     *
+     * @param path the path of the index file
+     * @return true the index was loaded
+     * @return false the file does not exist
+     */
+    bool load(const std::string& path);
+
+    /**
+     * @brief Save the index to a file
+     *
+     * The file is replaced atomically, like the TimingCache.
+     *
+     * @param path the path of the index file
+     * @return true the index was saved
+     * @return false the file could not be written
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Record the dependencies of a test, replacing the known ones
+     *
+     * @param collection the name of the collection
+     * @param test the name of the test
+     * @param files the files the test depends on
+     */
+    void record(std::string_view collection, std::string_view test, std::vector<std::string> files);
+
+    /**
+     * @brief Get the recorded dependencies of a test
+     *
+     * @param collection the name of the collection
+     * @param test the name of the test
+     * @return const std::vector<std::string>* the files, nullptr if the test is not in the index
+     */
+    const std::vector<std::string>* lookup(std::string_view collection, std::string_view test) const;
+
+    /**
+     * @brief Check if a change can affect a test
+     *
+     * @param collection the name of the collection
+     * @param test the name of the test
+     * @param changedFiles the normalized paths of the changed files
+     * @return true the test is not in the index or depends on a changed file
+     * @return false none of the files of the test changed
+     */
+    bool affected(std::string_view collection, std::string_view test, const std::unordered_set<std::string>& changedFiles) const;
+
+    /**
+     * @brief Get the number of known tests
+     *
+     * @return size_t the number of tests
+     */
+    inline size_t size() const { return mDependencies.size(); }
+};
+
+} // namespace PidgeonPulse
@@ -0,0 +1,235 @@
+/**
+ * @file FailList.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <string_view>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief Information about a test failure.
+ *
+ * This struct contains information about a test failure,
+ * including the file and line number where the failure occurred.
+ * Failed assertions also record their expression and its expansion.
+ */
+struct FailInfo {
+    const char* file;
+    int line;
+    std::exception_ptr exception;
+    const char* expression = nullptr;
+    const char* message = nullptr;
+};
+
+/**
+ * @brief The failures recorded by a test
+ *
+ * The first failures are stored inline. Further failures go to chunks taken
+ * from an arena of the recording thread, so recording never touches the
+ * shared heap and needs no locks. Beyond MAX_RECORDED failures only the
+ * number of dropped failures is counted, so nothing is lost silently.
+ * Failure messages are copied into text blocks of the list, taken from the
+ * same arena. Clearing the list keeps its chunks and text blocks for the
+ * next run of the test, so repeated runs do not grow the arena. A destroyed
+ * list returns them to the calling thread for the next list it creates.
+ */
+class FailList {
+public:
+    static constexpr size_t INLINE_CAPACITY = 4;
+    static constexpr size_t CHUNK_CAPACITY = 32;
+    static constexpr size_t MAX_RECORDED = 1024;
+    static constexpr size_t MAX_TEXT_SIZE = 4096;
+
+private:
+    /**
+     * @brief A block of failures in the arena
+     */
+    struct Chunk {
+        std::array<FailInfo, CHUNK_CAPACITY> items{};
+        Chunk* next = nullptr;
+    };
+
+    /**
+     * @brief A block of failure messages in the arena
+     */
+    struct TextBlock {
+        static constexpr size_t CAPACITY = 2 * MAX_TEXT_SIZE;
+
+        std::array<char, CAPACITY> text;
+        size_t used = 0;
+        TextBlock* next = nullptr;
+    };
+
+    std::array<FailInfo, INLINE_CAPACITY> mInline{};
+    Chunk* mHead = nullptr;
+    Chunk* mTail = nullptr;
+    size_t mSize = 0;
+    uint64_t mDropped = 0;
+
+    TextBlock* mTextHead = nullptr;
+    TextBlock* mTextTail = nullptr;
+
+    // the chunks and text blocks of destroyed lists, reused before the arena grows
+    static thread_local Chunk* tFreeChunks;
+    static thread_local TextBlock* tFreeTextBlocks;
+
+    /**
+     * @brief Get a free chunk of the calling thread or a new one from its arena
+     *
+     * @return Chunk* the chunk
+     */
+    static Chunk* allocateChunk();
+
+    /**
+     * @brief Get a free text block of the calling thread or a new one from its arena
+     *
+     * @return TextBlock* the text block
+     */
+    static TextBlock* allocateTextBlock();
+
+public:
+    /**
+     * @brief Iterates over the recorded failures in order
+     */
+    class const_iterator {
+    private:
+        const FailList* mList;
+        size_t mIndex;
+        const Chunk* mChunk;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FailInfo;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const FailInfo*;
+        using reference = const FailInfo&;
+
+        const_iterator(): mList(nullptr), mIndex(0), mChunk(nullptr) {}
+        const_iterator(const FailList* list, size_t index): mList(list), mIndex(index), mChunk(nullptr) {}
+
+        reference operator*() const {
+            if ( mIndex < INLINE_CAPACITY ) {
+                return mList->mInline[mIndex];
+            }
+            return mChunk->items[(mIndex - INLINE_CAPACITY) % CHUNK_CAPACITY];
+        }
+
+        pointer operator->() const { return &**this; }
+
+        const_iterator& operator++() {
+            mIndex++;
+            if ( mIndex == INLINE_CAPACITY ) {
+                mChunk = mList->mHead;
+            } else if ( mIndex > INLINE_CAPACITY && (mIndex - INLINE_CAPACITY) % CHUNK_CAPACITY == 0 ) {
+                mChunk = mChunk->next;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const const_iterator& other) const { return mIndex == other.mIndex; }
+        bool operator!=(const const_iterator& other) const { return mIndex != other.mIndex; }
+    };
+
+    FailList() = default;
+    ~FailList();
+
+    FailList(const FailList&) = delete;
+    FailList& operator=(const FailList&) = delete;
+
+    /**
+     * @brief Record a failure
+     *
+     * @param failInfo the failure
+     */
+    void push(const FailInfo& failInfo);
+
+    /**
+     * @brief Remove all failures, keeping the chunks for reuse
+     */
+    void clear();
+
+    /**
+     * @brief Exchange the failures, texts and chunks with another list
+     *
+     * @param other the other list
+     */
+    void swap(FailList& other) noexcept;
+
+    /**
+     * @brief Count failures that were dropped elsewhere
+     *
+     * @param count the number of dropped failures
+     */
+    inline void addDropped(uint64_t count) { mDropped += count; }
+
+    /**
+     * @brief Check if further failures are only counted as dropped
+     *
+     * @return true MAX_RECORDED failures were recorded
+     */
+    inline bool full() const { return mSize >= MAX_RECORDED; }
+
+    /**
+     * @brief Get the number of recorded failures
+     *
+     * @return size_t the number of failures
+     */
+    inline size_t size() const { return mSize; }
+
+    /**
+     * @brief Check if no failures were recorded
+     *
+     * @return true no failures were recorded
+     */
+    inline bool empty() const { return mSize == 0; }
+
+    /**
+     * @brief Get the number of failures that exceeded MAX_RECORDED
+     *
+     * @return uint64_t the number of dropped failures
+     */
+    inline uint64_t dropped() const { return mDropped; }
+
+    /**
+     * @brief Get a recorded failure
+     *
+     * @param index the index of the failure
+     * @return const FailInfo& the failure
+     */
+    const FailInfo& operator[](size_t index) const;
+
+    /**
+     * @brief Copy a failure message into the text blocks of the list
+     *
+     * Texts longer than MAX_TEXT_SIZE are truncated. The copy lives
+     * until the list is cleared or destroyed.
+     *
+     * @param text the text to copy
+     * @return const char* the null terminated copy
+     */
+    const char* storeText(std::string_view text);
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, mSize); }
+};
+
+} // namespace PidgeonPulse
@@ -0,0 +1,135 @@
+/**
+ * @file Fixture.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-30
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace PidgeonPulse {
+
+class TestController;
+
+/**
+ * @brief The type independent part of a Fixture
+ *
+ * Counts the tests of the current run that still depend on the fixture
+ * and tears it down once the last of them finished.
+ */
+class FixtureBase {
+private:
+    std::atomic<size_t> mUsers = 0;
+
+    friend TestController;
+
+    /**
+     * @brief Register a test of the current run that depends on the fixture
+     */
+    void retain();
+
+    /**
+     * @brief Unregister a finished test, tearing the fixture down after the last one
+     */
+    void release();
+
+protected:
+    /**
+     * @brief Destroy the shared value, if it was created
+     */
+    virtual void destroy() = 0;
+
+public:
+    virtual ~FixtureBase() = default;
+
+    /**
+     * @brief Check if the shared value currently exists
+     *
+     * @return true the value was created and not torn down yet
+     * @return false the value does not exist
+     */
+    virtual bool isLive() const = 0;
+
+    /**
+     * @brief Get the number of tests of the current run that still depend on the fixture
+     *
+     * @return size_t the number of tests
+     */
+    inline size_t getUsers() const { return mUsers.load(); }
+};
+
+/**
+ * @brief A value shared read-only by many tests
+ *
+ * The value is created on the first call to get() by any worker and torn
+ * down once the last test of the run that depends on it finished, so an
+ * expensive setup runs once per run instead of once per test.
+ * Tests depend on a fixture through Testable::use_fixture(),
+ * TestCollection::useFixture() or TestController::useFixture().
+ *
+ * In isolation mode every worker process creates its own value,
+ * which lives until the worker process exits.
+ *
+ * @tparam T the type of the shared value
+ */
+template<typename T>
+class Fixture : public FixtureBase {
+public:
+    using Factory = std::function<std::unique_ptr<T>()>;
+
+private:
+    Factory mFactory;
+    std::mutex mMutex;
+    std::unique_ptr<T> mValue;
+    std::atomic<const T*> mLiveValue = nullptr;
+
+protected:
+    void destroy() override {
+        std::lock_guard lock(mMutex);
+        mLiveValue = nullptr;
+        mValue.reset();
+    }
+
+public:
+    /**
+     * @brief Construct a new Fixture object
+     *
+     * @param factory creates the shared value, by default T is default constructed
+     */
+    explicit Fixture(Factory factory = []() { return std::make_unique<T>(); })
+    : mFactory(std::move(factory)) {}
+
+    /**
+     * @brief Get the shared value, creating it on first use
+     *
+     * If the factory throws, the exception is passed on and the next call tries again.
+     *
+     * @return const T& the shared value
+     */
+    const T& get() {
+        if ( const T* value = mLiveValue.load(std::memory_order_acquire) ) {
+            return *value;
+        }
+        std::lock_guard lock(mMutex);
+        if ( !mValue ) {
+            mValue = mFactory();
+            mLiveValue.store(mValue.get(), std::memory_order_release);
+        }
+        return *mValue;
+    }
+
+    bool isLive() const override {
+        return mLiveValue.load() != nullptr;
+    }
+};
+
+} // namespace PidgeonPulse
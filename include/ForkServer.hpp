@@ -0,0 +1,184 @@
+/**
+ * @file ForkServer.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include "Testable.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <stop_token>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief Runs tests in a pool of forked worker processes
+ *
+ * The workers are forked from the already initialized parent, receive the
+ * index of the next test over a pipe and send the result back in a compact
+ * binary message. A crashing test only takes its worker down: the test is
+ * reported as failed with the signal that killed it and the worker is respawned.
+ *
+ * @note The parent must not have other threads running when the workers are forked.
+ */
+class ForkServer {
+private:
+    /**
+     * @brief A forked worker process and the pipes to talk to it
+     */
+    struct Worker {
+        pid_t pid = -1;
+        int commandFd = -1;
+        int resultFd = -1;
+        int64_t currentTest = -1;
+        std::vector<char> buffer;
+        std::chrono::steady_clock::time_point started;
+        std::chrono::steady_clock::time_point deadline;
+        bool hasDeadline = false;
+        bool timedOut = false;
+    };
+
+    const std::vector<Testable*>& mTests;
+    std::function<void(size_t)> mOnFinished;
+    std::vector<Worker> mWorkers;
+    std::deque<uint32_t> mPendingTests;
+    size_t mRunningTests = 0;
+    std::stop_token mStopToken;
+    std::vector<std::chrono::milliseconds> mTimeouts;
+
+    /**
+     * @brief Fork a new worker process
+     *
+     * @param index the index of the worker slot
+     */
+    void spawnWorker(size_t index);
+
+    /**
+     * @brief Close the pipes of a worker and reap the process
+     *
+     * @param worker the worker
+     * @return int the wait status of the process
+     */
+    int reapWorker(Worker& worker);
+
+    /**
+     * @brief Hand the next pending test to an idle worker
+     *
+     * @param worker the worker
+     */
+    void dispatch(Worker& worker);
+
+    /**
+     * @brief Kill the workers whose test exceeded its timeout
+     *
+     * @return int the time in milliseconds until the next deadline, -1 if there is none
+     */
+    int enforceDeadlines();
+
+    /**
+     * @brief Report all tests that were not handed to a worker yet as skipped
+     */
+    void skipPending();
+
+    /**
+     * @brief Read available result data from a worker
+     *
+     * @param index the index of the worker slot
+     */
+    void receive(size_t index);
+
+    /**
+     * @brief Apply a complete result message to its test
+     *
+     * @param message the message without its length prefix
+     * @param size the size of the message
+     */
+    void applyResult(const char* message, size_t size);
+
+    /**
+     * @brief Mark the test of a crashed worker as failed
+     *
+     * @param test the test that was running
+     * @param status the wait status of the worker
+     */
+    void failCrashedTest(uint32_t test, int status);
+
+    /**
+     * @brief Get a copy of a string that lives until the end of the program
+     *
+     * Received file names and expressions are referenced by the FailInfos of the tests.
+     *
+     * @param value the string
+     * @return const char* a stable pointer to the string
+     */
+    static const char* intern(const std::string& value);
+
+    /**
+     * @brief The main loop of a worker process
+     *
+     * @param commandFd the pipe to receive test indices from
+     * @param resultFd the pipe to send results to
+     */
+    [[noreturn]] void workerLoop(int commandFd, int resultFd);
+
+    /**
+     * @brief Serialize the result of a test into a message
+     *
+     * @param index the index of the test
+     * @param message the buffer to write the message to
+     */
+    void serializeResult(uint32_t index, std::vector<char>& message) const;
+
+public:
+    /**
+     * @brief Construct a new ForkServer object
+     *
+     * @param tests the tests to run, referenced by their index
+     * @param onFinished called in the parent with the index of every finished test
+     * @param stopToken once stop is requested, tests that did not start yet are skipped.
+     *                  Tests that are already running in a worker finish normally.
+     */
+    ForkServer(const std::vector<Testable*>& tests, std::function<void(size_t)> onFinished = {},
+               std::stop_token stopToken = {});
+
+    /**
+     * @brief Destroy the ForkServer object
+     *
+     * Stops and reaps all remaining workers.
+     */
+    ~ForkServer();
+
+    ForkServer(const ForkServer&) = delete;
+    ForkServer& operator=(const ForkServer&) = delete;
+
+    /**
+     * @brief Set the timeouts of the tests
+     *
+     * A worker whose test exceeds its timeout is killed,
+     * the test is reported as timed out and the worker is respawned.
+     *
+     * @param timeouts the timeout of every test by its index, 0 for no timeout
+     */
+    void setTimeouts(std::vector<std::chrono::milliseconds> timeouts);
+
+    /**
+     * @brief Run all tests
+     *
+     * @param workerCount the number of worker processes
+     */
+    void run(size_t workerCount);
+};
+
+} // namespace PidgeonPulse
@@ -0,0 +1,366 @@
+/**
+ * @file Generator.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-29
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include "Random.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief Generates random values of a type and shrinks failing ones
+ *
+ * generate() overwrites an existing value, so strings and containers keep
+ * their capacity from case to case instead of being allocated again.
+ * shrink() appends simpler variants of a value to a list, simplest first.
+ * The value type has to be default constructible.
+ */
+template<typename G>
+concept Generator = requires (const G& generator, Random& random,
+                              typename G::ValueType& value,
+                              std::vector<typename G::ValueType>& candidates) {
+    generator.generate(random, value);
+    generator.shrink(std::as_const(value), candidates);
+};
+
+/**
+ * @brief The printable ASCII characters, simplest first
+ */
+inline constexpr std::string_view PRINTABLE_CHARACTERS =
+    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 !\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~";
+
+/**
+ * @brief Append shorter and simpler variants of a sequence
+ *
+ * Removes the whole tail, then chunks of decreasing size, then shrinks
+ * the elements one at a time.
+ *
+ * @tparam Sequence the type of the sequence, e.g. std::string
+ * @tparam ShrinkElement callable taking an element and a list for its candidates
+ * @param value the sequence to shrink
+ * @param minLength the minimum length of the sequence
+ * @param candidates the list to append to
+ * @param shrinkElement shrinks a single element
+ */
+template<typename Sequence, typename ShrinkElement>
+void shrinkSequence(const Sequence& value, size_t minLength, std::vector<Sequence>& candidates, ShrinkElement shrinkElement) {
+    if ( value.size() > minLength ) {
+        candidates.emplace_back(value.begin(), value.begin() + minLength);
+        for ( size_t chunk = (value.size() - minLength) / 2; chunk > 0; chunk /= 2 ) {
+            for ( size_t start = 0; start + chunk <= value.size(); start += chunk ) {
+                Sequence& shorter = candidates.emplace_back();
+                shorter.reserve(value.size() - chunk);
+                shorter.insert(shorter.end(), value.begin(), value.begin() + start);
+                shorter.insert(shorter.end(), value.begin() + start + chunk, value.end());
+            }
+        }
+    }
+
+    std::vector<typename Sequence::value_type> elements;
+    for ( size_t index = 0; index < value.size(); index++ ) {
+        elements.clear();
+        shrinkElement(value[index], elements);
+        for ( auto& element : elements ) {
+            Sequence& simpler = candidates.emplace_back(value);
+            simpler[index] = std::move(element);
+        }
+    }
+}
+
+/**
+ * @brief Generates integers in a closed range
+ *
+ * The bounds and the value closest to 0 are generated more often than
+ * the rest. Shrinks towards the value closest to 0.
+ *
+ * @tparam T the integer type
+ */
+template<std::integral T>
+requires (!std::is_same_v<T, bool>)
+class IntegerGenerator {
+public:
+    using ValueType = T;
+
+private:
+    using Unsigned = std::make_unsigned_t<T>;
+
+    T mMin;
+    T mMax;
+
+    T origin() const {
+        if ( mMin > 0 ) return mMin;
+        if ( mMax < 0 ) return mMax;
+        return 0;
+    }
+
+public:
+    /**
+     * @brief Construct a new Integer Generator object
+     *
+     * @param min the smallest value
+     * @param max the largest value
+     */
+    IntegerGenerator(T min, T max): mMin(min), mMax(max) {}
+
+    void generate(Random& random, T& value) const {
+        if ( random.chance(8) ) {
+            uint64_t edge = random.below(3);
+            value = edge == 0 ? mMin : edge == 1 ? mMax : origin();
+            return;
+        }
+        // a full 64 bit range wraps to 0, which below() takes as the full range
+        uint64_t range = static_cast<uint64_t>(static_cast<Unsigned>(static_cast<Unsigned>(mMax) - static_cast<Unsigned>(mMin))) + 1;
+        value = static_cast<T>(static_cast<Unsigned>(static_cast<Unsigned>(mMin) + static_cast<Unsigned>(random.below(range))));
+    }
+
+    void shrink(const T& value, std::vector<T>& candidates) const {
+        T target = origin();
+        if ( value == target ) {
+            return;
+        }
+        candidates.push_back(target);
+
+        bool above = value > target;
+        Unsigned distance = above
+            ? static_cast<Unsigned>(static_cast<Unsigned>(value) - static_cast<Unsigned>(target))
+            : static_cast<Unsigned>(static_cast<Unsigned>(target) - static_cast<Unsigned>(value));
+        for ( Unsigned delta = distance / 2; delta > 0; delta /= 2 ) {
+            candidates.push_back(static_cast<T>(above
+                ? static_cast<Unsigned>(static_cast<Unsigned>(value) - delta)
+                : static_cast<Unsigned>(static_cast<Unsigned>(value) + delta)));
+        }
+    }
+};
+
+/**
+ * @brief Generates strings of characters from an alphabet
+ *
+ * Shrinks to shorter strings and towards the first character of the alphabet.
+ */
+class StringGenerator {
+public:
+    using ValueType = std::string;
+
+private:
+    size_t mMinLength;
+    size_t mMaxLength;
+    std::string mAlphabet;
+
+public:
+    /**
+     * @brief Construct a new String Generator object
+     *
+     * @param minLength the minimum length
+     * @param maxLength the maximum length
+     * @param alphabet the characters to use, simplest first
+     */
+    StringGenerator(size_t minLength, size_t maxLength, std::string_view alphabet = PRINTABLE_CHARACTERS)
+    : mMinLength(minLength), mMaxLength(maxLength), mAlphabet(alphabet) {}
+
+    void generate(Random& random, std::string& value) const {
+        value.resize(mMinLength + random.below(mMaxLength - mMinLength + 1));
+        for ( char& character : value ) {
+            character = mAlphabet[random.below(mAlphabet.size())];
+        }
+    }
+
+    void shrink(const std::string& value, std::vector<std::string>& candidates) const {
+        shrinkSequence(value, mMinLength, candidates, [this](char character, std::vector<char>& simpler) {
+            if ( character != mAlphabet.front() ) {
+                simpler.push_back(mAlphabet.front());
+            }
+        });
+    }
+};
+
+/**
+ * @brief Generates vectors whose elements come from another generator
+ *
+ * @tparam G the generator of the elements
+ */
+template<Generator G>
+class VectorGenerator {
+public:
+    using ValueType = std::vector<typename G::ValueType>;
+
+private:
+    G mElement;
+    size_t mMinLength;
+    size_t mMaxLength;
+
+public:
+    /**
+     * @brief Construct a new Vector Generator object
+     *
+     * @param element the generator of the elements
+     * @param minLength the minimum length
+     * @param maxLength the maximum length
+     */
+    VectorGenerator(G element, size_t minLength, size_t maxLength)
+    : mElement(std::move(element)), mMinLength(minLength), mMaxLength(maxLength) {}
+
+    void generate(Random& random, ValueType& value) const {
+        value.resize(mMinLength + random.below(mMaxLength - mMinLength + 1));
+        for ( auto& element : value ) {
+            mElement.generate(random, element);
+        }
+    }
+
+    void shrink(const ValueType& value, std::vector<ValueType>& candidates) const {
+        shrinkSequence(value, mMinLength, candidates, [this](const auto& element, auto& simpler) {
+            mElement.shrink(element, simpler);
+        });
+    }
+};
+
+/**
+ * @brief Generates tuples with one generator per element
+ *
+ * Shrinks one element at a time.
+ *
+ * @tparam Gs the generators of the elements
+ */
+template<Generator... Gs>
+class TupleGenerator {
+public:
+    using ValueType = std::tuple<typename Gs::ValueType...>;
+
+private:
+    std::tuple<Gs...> mGenerators;
+
+    template<size_t I>
+    void shrinkElement(const ValueType& value, std::vector<ValueType>& candidates) const {
+        std::vector<std::tuple_element_t<I, ValueType>> elements;
+        std::get<I>(mGenerators).shrink(std::get<I>(value), elements);
+        for ( auto& element : elements ) {
+            ValueType& simpler = candidates.emplace_back(value);
+            std::get<I>(simpler) = std::move(element);
+        }
+    }
+
+public:
+    /**
+     * @brief Construct a new Tuple Generator object
+     *
+     * @param generators the generators of the elements
+     */
+    explicit TupleGenerator(Gs... generators): mGenerators(std::move(generators)...) {}
+
+    void generate(Random& random, ValueType& value) const {
+        [&]<size_t... Is>(std::index_sequence<Is...>) {
+            (std::get<Is>(mGenerators).generate(random, std::get<Is>(value)), ...);
+        }(std::index_sequence_for<Gs...>{});
+    }
+
+    void shrink(const ValueType& value, std::vector<ValueType>& candidates) const {
+        [&]<size_t... Is>(std::index_sequence<Is...>) {
+            (shrinkElement<Is>(value, candidates), ...);
+        }(std::index_sequence_for<Gs...>{});
+    }
+};
+
+/**
+ * @brief Generates user types by converting the values of another generator
+ *
+ * Shrinking converts the failing value back, shrinks it with the
+ * underlying generator and converts the candidates again.
+ *
+ * @tparam G the underlying generator
+ * @tparam To converts an underlying value to the user type
+ * @tparam From converts the user type back to an underlying value
+ */
+template<Generator G, typename To, typename From>
+class MappedGenerator {
+public:
+    using SourceType = typename G::ValueType;
+    using ValueType = std::decay_t<std::invoke_result_t<const To&, const SourceType&>>;
+
+private:
+    G mGenerator;
+    To mTo;
+    From mFrom;
+    // reused between cases, a generator belongs to a single test
+    mutable SourceType mSource{};
+
+public:
+    /**
+     * @brief Construct a new Mapped Generator object
+     *
+     * @param generator the underlying generator
+     * @param to converts an underlying value to the user type
+     * @param from converts the user type back to an underlying value
+     */
+    MappedGenerator(G generator, To to, From from)
+    : mGenerator(std::move(generator)), mTo(std::move(to)), mFrom(std::move(from)) {}
+
+    void generate(Random& random, ValueType& value) const {
+        mGenerator.generate(random, mSource);
+        value = mTo(std::as_const(mSource));
+    }
+
+    void shrink(const ValueType& value, std::vector<ValueType>& candidates) const {
+        std::vector<SourceType> sources;
+        mGenerator.shrink(mFrom(value), sources);
+        for ( const auto& source : sources ) {
+            candidates.push_back(mTo(source));
+        }
+    }
+};
+
+/**
+ * @brief Generate integers in [min, max]
+ */
+template<typename T>
+IntegerGenerator<T> integers(T min = std::numeric_limits<T>::min(), T max = std::numeric_limits<T>::max()) {
+    return IntegerGenerator<T>(min, max);
+}
+
+/**
+ * @brief Generate strings with a length in [minLength, maxLength]
+ */
+inline StringGenerator strings(size_t minLength, size_t maxLength, std::string_view alphabet = PRINTABLE_CHARACTERS) {
+    return StringGenerator(minLength, maxLength, alphabet);
+}
+
+/**
+ * @brief Generate vectors with a length in [minLength, maxLength]
+ */
+template<Generator G>
+VectorGenerator<G> vectors(G element, size_t minLength, size_t maxLength) {
+    return VectorGenerator<G>(std::move(element), minLength, maxLength);
+}
+
+/**
+ * @brief Generate tuples, one generator per element
+ */
+template<Generator... Gs>
+TupleGenerator<Gs...> tuples(Gs... generators) {
+    return TupleGenerator<Gs...>(std::move(generators)...);
+}
+
+/**
+ * @brief Generate user types from the values of another generator
+ */
+template<Generator G, typename To, typename From>
+MappedGenerator<G, To, From> mapped(G generator, To to, From from) {
+    return MappedGenerator<G, To, From>(std::move(generator), std::move(to), std::move(from));
+}
+
+} // namespace PidgeonPulse
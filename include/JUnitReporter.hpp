@@ -0,0 +1,67 @@
+/**
+ * @file JUnitReporter.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-24
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include "Reporter.hpp"
+#include "OutputSink.hpp"
+
+#include <memory>
+#include <string_view>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief Writes a JUnit XML report
+ *
+ * Every test is written as soon as it finished. Since tests of different
+ * collections finish interleaved, all tests are part of one testsuite and
+ * the collection is written as the classname of the testcase.
+ */
+class JUnitReporter : public Reporter {
+private:
+    std::unique_ptr<OutputSink> mOwnedSink;
+    OutputSink& mSink;
+
+    /**
+     * @brief Write text with the XML special characters escaped
+     *
+     * @param text the text
+     */
+    void writeEscaped(std::string_view text);
+
+    /**
+     * @brief Write the hardware events of a test as the properties of its testcase
+     *
+     * @param counters the measured events
+     */
+    void writeCounters(const PerfStats& counters);
+
+public:
+    /**
+     * @brief Construct a new JUnit Reporter object
+     *
+     * @param sink the sink to write the report to
+     */
+    explicit JUnitReporter(std::unique_ptr<OutputSink> sink);
+
+    /**
+     * @brief Construct a new JUnit Reporter object writing to a sink owned by the caller
+     *
+     * @param sink the sink to write the report to
+     */
+    explicit JUnitReporter(OutputSink& sink);
+
+    void runStarting() override;
+    void testFinished(const TestCollection& collection, const Testable& test) override;
+    void runFinished(const TestStats& stats) override;
+};
+
+} // namespace PidgeonPulse
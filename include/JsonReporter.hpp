@@ -0,0 +1,53 @@
+/**
+ * @file JsonReporter.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-24
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include "Reporter.hpp"
+#include "OutputSink.hpp"
+
+#include <memory>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief Writes a JSON Lines report
+ *
+ * Every finished test, collection and the run itself are written as one
+ * JSON object per line, distinguished by their "type" field.
+ */
+class JsonReporter : public Reporter {
+private:
+    std::unique_ptr<OutputSink> mOwnedSink;
+    OutputSink& mSink;
+
+public:
+    /**
+     * @brief Construct a new Json Reporter object
+     *
+     * @param sink the sink to write the report to
+     */
+    explicit JsonReporter(std::unique_ptr<OutputSink> sink);
+
+    /**
+     * @brief Construct a new Json Reporter object writing to a sink owned by the caller
+     *
+     * @param sink the sink to write the report to
+     */
+    explicit JsonReporter(OutputSink& sink);
+
+    void testFinished(const TestCollection& collection, const Testable& test) override;
+    void baselineCompared(const TestCollection& collection, const Testable& test, const BaselineComparison& comparison) override;
+    void collectionFinished(const TestCollection& collection, const TestStats& stats) override;
+    void repeatFinished(const std::vector<RepeatStats>& results, size_t repetitions, uint64_t seed) override;
+    void runFinished(const TestStats& stats) override;
+};
+
+} // namespace PidgeonPulse
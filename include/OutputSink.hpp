@@ -0,0 +1,154 @@
+/**
+ * @file OutputSink.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-23
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief A buffered destination for reports
+ *
+ * Writes are collected in a fixed size buffer and handed to writeOut()
+ * when the buffer is full or flush() is called.
+ */
+class OutputSink {
+private:
+    std::array<char, 64 * 1024> mBuffer;
+    size_t mUsed = 0;
+
+protected:
+    /**
+     * @brief Write buffered data to the destination
+     *
+     * @param data the data
+     * @param size the size of the data
+     */
+    virtual void writeOut(const char* data, size_t size) = 0;
+
+public:
+    virtual ~OutputSink() = default;
+
+    /**
+     * @brief Write text to the sink
+     *
+     * @param text the text
+     */
+    void write(std::string_view text);
+
+    /**
+     * @brief Write a single character to the sink
+     *
+     * @param character the character
+     */
+    inline void write(char character) {
+        if ( mUsed == mBuffer.size() ) {
+            flush();
+        }
+        mBuffer[mUsed++] = character;
+    }
+
+    /**
+     * @brief Write an unsigned number to the sink
+     *
+     * @param value the number
+     */
+    void writeNumber(uint64_t value);
+
+    /**
+     * @brief Write a signed number to the sink
+     *
+     * @param value the number
+     */
+    void writeNumber(int64_t value);
+
+    /**
+     * @brief Write a floating point number to the sink
+     *
+     * @param value the number
+     * @param precision the number of digits after the decimal point
+     */
+    void writeNumber(double value, int precision);
+
+    /**
+     * @brief Write text as a quoted and escaped JSON string
+     *
+     * @param text the text
+     */
+    void writeJsonString(std::string_view text);
+
+    /**
+     * @brief Hand all buffered data to the destination
+     */
+    void flush();
+};
+
+/**
+ * @brief An OutputSink writing to a file or standard stream
+ */
+class FileSink : public OutputSink {
+private:
+    std::FILE* mFile;
+    bool mOwnsFile;
+
+protected:
+    void writeOut(const char* data, size_t size) override;
+
+public:
+    /**
+     * @brief Construct a new File Sink object writing to a file
+     *
+     * @param path the path of the file, truncated if it exists
+     */
+    explicit FileSink(const std::string& path);
+
+    /**
+     * @brief Construct a new File Sink object writing to an open stream
+     *
+     * @param file the stream, e.g. stdout. It is not closed by the sink.
+     */
+    explicit FileSink(std::FILE* file);
+
+    /**
+     * @brief Destroy the File Sink object
+     *
+     * Flushes the remaining data and closes the file if it was opened by the sink.
+     */
+    ~FileSink() override;
+
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+};
+
+/**
+ * @brief An OutputSink collecting everything in a string
+ */
+class StringSink : public OutputSink {
+private:
+    std::string mString;
+
+protected:
+    void writeOut(const char* data, size_t size) override;
+
+public:
+    /**
+     * @brief Get everything written to the sink so far
+     *
+     * @return std::string the written text
+     */
+    std::string str();
+};
+
+} // namespace PidgeonPulse
@@ -0,0 +1,87 @@
+/**
+ * @file ParameterizedTest.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-29
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include "Testable.hpp"
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief Base class of tests that run once per parameter set
+ *
+ * Derived classes implement run() and read their parameters with get_params().
+ * Every parameter set becomes its own test instance, see TestCollection::addParameterizedTests().
+ *
+ * @tparam Params the type of a parameter set, e.g. a std::tuple
+ */
+template<typename Params>
+class ParameterizedTest : public Testable {
+public:
+    using ParamsType = Params;
+
+private:
+    Params mParams;
+
+public:
+    /**
+     * @brief Construct a new Parameterized Test object
+     *
+     * @param name the name of the test instance
+     * @param params the parameter set of the instance
+     */
+    ParameterizedTest(std::string name, Params params)
+    : Testable(std::move(name)), mParams(std::move(params)) {}
+
+    /**
+     * @brief Get the parameter set of the test instance.
+     *
+     * @return const Params& the parameters.
+     */
+    const Params& get_params() const { return mParams; }
+};
+
+/**
+ * @brief Build every combination of the given values
+ *
+ * The last array varies fastest. Can be evaluated at compile time
+ * for literal types, e.g. `constexpr auto sets = cartesianProduct(std::array{1, 2}, std::array{'a', 'b'});`
+ *
+ * @tparam Ts the types of the values
+ * @tparam Ns the number of values of every type
+ * @param arrays the values of every parameter
+ * @return std::array<std::tuple<Ts...>, (Ns * ...)> all combinations
+ */
+template<typename... Ts, size_t... Ns>
+constexpr std::array<std::tuple<Ts...>, (Ns * ... * 1)> cartesianProduct(const std::array<Ts, Ns>&... arrays) {
+    constexpr std::array<size_t, sizeof...(Ts)> sizes{Ns...};
+    std::array<std::tuple<Ts...>, (Ns * ... * 1)> combinations{};
+
+    for ( size_t i = 0; i < combinations.size(); i++ ) {
+        std::array<size_t, sizeof...(Ts)> indices{};
+        size_t remaining = i;
+        for ( size_t parameter = sizeof...(Ts); parameter-- > 0; ) {
+            indices[parameter] = remaining % sizes[parameter];
+            remaining /= sizes[parameter];
+        }
+        [&]<size_t... Is>(std::index_sequence<Is...>) {
+            combinations[i] = std::tuple<Ts...>(arrays[indices[Is]]...);
+        }(std::index_sequence_for<Ts...>{});
+    }
+    return combinations;
+}
+
+} // namespace PidgeonPulse
@@ -0,0 +1,95 @@
+/**
+ * @file PerfCounters.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-05-05
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include <cstdint>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief The hardware events counted while a thread ran a test
+ *
+ * Counts are scaled up if the kernel had to multiplex the counters.
+ */
+struct PerfStats {
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t cacheMisses = 0;
+    uint64_t branchMisses = 0;
+    /// false if the counters were disabled or not available
+    bool measured = false;
+
+    /**
+     * @brief Get the instructions per cycle
+     *
+     * @return double the instructions per cycle, 0 without cycles
+     */
+    inline double ipc() const { return cycles == 0 ? 0.0 : static_cast<double>(instructions) / cycles; }
+
+    /**
+     * @brief Get the number of events per thousand instructions
+     *
+     * @param events the number of events, e.g. cacheMisses
+     * @return double the events per thousand instructions, 0 without instructions
+     */
+    inline double perKiloInstruction(uint64_t events) const {
+        return instructions == 0 ? 0.0 : static_cast<double>(events) * 1000 / instructions;
+    }
+};
+
+/**
+ * @brief Counts cycles, instructions, cache misses and branch misses with perf_event_open
+ *
+ * Every thread opens its own group of counters the first time it is
+ * measured and keeps it running, so a Scope costs two reads of the group.
+ * Only user space is counted. If the kernel denies access, a warning is
+ * written once and all scopes report nothing measured.
+ */
+class PerfCounters {
+public:
+    /**
+     * @brief Measures the current thread while it is alive
+     */
+    class Scope {
+    private:
+        uint64_t mStart[6];
+        bool mActive;
+
+    public:
+        Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /**
+         * @brief Get the events since the scope was created
+         *
+         * @return PerfStats the events of this thread, not measured if counting is off
+         */
+        PerfStats stats() const;
+    };
+
+    /**
+     * @brief Turn counting on or off for scopes created afterwards
+     *
+     * @param enabled whether to count
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief Check if counting is on
+     *
+     * @return true scopes count the events of their thread
+     */
+    static bool enabled();
+};
+
+} // namespace PidgeonPulse
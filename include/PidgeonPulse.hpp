@@ -10,6 +10,9 @@
  */
 #pragma once
 #include "Testable.hpp"
+#include "AsyncTest.hpp"
+#include "Benchmark.hpp"
+#include "VirtualClock.hpp"
 
 /**
  * @brief Main Namespace for the PidgeonPulse Library
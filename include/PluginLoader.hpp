@@ -0,0 +1,159 @@
+/**
+ * @file PluginLoader.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-05-04
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include "TestFilter.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief Loads test modules from shared objects
+ *
+ * A module registers its collections and tests from its static initializers,
+ * like a test binary does. It has to use collections of its own and must not
+ * link its own copy of PidgeonPulse, the symbols come from the runner, which
+ * has to export them (`-rdynamic`, or ENABLE_EXPORTS in CMake).
+ *
+ * The tests of every loaded module are remembered in a cache file, so a later
+ * run with a filter only loads the modules that contain selected tests.
+ * A module that changed since it was cached is always loaded.
+ */
+class PluginLoader {
+public:
+    /**
+     * @brief A test a module registered
+     */
+    struct CachedTest {
+        std::string collection;
+        std::string test;
+        std::string tags;
+    };
+
+    /**
+     * @brief A module and the registrations it made while it was loaded
+     *
+     * The ranges are [begin, end) into the lists of the TestController.
+     */
+    struct Plugin {
+        std::string path;
+        void* handle = nullptr;
+        size_t collections[2] = {0, 0};
+        size_t descriptors[2] = {0, 0};
+        size_t fixtures[2] = {0, 0};
+    };
+
+private:
+    /**
+     * @brief The tests of a module as of its last load
+     */
+    struct CacheEntry {
+        int64_t modified = 0;
+        uint64_t size = 0;
+        std::vector<CachedTest> tests;
+    };
+
+    std::vector<Plugin> mPlugins;
+    std::unordered_map<std::string, CacheEntry> mCache;
+
+    /**
+     * @brief Get the modification time and size of a module
+     *
+     * @param path the path of the module
+     * @param modified the modification time
+     * @param size the size in bytes
+     * @return true the module exists
+     * @return false the module does not exist
+     */
+    static bool stat(const std::string& path, int64_t& modified, uint64_t& size);
+
+public:
+    /**
+     * @brief Add a module
+     *
+     * @param path the path of the shared object
+     */
+    void addModule(std::string path);
+
+    /**
+     * @brief Add all shared objects in a directory, in the order of their names
+     *
+     * @param path the path of the directory
+     * @return size_t the number of modules found
+     * @throws std::runtime_error if the directory can not be read
+     */
+    size_t addDirectory(const std::string& path);
+
+    /**
+     * @brief Load the cache of the tests of the modules
+     *
+     * @param path the path of the cache file
+     * @return true the cache was loaded
+     * @return false the file does not exist
+     */
+    bool loadCache(const std::string& path);
+
+    /**
+     * @brief Save the cache of the tests of the modules
+     *
+     * @param path the path of the cache file
+     * @return true the cache was saved
+     * @return false the file could not be written
+     */
+    bool saveCache(const std::string& path) const;
+
+    /**
+     * @brief Check if a module may contain tests the filter selects
+     *
+     * @param plugin the module
+     * @param filter the filter of the run
+     * @return true the module has to be loaded
+     * @return false the module is cached and none of its tests is selected
+     */
+    bool selects(const Plugin& plugin, const TestFilter& filter) const;
+
+    /**
+     * @brief Remember the tests of a loaded module
+     *
+     * @param plugin the module
+     * @param tests the tests it registered
+     */
+    void record(const Plugin& plugin, std::vector<CachedTest> tests);
+
+    /**
+     * @brief Load a module, which runs its static initializers
+     *
+     * @param plugin the module
+     * @throws std::runtime_error if the module can not be loaded
+     */
+    static void open(Plugin& plugin);
+
+    /**
+     * @brief Unload a module
+     *
+     * @param plugin the module, its registrations have to be removed first
+     */
+    static void close(Plugin& plugin);
+
+    /**
+     * @brief Get the modules
+     *
+     * @return std::vector<Plugin>& the modules, in the order they were added
+     */
+    inline std::vector<Plugin>& getPlugins() { return mPlugins; }
+};
+
+} // namespace PidgeonPulse
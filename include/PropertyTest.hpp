@@ -0,0 +1,219 @@
+/**
+ * @file PropertyTest.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-29
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include "Generator.hpp"
+#include "Random.hpp"
+#include "TestController.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <source_location>
+#include <string>
+#include <vector>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief A test that checks a property against many generated values
+ *
+ * Derived classes implement property(). The values come from a generator
+ * seeded with the seed of the run and the name of the test, so the same seed
+ * reproduces the same cases. A failing value is shrunk to a simpler one
+ * before it is reported together with the seed.
+ *
+ * Shrink candidates are checked in parallel on idle workers of the thread
+ * pool, so property() has to be safe to call from several threads at once.
+ *
+ * @tparam G the generator of the values
+ */
+template<Generator G>
+class PropertyTest : public Testable {
+public:
+    using ValueType = typename G::ValueType;
+
+private:
+    /**
+     * @brief The candidates of one shrink step, shared with the helper jobs
+     *
+     * A helper that starts after the step is over takes no candidate
+     * and only touches this state, which it keeps alive.
+     */
+    struct ShrinkStep {
+        const PropertyTest* test;
+        const std::vector<ValueType>* candidates;
+        size_t count;
+        std::atomic<size_t> next = 0;
+        std::atomic<size_t> failing = SIZE_MAX;
+        std::atomic<size_t> active = 0;
+
+        void work() {
+            active++;
+            for ( size_t index = next++; index < count; index = next++ ) {
+                // a later candidate does not matter once an earlier one failed
+                if ( index < failing.load() && !test->holds((*candidates)[index]) ) {
+                    size_t current = failing.load();
+                    while ( index < current && !failing.compare_exchange_weak(current, index) ) {}
+                }
+            }
+            if ( --active == 0 ) {
+                active.notify_all();
+            }
+        }
+    };
+
+    G mGenerator;
+    std::source_location mLocation;
+    size_t mCases = 100;
+    size_t mMaxShrinks = 1000;
+    std::optional<uint64_t> mSeed;
+
+    /**
+     * @brief Check the property, an exception counts as a failure
+     *
+     * @param value the value to check
+     * @return true the property holds
+     * @return false the property does not hold
+     */
+    bool holds(const ValueType& value) const {
+        try {
+            return property(value);
+        } catch ( ... ) {
+            return false;
+        }
+    }
+
+    /**
+     * @brief Find the first candidate the property does not hold for
+     *
+     * @param candidates the candidates, simplest first
+     * @return size_t the index of the candidate, SIZE_MAX if it holds for all
+     */
+    size_t findFailing(const std::vector<ValueType>& candidates) const {
+        auto step = std::make_shared<ShrinkStep>();
+        step->test = this;
+        step->candidates = &candidates;
+        step->count = candidates.size();
+
+        if ( Scheduler* scheduler = TestController::getHelperScheduler(); scheduler && candidates.size() > 1 ) {
+            // this test already occupies one of the workers
+            size_t helpers = std::min(scheduler->getWorkerCount(), candidates.size()) - 1;
+            for ( size_t i = 0; i < helpers; i++ ) {
+                scheduler->schedule([step]() { step->work(); });
+            }
+        }
+
+        step->work();
+        for ( size_t active = step->active.load(); active != 0; active = step->active.load() ) {
+            step->active.wait(active);
+        }
+        return step->failing.load();
+    }
+
+    /**
+     * @brief Shrink a failing value as far as possible
+     *
+     * @param value the failing value, replaced by the simplest failing value found
+     * @return size_t the number of successful shrink steps
+     */
+    size_t shrink(ValueType& value) const {
+        std::vector<ValueType> candidates;
+        size_t steps = 0;
+        while ( steps < mMaxShrinks ) {
+            candidates.clear();
+            mGenerator.shrink(value, candidates);
+            size_t failing = findFailing(candidates);
+            if ( failing == SIZE_MAX ) {
+                break;
+            }
+            value = std::move(candidates[failing]);
+            steps++;
+        }
+        return steps;
+    }
+
+protected:
+    /**
+     * @brief The property that has to hold for every value
+     *
+     * @param value the generated value
+     * @return true the property holds
+     * @return false the property does not hold
+     */
+    virtual bool property(const ValueType& value) const = 0;
+
+public:
+    /**
+     * @brief Construct a new Property Test object
+     *
+     * @param name the name of the test
+     * @param generator the generator of the values
+     * @param location the location failures are reported at
+     */
+    PropertyTest(std::string name, G generator, std::source_location location = std::source_location::current())
+    : Testable(std::move(name)), mGenerator(std::move(generator)), mLocation(location) {}
+
+    /**
+     * @brief Set the number of generated cases.
+     *
+     * @param cases the number of cases
+     */
+    void set_cases(size_t cases) { mCases = cases; }
+
+    /**
+     * @brief Get the number of generated cases.
+     *
+     * @return size_t the number of cases
+     */
+    size_t get_cases() const { return mCases; }
+
+    /**
+     * @brief Set the maximum number of shrink steps.
+     *
+     * @param steps the maximum number of steps
+     */
+    void set_max_shrinks(size_t steps) { mMaxShrinks = steps; }
+
+    /**
+     * @brief Use a fixed seed instead of the seed of the run.
+     *
+     * @param seed the seed
+     */
+    void set_seed(uint64_t seed) { mSeed = seed; }
+
+    /**
+     * @brief Generate the cases and check the property for each of them
+     */
+    void run() override {
+        uint64_t seed = mSeed.value_or(TestController::getSeed());
+        Random random(Random::deriveSeed(seed, get_name()));
+
+        ValueType value{};
+        for ( size_t index = 0; index < mCases; index++ ) {
+            if ( stop_requested() ) {
+                skip();
+            }
+            mGenerator.generate(random, value);
+            if ( !holds(value) ) [[unlikely]] {
+                size_t steps = shrink(value);
+                std::string message = "falsified after " + std::to_string(index + 1)
+                    + " cases with seed " + std::to_string(seed)
+                    + ", shrunk " + std::to_string(steps) + " times: " + stringify(value);
+                fail_assertion(mLocation, "property(value)", message, true);
+            }
+        }
+    }
+};
+
+} // namespace PidgeonPulse
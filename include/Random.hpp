@@ -0,0 +1,117 @@
+/**
+ * @file Random.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-29
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief A small and fast seedable pseudo random number generator
+ *
+ * xoshiro256** seeded through splitmix64. It lives on the stack of whoever
+ * uses it, so every thread draws from its own generator without locking.
+ */
+class Random {
+private:
+    uint64_t mState[4];
+
+    static constexpr uint64_t rotate(uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+public:
+    /**
+     * @brief Mix a 64 bit value, used to spread seeds
+     *
+     * @param value the value, advanced to the next state of the sequence
+     * @return uint64_t the mixed value
+     */
+    static constexpr uint64_t splitmix(uint64_t& value) {
+        uint64_t z = (value += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief Derive the seed of a stream from a base seed and a name
+     *
+     * @param seed the base seed
+     * @param name the name of the stream, e.g. the name of a test
+     * @return uint64_t the seed of the stream
+     */
+    static constexpr uint64_t deriveSeed(uint64_t seed, std::string_view name) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for ( char character : name ) {
+            hash ^= static_cast<unsigned char>(character);
+            hash *= 0x100000001b3ull;
+        }
+        uint64_t state = seed ^ hash;
+        return splitmix(state);
+    }
+
+    /**
+     * @brief Construct a new Random object
+     *
+     * @param seed the seed, the same seed yields the same sequence
+     */
+    explicit constexpr Random(uint64_t seed) : mState{} {
+        for ( auto& word : mState ) {
+            word = splitmix(seed);
+        }
+    }
+
+    /**
+     * @brief Get the next random number
+     *
+     * @return uint64_t a uniformly distributed number
+     */
+    constexpr uint64_t next() {
+        uint64_t result = rotate(mState[1] * 5, 7) * 9;
+        uint64_t t = mState[1] << 17;
+        mState[2] ^= mState[0];
+        mState[3] ^= mState[1];
+        mState[1] ^= mState[2];
+        mState[0] ^= mState[3];
+        mState[2] ^= t;
+        mState[3] = rotate(mState[3], 45);
+        return result;
+    }
+
+    /**
+     * @brief Get a random number in [0, bound)
+     *
+     * @param bound the exclusive upper bound, 0 means the full 64 bit range
+     * @return uint64_t the number
+     */
+    constexpr uint64_t below(uint64_t bound) {
+        if ( bound == 0 ) {
+            return next();
+        }
+        // multiply and shift instead of the slower modulo
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(next()) * bound) >> 64);
+    }
+
+    /**
+     * @brief Decide randomly
+     *
+     * @param oneIn the inverse of the probability
+     * @return true with a probability of 1 / oneIn
+     * @return false otherwise
+     */
+    constexpr bool chance(uint64_t oneIn) {
+        return below(oneIn) == 0;
+    }
+};
+
+} // namespace PidgeonPulse
@@ -0,0 +1,194 @@
+/**
+ * @file Reporter.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-23
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include "Testable.hpp"
+
+#include <cstdint>
+#include <exception>
+#include <vector>
+
+namespace PidgeonPulse {
+
+class TestCollection;
+
+/**
+ * @brief Result counts of a TestCollection or a whole run
+ */
+struct TestStats {
+    uint32_t total = 0;
+    uint32_t failed = 0;
+    uint32_t skipped = 0;
+
+    /**
+     * @brief Count the result of a finished test
+     *
+     * Tests that did not run, e.g. as they were filtered out, are not counted.
+     *
+     * @param test the test
+     */
+    inline void add(const Testable& test) {
+        if ( !test.result_ready() ) {
+            return;
+        }
+        total++;
+        if ( test.was_skipped() ) {
+            skipped++;
+        } else if ( !test.get_result() ) {
+            failed++;
+        }
+    }
+
+    inline TestStats& operator+=(const TestStats& other) {
+        total += other.total;
+        failed += other.failed;
+        skipped += other.skipped;
+        return *this;
+    }
+};
+
+/**
+ * @brief The results of a test over all repetitions of a run
+ */
+struct RepeatStats {
+    const TestCollection* collection;
+    const Testable* test;
+    uint32_t runs = 0;
+    uint32_t failed = 0;
+    uint32_t skipped = 0;
+
+    /**
+     * @brief Get the share of the runs that passed, skipped runs are not counted
+     *
+     * @return double the pass rate in [0, 1]
+     */
+    inline double passRate() const {
+        uint32_t counted = runs - skipped;
+        return counted == 0 ? 1.0 : static_cast<double>(counted - failed) / counted;
+    }
+
+    /**
+     * @brief Check if the test passed some runs and failed others
+     *
+     * @return true the test is flaky
+     * @return false the test passed or failed consistently
+     */
+    inline bool isFlaky() const { return failed > 0 && failed + skipped < runs; }
+};
+
+/**
+ * @brief The comparison of a test with its timing baseline
+ *
+ * Benchmarks are compared in ns/op, other tests by their duration in seconds.
+ */
+struct BaselineComparison {
+    double baseline = 0;
+    double current = 0;
+    double pValue = 1;
+    bool regressed = false;
+
+    /**
+     * @brief Get the change of the median relative to the baseline
+     *
+     * @return double the change, e.g. 0.25 for 25% slower
+     */
+    inline double delta() const { return baseline == 0 ? 0.0 : current / baseline - 1; }
+};
+
+/**
+ * @brief Receives test results while the tests run
+ *
+ * The TestController calls the reporters from one thread at a time, so
+ * implementations do not need their own synchronization. Tests of
+ * different collections finish interleaved.
+ */
+class Reporter {
+protected:
+    /**
+     * @brief Get the message of a stored exception
+     *
+     * The message lives as long as the exception pointer.
+     *
+     * @param exception the exception
+     * @return const char* the message of the exception
+     */
+    static const char* exceptionMessage(const std::exception_ptr& exception) {
+        try {
+            std::rethrow_exception(exception);
+        } catch ( const std::exception& e ) {
+            return e.what();
+        } catch ( ... ) {
+            return "Unknown exception";
+        }
+    }
+
+public:
+    virtual ~Reporter() = default;
+
+    /**
+     * @brief Called before the first test runs
+     */
+    virtual void runStarting() {}
+
+    /**
+     * @brief Called before the first test of a collection finishes
+     *
+     * @param collection the collection
+     */
+    virtual void collectionStarting(const TestCollection& /*collection*/) {}
+
+    /**
+     * @brief Called whenever a test finished
+     *
+     * @param collection the collection the test belongs to
+     * @param test the test
+     */
+    virtual void testFinished(const TestCollection& collection, const Testable& test) = 0;
+
+    /**
+     * @brief Called right before testFinished() for a test that has a timing baseline
+     *
+     * A test that regressed already failed with the delta as its message.
+     *
+     * @param collection the collection the test belongs to
+     * @param test the test
+     * @param comparison the comparison of the test with its baseline
+     */
+    virtual void baselineCompared(const TestCollection& /*collection*/, const Testable& /*test*/, const BaselineComparison& /*comparison*/) {}
+
+    /**
+     * @brief Called after the last test of a collection finished
+     *
+     * @param collection the collection
+     * @param stats the results of the collection
+     */
+    virtual void collectionFinished(const TestCollection& /*collection*/, const TestStats& /*stats*/) {}
+
+    /**
+     * @brief Called in repeat mode after the last repetition, before runFinished()
+     *
+     * Every repetition reports its tests and collections like a run of its own.
+     *
+     * @param results the results of every test
+     * @param repetitions the number of repetitions that ran
+     * @param seed the seed the execution order was shuffled with
+     */
+    virtual void repeatFinished(const std::vector<RepeatStats>& /*results*/, size_t /*repetitions*/, uint64_t /*seed*/) {}
+
+    /**
+     * @brief Called after all tests finished
+     *
+     * @param stats the results of the whole run
+     */
+    virtual void runFinished(const TestStats& /*stats*/) {}
+};
+
+} // namespace PidgeonPulse
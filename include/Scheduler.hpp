@@ -0,0 +1,157 @@
+/**
+ * @file Scheduler.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-20
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief Work stealing scheduler shared by all TestCollections
+ *
+ * Every worker owns a deque of jobs. Workers take jobs from the front of
+ * their own deque and, once it runs dry, steal from the back of the other
+ * workers' deques, so a single slow job never leaves the remaining cores idle.
+ */
+class Scheduler {
+public:
+    using Job = std::function<void()>;
+
+private:
+    /**
+     * @brief A single worker thread and its job deque
+     */
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+        std::thread thread;
+        std::atomic<uint64_t> generation = 0;
+    };
+
+    std::vector<std::shared_ptr<Worker>> mWorkers;
+
+    std::atomic<size_t> mNextWorker = 0;
+    std::atomic<size_t> mQueuedJobs = 0;
+    std::atomic<size_t> mPendingJobs = 0;
+
+    std::mutex mSleepMutex;
+    std::condition_variable mWakeCondition;
+    std::condition_variable mIdleCondition;
+    bool mStopping = false;
+
+    /**
+     * @brief The main loop of a worker thread
+     *
+     * The thread leaves the loop once it was abandoned,
+     * that is once the generation of its worker changed.
+     *
+     * @param index the index of the worker
+     * @param generation the generation of the worker the thread belongs to
+     */
+    void workerLoop(size_t index, uint64_t generation);
+
+    /**
+     * @brief Take the next job for a worker
+     *
+     * Pops from the workers own deque first and steals from the others
+     * if that one is empty.
+     *
+     * @param index the index of the worker
+     * @param job the job that was taken
+     * @return true a job was taken
+     * @return false no job was available
+     */
+    bool takeJob(size_t index, Job& job);
+
+    /**
+     * @brief Mark a job as finished and wake up waiters if it was the last one
+     */
+    void finishJob();
+
+public:
+    /**
+     * @brief Construct a new Scheduler object
+     *
+     * @param workerCount the number of worker threads, 0 uses defaultWorkerCount()
+     */
+    explicit Scheduler(size_t workerCount = 0);
+
+    /**
+     * @brief Destroy the Scheduler object
+     *
+     * Finishes all queued jobs before joining the workers.
+     */
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    /**
+     * @brief Schedule a job
+     *
+     * Jobs scheduled from a worker thread go to that workers deque,
+     * all other jobs are distributed round robin.
+     *
+     * @param job the job to schedule
+     */
+    void schedule(Job job);
+
+    /**
+     * @brief Wait until all scheduled jobs are finished
+     */
+    void wait();
+
+    /**
+     * @brief Give up on the job that is running on a worker
+     *
+     * The thread of the worker is detached and replaced by a new thread that
+     * continues with the queued jobs. The abandoned job counts as finished.
+     * If it ever returns, its thread exits without touching the Scheduler.
+     * @note The caller has to make sure that the job is still running
+     *       and that the thread does not return before this call finished.
+     *
+     * @param index the index of the worker
+     */
+    void abandonWorker(size_t index);
+
+    /**
+     * @brief Get the index of the worker the calling thread belongs to
+     *
+     * @return std::optional<size_t> the index, empty if not called from a worker of this Scheduler
+     */
+    std::optional<size_t> currentWorker() const;
+
+    /**
+     * @brief Get the number of worker threads
+     *
+     * @return size_t the number of workers
+     */
+    inline size_t getWorkerCount() const { return mWorkers.size(); }
+
+    /**
+     * @brief Get the default number of worker threads
+     *
+     * @return size_t the hardware concurrency, at least 1
+     */
+    static size_t defaultWorkerCount();
+};
+
+} // namespace PidgeonPulse
@@ -10,32 +10,68 @@
  */
 
 #pragma once
+#include <atomic>
+#include <mutex>
 
 /**
  * @brief Singleton base class for making other Classes into Singletons
  *
+ * The instance is created on first use and lives until destroy() is called,
+ * it is not destroyed at exit, so it can be used from static initializers
+ * and destructors of any translation unit. Getting an existing instance
+ * is a single atomic load.
+ *
  * @tparam T the Class to make into a Singleton
  */
 template<typename T>
 class Singleton {
 private:
-    static bool mInitialized;
+    // both are constant initialized, so they are ready before any static initializer runs
+    static inline std::atomic<T*> mInstance = nullptr;
+    static inline std::mutex mMutex;
+
 public:
     /**
      * @brief Get the Instance of the Singleton Object
      *
+     * Creates the instance if there is none, safe to call from multiple threads.
+     *
      * @return T& reference to the Singleton Object
      */
     static T& getInstance() {
-        static T instance;
-        return instance;
+        T* instance = mInstance.load(std::memory_order_acquire);
+        if ( instance != nullptr ) [[likely]] {
+            return *instance;
+        }
+
+        std::lock_guard lock(mMutex);
+        instance = mInstance.load(std::memory_order_relaxed);
+        if ( instance == nullptr ) {
+            instance = new T();
+            mInstance.store(instance, std::memory_order_release);
+        }
+        return *instance;
+    }
+
+    /**
+     * @brief Get the Instance of the Singleton Object without creating it
+     *
+     * @return T* the Singleton Object, nullptr if there is none or it is being destroyed
+     */
+    static T* tryGetInstance() {
+        return mInstance.load(std::memory_order_acquire);
     }
 
     /**
      * @brief Destroys a Singleton object
+     *
+     * The instance is detached before it is destroyed, so its destructor
+     * sees no instance through tryGetInstance().
+     * @note No other thread may still use the instance.
      */
     static void destroy() {
-        delete& getInstance();
+        std::lock_guard lock(mMutex);
+        delete mInstance.exchange(nullptr, std::memory_order_acq_rel);
     }
 
     /**
@@ -10,12 +10,17 @@
  */
 
 #pragma once
+#include "AppendList.hpp"
 #include "Testable.hpp"
-#include "FlockFlow.hpp"
+#include "ParameterizedTest.hpp"
+#include "Reporter.hpp"
 
+#include <chrono>
 #include <memory>
-
-using FlockFlow::ThreadPool;
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <tuple>
 
 namespace PidgeonPulse {
 
@@ -24,20 +29,15 @@ namespace PidgeonPulse {
  */
 class TestCollection {
 private:
-    std::vector<Testable*> mTests;
+    AppendList<Testable*> mTests;
+    AppendList<std::unique_ptr<Testable>> mOwnedTests;
+    std::vector<FixtureBase*> mFixtures;
     std::string mTestCollectionName;
+    std::string mTags;
+    std::vector<std::string> mDependencies;
 
-    ThreadPool mThreadPool;
-    std::vector<std::future<void>> mTestFutures;
-
-protected:
-    /**
-     * @brief Create a report for a failed test
-     * 
-     * @param test the test that failed
-     * @return std::string the report
-     */
-    static std::string createFailReport(Testable* test);
+    size_t mQueuedTests = 0;
+    std::chrono::milliseconds mTimeout{0};
 
 public:
 
@@ -50,21 +50,84 @@ public:
     
     /**
      * @brief Destroy the Test Collection object
+     * 
+     * Removes the collection from the TestController.
      */
     ~TestCollection();
 
     /**
      * @brief Add a test to the collection
      * 
+     * Safe to call from multiple threads.
+     * 
      * @param test the test to add
      */
     void addTest(Testable* test);
 
+    /**
+     * @brief Add a test that is owned by the collection
+     * 
+     * @param test the test to add
+     */
+    void addTest(std::unique_ptr<Testable> test);
+
+    /**
+     * @brief Add one test instance per parameter set
+     * 
+     * Every instance is scheduled and reported on its own, so a sweep runs
+     * in parallel and one failing parameter set does not hide the others.
+     * The instances are named after the base name and their parameters.
+     * 
+     * @tparam T the test, a ParameterizedTest constructible from a name and one parameter set
+     * @tparam ParameterSets a range of parameter sets, or a tuple of them
+     * @param name the base name of the instances
+     * @param parameterSets the parameter sets
+     */
+    template<typename T, typename ParameterSets>
+    void addParameterizedTests(const std::string& name, const ParameterSets& parameterSets) {
+        auto add = [this, &name](const auto& params) {
+            addTest(std::make_unique<T>(name + stringify(params), typename T::ParamsType(params)));
+        };
+
+        if constexpr ( std::ranges::range<const ParameterSets> ) {
+            for ( const auto& params : parameterSets ) {
+                add(params);
+            }
+        } else {
+            std::apply([&add](const auto&... params) { (add(params), ...); }, parameterSets);
+        }
+    }
+
+    /**
+     * @brief Get all tests of the collection
+     * 
+     * @return const AppendList<Testable*>& the tests, in the order they were added
+     */
+    inline const AppendList<Testable*>& getTests() const { return mTests; }
+
+    /**
+     * @brief Take all tests that were not handed out for running yet
+     *
+     * @return std::vector<Testable*> the tests to run
+     */
+    std::vector<Testable*> takePendingTests();
+
     /**
      * @brief Run all the tests in the collection
+     *
+     * The tests run on the shared scheduler or the worker processes of the TestController.
      */
     void runTests();
 
+    /**
+     * @brief Hand the results of all tests to a reporter
+     * 
+     * Runs the tests that did not run yet first.
+     * 
+     * @param reporter the reporter
+     */
+    void report(Reporter& reporter);
+
     /**
      * @brief Generate a report of the test results
      * 
@@ -75,9 +138,65 @@ public:
     /**
      * @brief Get the name of the collection
      * 
-     * @return std::string the name
+     * @return const std::string& the name
+     */
+    inline const std::string& getName() const { return mTestCollectionName; }
+
+    /**
+     * @brief Set the timeout of the tests that have none of their own
+     * 
+     * @param timeout the timeout, 0 uses the default timeout of the TestController
+     */
+    inline void setTimeout(std::chrono::milliseconds timeout) { mTimeout = timeout; }
+
+    /**
+     * @brief Get the timeout of the tests that have none of their own
+     * 
+     * @return std::chrono::milliseconds the timeout, 0 if none was set
+     */
+    inline std::chrono::milliseconds getTimeout() const { return mTimeout; }
+
+    /**
+     * @brief Add a tag to all tests of the collection
+     * 
+     * @param tag the tag, without brackets
+     */
+    inline void addTag(std::string_view tag) { mTags.append(1, '[').append(tag).append(1, ']'); }
+
+    /**
+     * @brief Get the tags of the collection
+     * 
+     * @return const std::string& the tags in the form "[a][b]"
+     */
+    inline const std::string& getTags() const { return mTags; }
+
+    /**
+     * @brief Declare that all tests of the collection use a shared fixture
+     * 
+     * @param fixture the fixture
+     */
+    inline void useFixture(FixtureBase& fixture) { mFixtures.push_back(&fixture); }
+
+    /**
+     * @brief Get the fixtures all tests of the collection use
+     * 
+     * @return const std::vector<FixtureBase*>& the fixtures
+     */
+    inline const std::vector<FixtureBase*>& getFixtures() const { return mFixtures; }
+
+    /**
+     * @brief Declare a source file all tests of the collection depend on
+     * 
+     * @param path the path relative to the root of the repository, a directory if it ends with '/'
+     */
+    inline void addDependency(std::string path) { mDependencies.push_back(std::move(path)); }
+
+    /**
+     * @brief Get the source files all tests of the collection depend on
+     * 
+     * @return const std::vector<std::string>& the paths
      */
-    inline std::string getName() const { return mTestCollectionName; }
+    inline const std::vector<std::string>& getDependencies() const { return mDependencies; }
 
 };
 
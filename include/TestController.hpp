@@ -10,7 +10,29 @@
  */
 #pragma once
 #include "Singleton.hpp"
+#include "AppendList.hpp"
+#include "Baseline.hpp"
+#include "DependencyIndex.hpp"
+#include "Fixture.hpp"
+#include "PluginLoader.hpp"
+#include "Reporter.hpp"
+#include "Scheduler.hpp"
 #include "TestCollection.hpp"
+#include "TestFilter.hpp"
+#include "TimingCache.hpp"
+#include "Watchdog.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace PidgeonPulse {
 
@@ -21,10 +43,314 @@ namespace PidgeonPulse {
      */
     class TestController : Singleton<TestController> {
     private:
-        std::vector<TestCollection*> mTestCollections;
+        // collections unregister themselves by clearing their slot
+        AppendList<TestCollection*> mTestCollections;
+        AppendList<std::unique_ptr<TestCollection>> mOwnedCollections;
+
+        std::unique_ptr<Scheduler> mScheduler;
+        size_t mWorkerCount = 0;
+        bool mIsolation = false;
+
+        std::vector<std::unique_ptr<Reporter>> mReporters;
+
+        std::unique_ptr<TimingCache> mTimingCache;
+        std::string mTimingCachePath;
+
+        std::unique_ptr<DependencyIndex> mDependencyIndex;
+        std::string mDependencyIndexPath;
+        std::optional<std::unordered_set<std::string>> mChangedFiles;
+
+        std::unique_ptr<Baseline> mBaseline;
+        std::string mBaselinePath;
+        double mBaselineTolerance = 0.1;
+        bool mUpdateBaseline = false;
+
+        size_t mShardIndex = 0;
+        size_t mShardCount = 1;
+        bool mShardByDuration = false;
+
+        size_t mMaxFailures = 0;
+        size_t mFailureCount = 0;
+        std::stop_source mStopSource;
+
+        /**
+         * @brief The results of a collection whose tests are still running
+         */
+        struct CollectionProgress {
+            size_t remaining = 0;
+            TestStats stats;
+        };
+
+        std::mutex mReportMutex;
+        std::unordered_map<TestCollection*, CollectionProgress> mProgress;
+        TestStats mRunStats;
+
+        std::chrono::milliseconds mTimeout{0};
+        uint64_t mSeed = randomSeed();
+
+        size_t mRepeatCount = 1;
+        bool mUntilFail = false;
+        bool mShuffle = false;
+
+        AppendList<FixtureBase*> mFixtures;
+
+        /**
+         * @brief A registered test that is only constructed once it is selected
+         */
+        struct TestDescriptor {
+            const char* collection;
+            const char* name;
+            const char* tags;
+            std::unique_ptr<Testable> (*factory)(std::string name);
+            bool instantiated = false;
+        };
+
+        AppendList<TestDescriptor> mRegistry;
+        TestFilter mFilter;
+
+        PluginLoader mPlugins;
+        std::string mPluginCachePath;
+        std::atomic<size_t> mAbandonedTests = 0;
 
         friend TestCollection;
 
+        /**
+         * @brief A test and the collection it belongs to
+         */
+        struct TestJob {
+            TestCollection* collection;
+            Testable* test;
+        };
+
+        /**
+         * @brief A test that runs under a timeout in thread mode
+         * 
+         * Either the worker reports the test once it returned or, if the
+         * watchdog abandoned the test first, the watchdog reports it.
+         */
+        struct InFlightTest {
+            TestJob job;
+            std::chrono::milliseconds timeout;
+            size_t worker;
+            std::chrono::steady_clock::time_point started;
+            // set by the watchdog, the worker can not ask an abandoned test, its owner may have destroyed it
+            std::atomic<bool> decided = false;
+            std::atomic<bool> abandoned = false;
+            std::atomic<bool> replaced = false;
+        };
+
+        std::mutex mAsyncMutex;
+        std::condition_variable mAsyncIdle;
+        size_t mRunningAsync = 0;
+
+        std::mutex mInFlightMutex;
+        std::unordered_map<const Testable*, std::shared_ptr<InFlightTest>> mInFlight;
+
+        // declared last, so no timer fires while the other members are destroyed
+        std::unique_ptr<Watchdog> mWatchdog;
+
+        /**
+         * @brief Get the timeout of a test
+         * 
+         * @param job the test
+         * @return std::chrono::milliseconds the timeout of the test, its collection or the default, 0 for none
+         */
+        std::chrono::milliseconds timeoutOf(const TestJob& job) const;
+
+        /**
+         * @brief Run a test on the current worker under the watchdog
+         * 
+         * @param job the test
+         * @param timeout the timeout of the test
+         * @param stopToken the stop token of the run
+         */
+        void runWithTimeout(const TestJob& job, std::chrono::milliseconds timeout, const std::stop_token& stopToken);
+
+        /**
+         * @brief Report a test that exceeded its timeout and replace its worker thread
+         * 
+         * Called by the watchdog. Writes the tests that are still in flight to stderr.
+         * 
+         * @param test the test
+         */
+        void abandonTest(InFlightTest& test);
+
+        /**
+         * @brief Hand the result of a finished test to the reporters
+         * 
+         * Also finishes the collection of the test once its last test finished
+         * and cancels the run once the maximum number of failures is reached.
+         * 
+         * @param job the finished test
+         */
+        void reportTestFinished(const TestJob& job);
+
+        /**
+         * @brief Compare a passed test with its baseline and fail it if it regressed
+         * 
+         * Records the test in the baseline when updating it.
+         * Benchmarks are compared by their samples, other tests by their duration.
+         * 
+         * @param job the finished test
+         * @return std::optional<BaselineComparison> the comparison, if the test has a baseline
+         */
+        std::optional<BaselineComparison> compareWithBaseline(const TestJob& job);
+
+        /**
+         * @brief Remove all tests that belong to other shards
+         * 
+         * Tests are partitioned by their registration order. Balanced by count,
+         * every shard takes every shard count-th test. Balanced by duration,
+         * the tests are assigned longest first to the shard with the least
+         * expected work, using the timing cache.
+         * 
+         * @param jobs all tests, in registration order
+         */
+        void selectShard(std::vector<TestJob>& jobs) const;
+
+        /**
+         * @brief Load the plugins that may contain selected tests
+         * 
+         * Records the tests every loaded plugin registered in the plugin cache.
+         */
+        void loadPlugins();
+
+        /**
+         * @brief Remove the registrations of the loaded plugins and unload them
+         */
+        void unloadPlugins();
+
+        /**
+         * @brief Remove a collection that is destroyed
+         * 
+         * @param collection the collection
+         */
+        void unregisterTestCollection(const TestCollection* collection);
+
+        /**
+         * @brief Record the declared dependencies of tests in the dependency index
+         * 
+         * Tests that declare none keep the dependencies known to the index.
+         * 
+         * @param jobs the tests
+         */
+        void recordDependencies(const std::vector<TestJob>& jobs);
+
+        /**
+         * @brief Remove all tests the changed files can not affect
+         * 
+         * Tests without an entry in the dependency index are kept.
+         * 
+         * @param jobs the tests
+         */
+        void selectAffected(std::vector<TestJob>& jobs) const;
+
+        /**
+         * @brief Order tests longest expected duration first
+         * 
+         * Tests without a recorded duration keep their registration order
+         * and run before all others, since any of them might be the longest.
+         * 
+         * @param jobs the tests to order
+         */
+        void orderJobs(std::vector<TestJob>& jobs) const;
+
+        /**
+         * @brief Construct the registered tests the filter selects
+         * 
+         * Adds them to their collections, which are created if needed.
+         */
+        void instantiateRegisteredTests();
+
+        /**
+         * @brief Move tests that share fixtures next to each other
+         * 
+         * A group takes the place of its first test, so the fixture is created
+         * once and torn down as soon as possible. Groups whose fixture is still
+         * alive from an earlier run go first. Global fixtures are ignored,
+         * every test shares them.
+         * 
+         * @param jobs the ordered tests
+         */
+        void groupByFixture(std::vector<TestJob>& jobs) const;
+
+        /**
+         * @brief Call a function for every fixture a test depends on
+         * 
+         * @param job the test
+         * @param function called with every fixture of the test, its collection and the global ones
+         */
+        template<typename Function>
+        void forEachFixture(const TestJob& job, Function function) const {
+            for (auto fixture : job.test->get_fixtures()) function(*fixture);
+            for (auto fixture : job.collection->getFixtures()) function(*fixture);
+            for (auto fixture : mFixtures) {
+                // the fixtures of unloaded plugins leave an empty slot
+                if (fixture) function(*fixture);
+            }
+        }
+
+        /**
+         * @brief Run tests and wait for them to finish
+         * 
+         * Runs the tests on the Scheduler or, in isolation mode, in forked worker processes.
+         * The tests that need an exclusive run follow one at a time once all others finished.
+         * 
+         * @param jobs the tests to run
+         */
+        static void runJobs(std::vector<TestJob> jobs);
+
+        /**
+         * @brief Check if a test has to run without other tests in flight
+         * 
+         * Benchmarks, tests whose timing a baseline gates, and every test while
+         * the baseline is recorded would otherwise measure the contention with
+         * the other workers.
+         * 
+         * @param job the test
+         * @return true the test runs on its own
+         */
+        bool needsExclusiveRun(const TestJob& job) const;
+
+        /**
+         * @brief Run tests in forked worker processes and wait for them to finish
+         * 
+         * @param jobs the tests to run
+         * @param workerCount the number of worker processes
+         * @param stopToken the stop token of the run
+         */
+        void runIsolated(const std::vector<TestJob>& jobs, size_t workerCount, const std::stop_token& stopToken);
+
+        /**
+         * @brief Schedule a test on the Scheduler, it is reported once it finished
+         * 
+         * @param job the test
+         * @param stopToken the stop token of the run
+         */
+        void scheduleJob(const TestJob& job, const std::stop_token& stopToken);
+
+        /**
+         * @brief Wait until all scheduled tests, including suspended async tests, finished
+         */
+        void waitForJobs();
+
+        /**
+         * @brief Run tests repeatedly and report the pass rate of every test
+         * 
+         * Every repetition resets the tests and runs them in an order shuffled
+         * with the seed of the run. Abandoned tests do not run again.
+         * 
+         * @param jobs the tests to run
+         */
+        void repeatJobs(const std::vector<TestJob>& jobs);
+
+        /**
+         * @brief Pick the seed of a run that has none set
+         * 
+         * @return uint64_t the seed
+         */
+        static uint64_t randomSeed();
+
     public:
         TestController() = default;
         ~TestController() = default;
@@ -32,17 +358,37 @@ namespace PidgeonPulse {
         /**
          * @brief Add a TestCollection to the TestController
          * 
+         * The collection is owned by the controller. Safe to call from
+         * multiple threads, like all registration functions.
+         * 
          * @param name the name of the TestCollection
          */
         static TestCollection& addTestCollection(std::string name);
 
+        /**
+         * @brief Destroy the controller with everything registered with it and start over
+         * 
+         * Collections created by addTestCollection() and registered tests are
+         * destroyed, collections owned by the caller stay valid but are no
+         * longer known to the controller.
+         * @note No tests may be running.
+         */
+        static void reset();
+
         /**
          * @brief Add a Test to the TestController
          * 
-         * Runs the Tests
+         * Runs the Tests and streams the results to the reporters
          */
         static void runTests();
 
+        /**
+         * @brief Add a Reporter that receives the results while the tests run
+         * 
+         * @param reporter the reporter
+         */
+        static void addReporter(std::unique_ptr<Reporter> reporter);
+
         /**
          * @brief Generate a report of the tests
          * 
@@ -58,5 +404,271 @@ namespace PidgeonPulse {
          */
         static TestCollection& getTestCollection(const std::string& name);
 
+        /**
+         * @brief Set the number of worker threads used to run the tests
+         * @note Has to be called before the tests are run.
+         * 
+         * @param count the number of workers, 0 uses the hardware concurrency
+         */
+        static void setWorkerCount(size_t count);
+
+        /**
+         * @brief Get the Scheduler shared by all TestCollections
+         * 
+         * The Scheduler is created on first use.
+         * 
+         * @return Scheduler& the Scheduler
+         */
+        static Scheduler& getScheduler();
+
+        /**
+         * @brief Enable or disable process isolation
+         * 
+         * In isolation mode every test runs in one of a pool of worker processes
+         * forked from this process, so a crashing test can not take down the run.
+         * The worker count is used as the number of processes.
+         * @note Has to be called before the Scheduler is used,
+         *       the parent process must not run other threads when forking.
+         * 
+         * @param enabled whether tests run in worker processes
+         */
+        static void setIsolation(bool enabled);
+
+        /**
+         * @brief Use a timing cache to schedule the longest tests first
+         * 
+         * Loads the durations recorded by earlier runs from the file and saves
+         * the updated durations after runTests() finished.
+         * 
+         * @param path the path of the cache file
+         */
+        static void setTimingCache(const std::string& path);
+
+        /**
+         * @brief Use a dependency index to record the source files of the tests
+         * 
+         * Loads the index from the file and saves it with the dependencies
+         * the tests declared after runTests() finished.
+         * 
+         * @param path the path of the index file
+         */
+        static void setDependencyIndex(const std::string& path);
+
+        /**
+         * @brief Only run the tests the changed files can affect
+         * 
+         * Tests whose dependencies are unknown always run.
+         * 
+         * @param files the changed files, relative to the root of the repository
+         */
+        static void setChangedFiles(const std::vector<std::string>& files);
+
+        /**
+         * @brief Compare the timing of the tests with a baseline of earlier runs
+         * 
+         * Tests that got significantly slower by more than the tolerance fail,
+         * the reporters receive the change of every test that has a baseline.
+         * Tests that have a baseline run on their own, after each other, so
+         * the compared timings do not include the load of concurrent tests.
+         * While the baseline is updated every test runs on its own, which
+         * serializes the whole run.
+         * 
+         * @param path the path of the baseline file
+         * @param tolerance the allowed relative slowdown, e.g. 0.1 for 10%
+         * @param update record the results of this run and save the baseline after runTests() finished
+         */
+        static void setBaseline(const std::string& path, double tolerance = 0.1, bool update = false);
+
+        /**
+         * @brief Only run one shard of the tests
+         * 
+         * Every shard of a suite has to be run by the same binary and, when
+         * balancing by duration, with the same timing cache, so that all
+         * shards agree on the partition.
+         * 
+         * @param index the index of the shard to run
+         * @param count the number of shards
+         * @param balanceByDuration balance the shards by recorded durations instead of test count
+         */
+        static void setShard(size_t index, size_t count, bool balanceByDuration = false);
+
+        /**
+         * @brief Cancel the run after a number of failed tests
+         * 
+         * Once the limit is reached, tests that did not start yet are reported
+         * as skipped and running tests are asked to stop through their stop token.
+         * 
+         * @param count the number of failures that cancel the run, 0 never cancels
+         */
+        static void setMaxFailures(size_t count);
+
+        /**
+         * @brief Set the timeout of the tests that have none of their own
+         * 
+         * In thread mode a test that exceeds its timeout is reported as timed out
+         * and its worker thread is abandoned and replaced. In isolation mode its
+         * worker process is killed.
+         * 
+         * @param timeout the timeout, 0 for no timeout
+         */
+        static void setTimeout(std::chrono::milliseconds timeout);
+
+        /**
+         * @brief Count hardware events while the tests run
+         * 
+         * Every test reports the cycles, instructions, cache misses and branch
+         * misses of its run phase. If the kernel denies access to the counters,
+         * a warning is written once and the tests run without them.
+         * 
+         * @param enabled whether to count
+         */
+        static void setPerfCounters(bool enabled);
+
+        /**
+         * @brief Run the tests repeatedly to find flaky ones
+         * 
+         * The reporters receive every repetition and the pass rate of
+         * every test at the end.
+         * 
+         * @param count the number of repetitions, 0 for no limit if untilFail is set
+         * @param untilFail stop after the first repetition in which a test failed
+         */
+        static void setRepeat(size_t count, bool untilFail = false);
+
+        /**
+         * @brief Get the number of timed out tests whose threads were abandoned
+         * 
+         * Abandoned threads may still be running, so the process should not
+         * run static destructors once this is not 0.
+         * 
+         * @return size_t the number of abandoned tests
+         */
+        static size_t getAbandonedTestCount();
+
+        /**
+         * @brief Get the results of the last run
+         * 
+         * Counts every repetition, a test that regressed against the baseline counts as failed.
+         * 
+         * @return const TestStats& the results
+         */
+        static const TestStats& getRunStats();
+
+        /**
+         * @brief Set the seed of the generated test data
+         * 
+         * Every run picks a random seed unless one is set,
+         * a failing property test reports the seed it ran with.
+         * 
+         * @param seed the seed
+         */
+        static void setSeed(uint64_t seed);
+
+        /**
+         * @brief Get the seed of the generated test data
+         * 
+         * @return uint64_t the seed
+         */
+        static uint64_t getSeed();
+
+        /**
+         * @brief Get the Scheduler a running test may hand helper jobs to
+         * 
+         * Helper jobs must not be waited for, the workers may all be busy.
+         * 
+         * @return Scheduler* the Scheduler, nullptr in isolation mode or before it was started
+         */
+        static Scheduler* getHelperScheduler();
+
+        /**
+         * @brief Declare that every test uses a shared fixture
+         * 
+         * @param fixture the fixture
+         */
+        static void useFixture(FixtureBase& fixture);
+
+        /**
+         * @brief Only run the tests a filter expression selects
+         * 
+         * Applies to runTests(), can be called multiple times.
+         * See TestFilter for the syntax.
+         * 
+         * @param expression the filter expression
+         * @throws std::invalid_argument if the expression is invalid
+         */
+        static void addFilter(std::string_view expression);
+
+        /**
+         * @brief Add a test module that is loaded by runTests()
+         * 
+         * Plugins are only loaded if the filter may select some of their tests,
+         * and unloaded once the run finished. See PluginLoader.
+         * 
+         * @param path the path of the shared object
+         */
+        static void addPlugin(std::string path);
+
+        /**
+         * @brief Add all test modules in a directory
+         * 
+         * @param path the path of the directory
+         * @throws std::runtime_error if the directory can not be read
+         */
+        static void addPluginDirectory(const std::string& path);
+
+        /**
+         * @brief Remember the tests of the plugins in a file
+         * 
+         * Lets later runs with a filter skip plugins without selected tests.
+         * 
+         * @param path the path of the cache file
+         */
+        static void setPluginCache(const std::string& path);
+
+        /**
+         * @brief Register a test that is constructed only if the filter selects it
+         * 
+         * The names and tags are not copied, they have to outlive the run,
+         * e.g. string literals.
+         * 
+         * @param collection the name of the collection
+         * @param name the name of the test
+         * @param tags the tags of the test in the form "[a][b]"
+         * @param factory constructs the test with the given name
+         */
+        static void registerTest(const char* collection, const char* name, const char* tags,
+                                 std::unique_ptr<Testable> (*factory)(std::string name));
+
+        /**
+         * @brief Register a test class that is constructed only if the filter selects it
+         * 
+         * @tparam T the test, constructible from its name
+         * @param collection the name of the collection
+         * @param name the name of the test
+         * @param tags the tags of the test in the form "[a][b]"
+         */
+        template<typename T>
+        static void registerTest(const char* collection, const char* name, const char* tags = "") {
+            registerTest(collection, name, tags, [](std::string testName) -> std::unique_ptr<Testable> {
+                return std::make_unique<T>(std::move(testName));
+            });
+        }
+
     };
 } // namespace PidgeonPulse
+
+#define PIDGEON_PULSE_CONCAT_IMPL(a, b) a##b
+#define PIDGEON_PULSE_CONCAT(a, b) PIDGEON_PULSE_CONCAT_IMPL(a, b)
+
+/**
+ * @brief Register a test class at static initialization, it is only constructed if selected
+ *
+ * `PIDGEON_PULSE_REGISTER_TEST(ParserTest, "Parser", "parses numbers", "[fast]");`
+ */
+#define PIDGEON_PULSE_REGISTER_TEST(Type, collection, name, tags) \
+    static const bool PIDGEON_PULSE_CONCAT(pidgeonPulseRegistered, __COUNTER__) = \
+        (::PidgeonPulse::TestController::registerTest<Type>(collection, name, tags), true)
+
+#ifndef PIDGEON_PULSE_NO_SHORT_MACROS
+#define PP_REGISTER_TEST(Type, collection, name, tags) PIDGEON_PULSE_REGISTER_TEST(Type, collection, name, tags)
+#endif
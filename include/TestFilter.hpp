@@ -0,0 +1,117 @@
+/**
+ * @file TestFilter.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-05-01
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief Selects tests by their names and tags
+ *
+ * A filter is a comma separated list of terms:
+ * - `pattern` a glob with `*` and `?` matched against the test name,
+ *   or against `collection/test` if it contains a `/`
+ * - `re:pattern` the same with a regular expression
+ * - `[tag]` tests with the tag, `[a][b]` tests with both tags
+ * - any term prefixed with `-` excludes the tests it matches
+ *
+ * A test is selected if it matches any including term, or there are none,
+ * and no excluding term.
+ */
+class TestFilter {
+private:
+    /**
+     * @brief A single term of the filter
+     */
+    struct Term {
+        enum class KIND {
+            GLOB,
+            REGEX,
+            TAGS
+        };
+
+        KIND kind;
+        bool exclude;
+        bool qualified;
+        std::string pattern;
+        std::regex regex;
+    };
+
+    std::vector<Term> mTerms;
+    bool mHasIncludes = false;
+
+    /**
+     * @brief Check if a single term matches a test
+     *
+     * @param term the term
+     * @param collection the name of the collection
+     * @param test the name of the test
+     * @param tags the tags of the test and its collection
+     * @return true the term matches
+     * @return false the term does not match
+     */
+    static bool matches(const Term& term, std::string_view collection, std::string_view test, std::string_view tags);
+
+public:
+    /**
+     * @brief Check if a name matches a glob pattern
+     *
+     * @param pattern the pattern, `*` matches any text, `?` any character
+     * @param text the name
+     * @return true the name matches
+     * @return false the name does not match
+     */
+    static bool globMatch(std::string_view pattern, std::string_view text);
+
+    /**
+     * @brief Check if a tag list contains a tag
+     *
+     * @param tags the tags in the form `[a][b]`
+     * @param tag the tag without brackets
+     * @return true the tag is in the list
+     * @return false the tag is not in the list
+     */
+    static bool hasTag(std::string_view tags, std::string_view tag);
+
+    /**
+     * @brief Add the terms of a filter expression
+     *
+     * @param expression comma separated terms, commas in braces or brackets or after a backslash belong to a regex term
+     * @throws std::invalid_argument if a term is empty or not a valid regular expression
+     */
+    void add(std::string_view expression);
+
+    /**
+     * @brief Check if the filter has no terms and selects every test
+     *
+     * @return true the filter is empty
+     * @return false the filter has terms
+     */
+    inline bool empty() const { return mTerms.empty(); }
+
+    /**
+     * @brief Check if a test is selected
+     *
+     * @param collection the name of the collection
+     * @param test the name of the test
+     * @param tags the tags of the test
+     * @param collectionTags the tags of the collection
+     * @return true the test is selected
+     * @return false the test is filtered out
+     */
+    bool matches(std::string_view collection, std::string_view test, std::string_view tags = {}, std::string_view collectionTags = {}) const;
+};
+
+} // namespace PidgeonPulse
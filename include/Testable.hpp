@@ -10,18 +10,66 @@
  */
 
 #pragma once
+#include "AllocationTracker.hpp"
+#include "Assertion.hpp"
+#include "FailList.hpp"
+#include "Fixture.hpp"
+#include "PerfCounters.hpp"
+#include "VirtualClock.hpp"
+
+#include <atomic>
 #include <chrono>
+#include <source_location>
+#include <stop_token>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <exception>
-#include <sstream>
-#include <iomanip>
 
+#include <cstdio>
 #include <cstring>
 #define __FILENAME__ (strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 : __FILE__)
 
 namespace PidgeonPulse {
 
+/**
+ * @brief Where the time of a single test run went
+ *
+ * The phases are measured by the thread that runs the test, the queue wait
+ * and the worker are filled in by whoever scheduled it.
+ */
+struct TestMetrics {
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point queued;
+    Clock::time_point setupStart;
+    Clock::time_point runStart;
+    Clock::time_point runEnd;
+    Clock::time_point teardownEnd;
+    Clock::time_point reportStart;
+    std::chrono::nanoseconds cpuTime{0};
+    /// false if the run moved between threads or did not run, cpuTime is 0 then
+    bool cpuTimeMeasured = false;
+    size_t worker = 0;
+    /// the allocations of the thread that ran the test, during run() only
+    AllocationStats allocations;
+    /// the hardware events of the thread that ran the test, during run() only
+    PerfStats counters;
+
+    /**
+     * @brief Get the time the test waited for a worker
+     *
+     * @return Clock::duration the wait, 0 if the test was not queued
+     */
+    Clock::duration queueWait() const {
+        return queued == Clock::time_point() ? Clock::duration::zero() : setupStart - queued;
+    }
+
+    Clock::duration setup() const { return runStart - setupStart; }
+    Clock::duration run() const { return runEnd - runStart; }
+    Clock::duration teardown() const { return teardownEnd - runEnd; }
+};
+
 /**
  * Unit Test base class
  * @brief Unit Test base class
@@ -45,6 +93,8 @@ private:
      * - PASSED: The test has passed.
      * - FAILED: The test has failed.
      * - FAIL_WITH_EXCEPTION: The test has failed with an exception.
+     * - SKIPPED: The test was cancelled before it finished.
+     * - TIMED_OUT: The test did not finish within its timeout.
      */
     enum class STATE {
         PROGRESS_BIT = 0b0001,
@@ -52,38 +102,34 @@ private:
         FAIL_BIT = 0b0100,
         NOT_RUN = 0b0000,
         EXCEPTION_BIT = 0b1000,
+        SKIP_BIT = 0b10000,
+        TIMEOUT_BIT = 0b100000,
         IN_PROGRESS = PROGRESS_BIT,
         FAILED = READY_BIT | FAIL_BIT,
         FAIL_WITH_EXCEPTION = READY_BIT | FAIL_BIT | EXCEPTION_BIT,
+        SKIPPED = READY_BIT | SKIP_BIT,
+        TIMED_OUT = READY_BIT | FAIL_BIT | EXCEPTION_BIT | TIMEOUT_BIT,
         PASSED = READY_BIT
     };
 
     friend STATE operator&(STATE a, STATE b);
     friend STATE operator|(STATE a, STATE b);
 
-    /**
-     * @brief Information about a test failure.
-     *
-     * This struct contains information about a test failure,
-     * including the file and line number where the failure occurred.
-     */
-    struct FailInfo {
-        const char* file;
-        int line;
-        std::exception_ptr exception;
-    };
+    friend class ForkServer;
+    friend class TestController;
+
+    using FailInfo = PidgeonPulse::FailInfo;
 
     /**
      * @brief Fatal exception class.
      *
      * This class represents a fatal exception that is thrown when a test fails.
+     * The message is formatted into an inline buffer, so failing does not allocate.
      */
     class FatalException : public std::exception {
     public:
         FatalException(const char* file, int line): mFile(file), mLine(line) {
-            std::ostringstream oss;
-            oss << "Fatal exception : " << std::quoted(mFile) << " : " << mLine;
-            mWhat = oss.str().c_str();
+            std::snprintf(mWhat, sizeof(mWhat), "Fatal exception : \"%s\" : %d", mFile ? mFile : "", mLine);
         }
 
         /**
@@ -92,7 +138,7 @@ private:
          * @return const char* the exception message.
          */
         const char* what() const noexcept override {
-            return mWhat.c_str();
+            return mWhat;
         }
 
         /**
@@ -117,15 +163,97 @@ private:
         const char* mFile;
         int mLine;
 
-        std::string mWhat;
+        char mWhat[128];
+    };
+
+    /**
+     * @brief Thrown by skip() to leave the test.
+     */
+    class SkipException : public std::exception {
+    public:
+        const char* what() const noexcept override {
+            return "Test skipped";
+        }
     };
 
 private:
-    STATE mState = STATE::NOT_RUN;
+    std::atomic<STATE> mState = STATE::NOT_RUN;
     std::chrono::time_point<std::chrono::high_resolution_clock> mStartTime;
     std::chrono::time_point<std::chrono::high_resolution_clock> mEndTime;
     std::string mTestName;
-    std::vector<FailInfo> mFailInfos;
+    FailList mFailInfos;
+    // the failures of the current run, only touched by the thread running the test
+    FailList mRunFailInfos;
+    STATE mRunState = STATE::NOT_RUN;
+    std::stop_token mStopToken;
+    std::chrono::milliseconds mTimeout{0};
+    TestMetrics mMetrics;
+    std::vector<FixtureBase*> mFixtures;
+    std::string mTags;
+    std::vector<std::string> mDependencies;
+    VirtualClock mClock;
+
+    /**
+     * @brief Who decided the result of the current run.
+     *
+     * The thread running the test and the watchdog race to claim the result,
+     * only the winner writes the times, the metrics, the failures and the final state.
+     * The watchdog can still claim a test while it is torn down.
+     */
+    enum class OUTCOME {
+        OPEN,
+        TEARDOWN,
+        FINISHED,
+        ABANDONED
+    };
+
+    std::atomic<OUTCOME> mOutcome = OUTCOME::OPEN;
+
+    /**
+     * @brief Mark the test as skipped without running it.
+     */
+    void mark_skipped();
+
+    /**
+     * @brief Mark the test as timed out.
+     *
+     * Used for tests that did not run in this process and by abandon().
+     * The test is reported to have run for exactly its timeout.
+     *
+     * @param timeout the timeout the test exceeded.
+     */
+    void mark_timed_out(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Abandon the test while it may still be running and mark it as timed out.
+     *
+     * The test keeps recording its failures for itself
+     * and never publishes them or its state if it ever returns.
+     *
+     * @param timeout the timeout the test exceeded.
+     * @return true the test was abandoned.
+     * @return false the test finished and was torn down first.
+     */
+    bool abandon(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Check if the last run was abandoned.
+     *
+     * @return true abandon() claimed the result of the run.
+     */
+    bool was_abandoned() const;
+
+    /**
+     * @brief Record a failure of the current run.
+     *
+     * The failure is published with the result by end_run(),
+     * unless the test was abandoned first.
+     *
+     * @param failInfo the failure.
+     * @param bits the state bits to set.
+     * @param fatal whether to leave the test by throwing a FatalException.
+     */
+    void record_failure(const FailInfo& failInfo, STATE bits, bool fatal);
 
 protected:
     /**
@@ -169,6 +297,93 @@ protected:
      */
     void fail_with_exception();
 
+    /**
+     * @brief Check if the run was cancelled.
+     *
+     * Long running tests should poll this and return early,
+     * for example through skip(), once it returns true.
+     *
+     * @return true the remaining tests should stop.
+     */
+    bool stop_requested() const;
+
+    /**
+     * @brief Get the stop token of the current run.
+     *
+     * @return const std::stop_token& the stop token, e.g. to register a std::stop_callback.
+     */
+    const std::stop_token& get_stop_token() const;
+
+    /**
+     * @brief Stop the test and report it as skipped.
+     *
+     * Failures recorded before still fail the test.
+     */
+    [[noreturn]] void skip();
+
+    /**
+     * @brief Get the name of the file of a call site without its directories.
+     *
+     * @param location the call site.
+     * @return const char* the file name.
+     */
+    static const char* source_file(const std::source_location& location);
+
+    /**
+     * @brief Mark the test as failed by an assertion.
+     *
+     * This method records the call site of the assertion, the asserted
+     * expression and the expression with its operands expanded.
+     *
+     * @param location the call site of the assertion.
+     * @param expression the asserted expression, has to outlive the test.
+     * @param message the expanded expression, it is copied.
+     * @param fatal whether the failure is fatal.
+     */
+    void fail_assertion(const std::source_location& location, const char* expression, std::string_view message, bool fatal);
+
+    /**
+     * @brief Mark the test as failed by a decomposed expression.
+     *
+     * The expression is formatted into a bounded buffer on the stack,
+     * and not at all once the test recorded as many failures as it keeps.
+     *
+     * @tparam Expression the type of the decomposed expression.
+     * @param location the call site of the assertion.
+     * @param text the asserted expression, has to outlive the test.
+     * @param expression the decomposed expression.
+     * @param fatal whether the failure is fatal.
+     */
+    template<typename Expression>
+    void fail_expression(const std::source_location& location, const char* text, const Expression& expression, bool fatal) {
+        if ( mRunFailInfos.full() ) {
+            fail_assertion(location, text, {}, fatal);
+            return;
+        }
+        MessageBuffer message;
+        expression.expand(message);
+        fail_assertion(location, text, message.text(), fatal);
+    }
+
+    /**
+     * @brief Assert a decomposed expression.
+     *
+     * This method is called by the PIDGEON_PULSE_ASSERT and PIDGEON_PULSE_CHECK macros.
+     * The operands are only converted to text if the expression is false.
+     *
+     * @tparam Expression the type of the decomposed expression.
+     * @param expression the decomposed expression.
+     * @param text the source text of the expression.
+     * @param fatal whether a failure is fatal.
+     * @param location the call site of the assertion.
+     */
+    template<typename Expression>
+    void assert_expression(const Expression& expression, const char* text, bool fatal,
+                           std::source_location location = std::source_location::current()) {
+        if ( !static_cast<bool>(expression) ) [[unlikely]] {
+            fail_expression(location, text, expression, fatal);
+        }
+    }
 
     /**
      * @brief Assert that a condition is true.
@@ -177,8 +392,9 @@ protected:
      * If the condition is false, the test is marked as failed.
      *
      * @param condition the condition to assert.
+     * @param location the call site of the assertion.
      */
-    void assert_true(bool condition);
+    void assert_true(bool condition, std::source_location location = std::source_location::current());
 
     /**
      * @brief Assert that a condition is false.
@@ -187,8 +403,9 @@ protected:
      * If the condition is true, the test is marked as failed.
      *
      * @param condition the condition to assert.
+     * @param location the call site of the assertion.
      */
-    void assert_false(bool condition);
+    void assert_false(bool condition, std::source_location location = std::source_location::current());
 
     /**
      * @brief Assert that two values are equal.
@@ -199,11 +416,12 @@ protected:
      * @tparam T the type of the values to compare.
      * @param a the first value to compare.
      * @param b the second value to compare.
+     * @param location the call site of the assertion.
      */
     template<typename T>
-    void assert_eq(const T& a, const T& b) {
-        if ( a != b ) {
-            fail(__FILENAME__, __LINE__, true);
+    void assert_eq(const T& a, const T& b, std::source_location location = std::source_location::current()) {
+        if ( !(a == b) ) [[unlikely]] {
+            fail_expression(location, "assert_eq(a, b)", BinaryExpression<T, T>(a, "==", b, false), true);
         }
     }
 
@@ -216,11 +434,12 @@ protected:
      * @tparam T the type of the values to compare.
      * @param a the first value to compare.
      * @param b the second value to compare.
+     * @param location the call site of the assertion.
      */
     template<typename T>
-    void assert_ne(const T& a, const T& b) {
-        if ( a == b ) {
-            fail(__FILENAME__, __LINE__, true);
+    void assert_ne(const T& a, const T& b, std::source_location location = std::source_location::current()) {
+        if ( !(a != b) ) [[unlikely]] {
+            fail_expression(location, "assert_ne(a, b)", BinaryExpression<T, T>(a, "!=", b, false), true);
         }
     }
 
@@ -234,17 +453,18 @@ protected:
      * @tparam Ex the type of the exception to expect.
      * @param function the function to call.
      * @param expected_exception the expected exception type.
+     * @param location the call site of the assertion.
      */
     template<typename Func, typename Ex>
-    void assert_throw(Func function, Ex expected_exception) {
+    void assert_throw(Func function, Ex expected_exception, std::source_location location = std::source_location::current()) {
         try {
             function();
-            fail(__FILENAME__, __LINE__, true);
         } catch ( Ex& ) {
-
+            return;
         } catch ( ... ) {
-            fail_with_exception(__FILENAME__, __LINE__, std::current_exception(), true);
+            fail_with_exception(source_file(location), location.line(), std::current_exception(), true);
         }
+        fail_assertion(location, "assert_throw(function, expected_exception)", "no exception was thrown", true);
     }
 
     /**
@@ -255,13 +475,14 @@ protected:
      *
      * @tparam Func the type of the function to call.
      * @param function the function to call.
+     * @param location the call site of the assertion.
      */
     template<typename Func>
-    void assert_no_throw(Func function) {
+    void assert_no_throw(Func function, std::source_location location = std::source_location::current()) {
         try {
             function();
         } catch ( ... ) {
-            fail_with_exception(__FILENAME__, __LINE__, std::current_exception(), true);
+            fail_with_exception(source_file(location), location.line(), std::current_exception(), true);
         }
     }
 
@@ -273,15 +494,98 @@ protected:
      *
      * @tparam Func the type of the function to call.
      * @param function the function to call.
+     * @param location the call site of the assertion.
      */
     template<typename Func>
-    void assert_any_throw(Func function) {
+    void assert_any_throw(Func function, std::source_location location = std::source_location::current()) {
         try {
             function();
-            fail(__FILENAME__, __LINE__, true);
         } catch ( ... ) {
+            return;
+        }
+        fail_assertion(location, "assert_any_throw(function)", "no exception was thrown", true);
+    }
+
+    /**
+     * @brief The timestamps of a run that was started but did not end yet.
+     */
+    struct RunPhase {
+        std::chrono::nanoseconds cpuStart{0};
+        TestMetrics::Clock::time_point setupStart;
+        TestMetrics::Clock::time_point runStart;
+        std::chrono::time_point<std::chrono::high_resolution_clock> startTime;
+        /// whether the run ends on the thread it began on, the cpu time is only measured then
+        bool threadBound = true;
+    };
+
+    /**
+     * @brief Set up the test and start recording a run.
+     *
+     * The first half of operator(), for tests whose body does not return
+     * before it finished.
+     *
+     * @param stopToken the stop token of the run.
+     * @param phase the timestamps of the run, filled in.
+     * @return true the body of the test can run.
+     * @return false the test was abandoned while setting up, it was torn down again.
+     */
+    bool begin_run(std::stop_token stopToken, RunPhase& phase);
 
+    /**
+     * @brief Tear the test down and publish the result of the run.
+     *
+     * The second half of operator(). Nothing is published if the test was abandoned.
+     *
+     * @param phase the timestamps filled in by begin_run().
+     * @param exception the exception the body of the test ended with, if any.
+     * @param allocations the allocations of the body.
+     * @param counters the hardware events of the body.
+     */
+    void end_run(const RunPhase& phase, const std::exception_ptr& exception,
+                 const AllocationStats& allocations, const PerfStats& counters);
+
+    /**
+     * @brief Assert that a function allocates at most a number of times.
+     *
+     * Only the allocations of the calling thread through operator new are counted.
+     * Without allocation tracking in the library the function is only called
+     * and a warning is written once.
+     *
+     * @tparam Func the type of the function to call.
+     * @param count the maximum number of allocations.
+     * @param function the function to call.
+     * @param location the call site of the assertion.
+     */
+    template<typename Func>
+    void assert_max_allocations(uint64_t count, Func function, std::source_location location = std::source_location::current()) {
+        if ( !AllocationTracker::available() ) {
+            AllocationTracker::warnUnavailable();
+            function();
+            return;
         }
+        AllocationStats stats;
+        {
+            AllocationTracker::Scope scope;
+            function();
+            stats = scope.stats();
+        }
+        if ( stats.allocations > count ) [[unlikely]] {
+            std::string message = std::to_string(stats.allocations) + " allocations of "
+                + std::to_string(stats.allocatedBytes) + " bytes, at most " + std::to_string(count) + " allowed";
+            fail_assertion(location, "assert_max_allocations(count, function)", message, true);
+        }
+    }
+
+    /**
+     * @brief Assert that a function does not allocate.
+     *
+     * @tparam Func the type of the function to call.
+     * @param function the function to call.
+     * @param location the call site of the assertion.
+     */
+    template<typename Func>
+    void assert_no_allocations(Func function, std::source_location location = std::source_location::current()) {
+        assert_max_allocations(0, std::move(function), location);
     }
 
 public:
@@ -356,27 +660,132 @@ public:
      */
     bool threw_exception() const;
 
+    /**
+     * @brief Check if the test was skipped.
+     *
+     * A test that failed before it was skipped counts as failed.
+     *
+     * @return true the test was cancelled before it finished.
+     * @return false the test ran to completion or failed.
+     */
+    bool was_skipped() const;
+
+    /**
+     * @brief Check if the test exceeded its timeout.
+     *
+     * @return true the test was stopped by the watchdog.
+     * @return false the test finished in time.
+     */
+    bool timed_out() const;
+
+    /**
+     * @brief Set the time the test may run before it is considered hanging.
+     *
+     * @param timeout the timeout, 0 uses the timeout of the collection.
+     */
+    void set_timeout(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Get the timeout of the test.
+     *
+     * @return std::chrono::milliseconds the timeout, 0 if none was set.
+     */
+    std::chrono::milliseconds get_timeout() const;
+
+    /**
+     * @brief Reset the test so it can run again.
+     *
+     * Keeps the test object and the buffers of its failures.
+     * @note Must not be called while the test runs or after it was abandoned.
+     */
+    void reset();
+
+    /**
+     * @brief Add a tag to the test, to select tests with --filter=[tag].
+     *
+     * @param tag the tag, without brackets.
+     */
+    void add_tag(std::string_view tag);
+
+    /**
+     * @brief Get the tags of the test.
+     *
+     * @return const std::string& the tags in the form "[a][b]".
+     */
+    const std::string& get_tags() const;
+
+    /**
+     * @brief Declare that the test uses a shared fixture.
+     *
+     * The fixture is kept alive until this test finished.
+     *
+     * @param fixture the fixture.
+     */
+    void use_fixture(FixtureBase& fixture);
+
+    /**
+     * @brief Get the fixtures the test uses itself.
+     *
+     * @return const std::vector<FixtureBase*>& the fixtures.
+     */
+    const std::vector<FixtureBase*>& get_fixtures() const;
+
+    /**
+     * @brief Declare a source file the test depends on, for --changed-files.
+     *
+     * @param path the path relative to the root of the repository, a directory if it ends with '/'.
+     */
+    void add_dependency(std::string path);
+
+    /**
+     * @brief Get the source files the test declared.
+     *
+     * @return const std::vector<std::string>& the paths.
+     */
+    const std::vector<std::string>& get_dependencies() const;
+
+    /**
+     * @brief Get the timing of the phases of the last run.
+     *
+     * @return const TestMetrics& the metrics.
+     */
+    const TestMetrics& get_metrics() const;
+
+    /**
+     * @brief Get the simulated clock of the test.
+     *
+     * The clock starts at zero with every run and is the current clock of the
+     * thread while the test sets up, runs and tears down. The body of an
+     * AsyncTest that moves between workers has no current clock, it has to
+     * pass this one on.
+     *
+     * @return VirtualClock& the clock.
+     */
+    VirtualClock& get_clock();
+
     /**
      * @brief Get all the fail infos.
      * 
-     * @return std::vector<FailInfo> the fail infos.
+     * @return const FailList& a view of the fail infos, including the count of dropped failures.
      */
-    std::vector<FailInfo> get_fail_infos() const;
+    const FailList& get_fail_infos() const;
 
     /**
      * @brief Get the name of the test.
      *
-     * @return std::string the name of the test.
+     * @return const std::string& the name of the test.
      */
-    std::string get_name() const;
+    const std::string& get_name() const;
 
     /**
      * @brief Run the test.
      *
      * This method is called to run the test.
      * It calls the setup() method, the run() method, and the teardown() method in sequence.
+     *
+     * @param stopToken signals the test that the run was cancelled.
      */
-    void operator()();
+    void operator()(std::stop_token stopToken = {});
 };
 
 Testable::STATE operator&(Testable::STATE a, Testable::STATE b);
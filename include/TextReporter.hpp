@@ -0,0 +1,83 @@
+/**
+ * @file TextReporter.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-23
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include "Reporter.hpp"
+#include "OutputSink.hpp"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace PidgeonPulse {
+
+class Benchmark;
+
+/**
+ * @brief Writes the plain text PidgeonPulse report
+ *
+ * Every collection is written as one block as soon as its last test
+ * finished. Until then only the failed tests and benchmarks of the
+ * collection are remembered. Benchmarks show the change against their
+ * baseline, regressed tests fail with it as their message.
+ */
+class TextReporter : public Reporter {
+private:
+    std::unique_ptr<OutputSink> mOwnedSink;
+    OutputSink& mSink;
+    std::unordered_map<const TestCollection*, std::vector<const Testable*>> mNotableTests;
+    std::unordered_map<const Testable*, BaselineComparison> mComparisons;
+
+    /**
+     * @brief Write the report of a failed test
+     *
+     * @param test the test that failed
+     */
+    void writeFailReport(const Testable& test);
+
+    /**
+     * @brief Write the report of a benchmark
+     *
+     * @param benchmark the benchmark
+     */
+    void writeBenchmarkReport(const Benchmark& benchmark);
+
+    /**
+     * @brief Write the hardware events of a test, if they were measured
+     *
+     * @param test the test
+     */
+    void writeCounters(const Testable& test);
+
+public:
+    /**
+     * @brief Construct a new Text Reporter object
+     *
+     * @param sink the sink to write the report to
+     */
+    explicit TextReporter(std::unique_ptr<OutputSink> sink);
+
+    /**
+     * @brief Construct a new Text Reporter object writing to a sink owned by the caller
+     *
+     * @param sink the sink to write the report to
+     */
+    explicit TextReporter(OutputSink& sink);
+
+    void runStarting() override;
+    void testFinished(const TestCollection& collection, const Testable& test) override;
+    void baselineCompared(const TestCollection& collection, const Testable& test, const BaselineComparison& comparison) override;
+    void collectionFinished(const TestCollection& collection, const TestStats& stats) override;
+    void repeatFinished(const std::vector<RepeatStats>& results, size_t repetitions, uint64_t seed) override;
+    void runFinished(const TestStats& stats) override;
+};
+
+} // namespace PidgeonPulse
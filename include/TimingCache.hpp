@@ -0,0 +1,87 @@
+/**
+ * @file TimingCache.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief Remembers the durations of tests between runs
+ *
+ * Tests are identified by a 64 bit hash of their collection and test name.
+ * The cache is stored as a compact binary file of hash and duration pairs.
+ */
+class TimingCache {
+private:
+    std::unordered_map<uint64_t, float> mDurations;
+
+public:
+    /**
+     * @brief Get the key of a test
+     *
+     * @param collection the name of the collection
+     * @param test the name of the test
+     * @return uint64_t the key of the test
+     */
+    static uint64_t key(std::string_view collection, std::string_view test);
+
+    /**
+     * @brief Load the cache from a file
+     *
+     * @param path the path of the cache file
+     * @return true the cache was loaded
+     * @return false the file does not exist or is no valid cache
+     */
+    bool load(const std::string& path);
+
+    /**
+     * @brief Save the cache to a file
+     *
+     * The file is replaced atomically, so concurrent runs never see a partial cache.
+     *
+     * @param path the path of the cache file
+     * @return true the cache was saved
+     * @return false the file could not be written
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Record the duration of a test
+     *
+     * Known durations are smoothed with the new measurement to dampen outliers.
+     *
+     * @param key the key of the test
+     * @param seconds the measured duration
+     */
+    void record(uint64_t key, double seconds);
+
+    /**
+     * @brief Get the expected duration of a test
+     *
+     * @param key the key of the test
+     * @return std::optional<double> the expected duration in seconds, if the test is known
+     */
+    std::optional<double> lookup(uint64_t key) const;
+
+    /**
+     * @brief Get the number of known tests
+     *
+     * @return size_t the number of tests
+     */
+    inline size_t size() const { return mDurations.size(); }
+};
+
+} // namespace PidgeonPulse
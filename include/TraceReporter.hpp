@@ -0,0 +1,106 @@
+/**
+ * @file TraceReporter.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-30
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include "Reporter.hpp"
+#include "OutputSink.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief Writes a timeline of the run in the Chrome trace event format
+ *
+ * Every worker gets its own track with the setup, run and teardown phases
+ * of its tests, the time tests waited in the queue is shown as async events
+ * and the time spent reporting results on the track of the reporting thread.
+ * The trace can be opened in chrome://tracing or Perfetto.
+ */
+class TraceReporter : public Reporter {
+private:
+    using Clock = TestMetrics::Clock;
+
+    std::unique_ptr<OutputSink> mOwnedSink;
+    OutputSink& mSink;
+
+    Clock::time_point mRunStart;
+    std::thread::id mMainThread;
+    std::vector<bool> mNamedTracks;
+    uint64_t mNextQueueId = 0;
+    bool mFirstEvent = true;
+
+    /**
+     * @brief Start a new event object, separated from the previous one
+     */
+    void beginEvent();
+
+    /**
+     * @brief Write a point in time as microseconds since the start of the run
+     *
+     * @param time the point in time
+     */
+    void writeTimestamp(Clock::time_point time);
+
+    /**
+     * @brief Write the fields shared by all events
+     *
+     * @param name the name of the event
+     * @param category the category of the event
+     * @param phase the trace event phase, e.g. "X" for a complete event
+     * @param track the track of the event
+     * @param time the time of the event
+     */
+    void writeHeader(std::string_view name, std::string_view category, std::string_view phase, size_t track, Clock::time_point time);
+
+    /**
+     * @brief Write an event with a duration, without arguments
+     *
+     * @param name the name of the event
+     * @param category the category of the event
+     * @param track the track of the event
+     * @param start the start of the event
+     * @param end the end of the event
+     */
+    void writeComplete(std::string_view name, std::string_view category, size_t track, Clock::time_point start, Clock::time_point end);
+
+    /**
+     * @brief Name a track the first time it is used
+     *
+     * @param track the track, 0 is the controller, every worker has its index + 1
+     */
+    void nameTrack(size_t track);
+
+public:
+    /**
+     * @brief Construct a new Trace Reporter object
+     *
+     * @param sink the sink to write the trace to
+     */
+    explicit TraceReporter(std::unique_ptr<OutputSink> sink);
+
+    /**
+     * @brief Construct a new Trace Reporter object writing to a sink owned by the caller
+     *
+     * @param sink the sink to write the trace to
+     */
+    explicit TraceReporter(OutputSink& sink);
+
+    void runStarting() override;
+    void testFinished(const TestCollection& collection, const Testable& test) override;
+    void runFinished(const TestStats& stats) override;
+};
+
+} // namespace PidgeonPulse
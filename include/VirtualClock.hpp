@@ -0,0 +1,220 @@
+/**
+ * @file VirtualClock.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-05-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief The clock type of the time points of a VirtualClock
+ *
+ * The time of a VirtualClock belongs to the instance, so its time points need a
+ * clock type with a static now(). This one reads the current clock of the calling
+ * thread and stays at zero outside of a test. It is not steady, the clock of a
+ * test starts at zero again with every run.
+ */
+struct SimulatedClock {
+    using duration = std::chrono::nanoseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<SimulatedClock>;
+    static constexpr bool is_steady = false;
+
+    /**
+     * @brief Get the time of the current clock of the calling thread
+     *
+     * @return time_point the simulated time, zero without a current clock
+     */
+    static time_point now();
+};
+
+/**
+ * @brief A simulated clock and timer service for time dependent code
+ *
+ * Time only moves when a sleep or advance() asks it to, and then it jumps:
+ * sleeping for an hour returns at once. Timers fire on the thread that moves
+ * the clock, ordered by their deadline and, for equal deadlines, by the order
+ * they were set. While a timer fires, now() is its deadline. Timers set by a
+ * firing timer fire in the same advance if they are due by its end.
+ *
+ * Every Testable owns a clock that starts at zero with every run and is the
+ * current clock of the thread running the test, so code under test can take
+ * the clock as a parameter or look it up through current().
+ */
+class VirtualClock {
+public:
+    using Duration = SimulatedClock::duration;
+    using TimePoint = SimulatedClock::time_point;
+    using Callback = std::function<void()>;
+    using TimerId = uint64_t;
+
+private:
+    mutable std::mutex mMutex;
+    TimePoint mNow{};
+    TimerId mNextId = 1;
+
+    // ordered by deadline, then by the order the timers were set
+    std::map<std::pair<TimePoint, TimerId>, Callback> mTimers;
+    std::unordered_map<TimerId, TimePoint> mDeadlines;
+
+    /**
+     * @brief Fire the next timer due by a point in time
+     *
+     * @param limit the latest deadline to fire
+     * @return true a timer fired
+     * @return false no timer was due, the clock did not move
+     */
+    bool fireNext(TimePoint limit);
+
+public:
+    /**
+     * @brief Makes a clock the current clock of the thread while it is alive
+     *
+     * Scopes can be nested, the previous clock is current again afterwards.
+     */
+    class Scope {
+    private:
+        VirtualClock* mPrevious;
+
+    public:
+        explicit Scope(VirtualClock& clock);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    VirtualClock() = default;
+
+    VirtualClock(const VirtualClock&) = delete;
+    VirtualClock& operator=(const VirtualClock&) = delete;
+
+    /**
+     * @brief Get the current simulated time
+     *
+     * @return TimePoint the time since the clock was reset
+     */
+    TimePoint now() const;
+
+    /**
+     * @brief Move the clock forward and fire the timers due on the way
+     *
+     * @param duration the time to move forward by
+     * @return size_t the number of timers that fired
+     */
+    size_t advance(Duration duration);
+
+    /**
+     * @brief Move the clock to a point in time and fire the timers due on the way
+     *
+     * The clock never moves backwards, a point in the past only fires the due timers.
+     *
+     * @param time the point in time
+     * @return size_t the number of timers that fired
+     */
+    size_t advanceTo(TimePoint time);
+
+    /**
+     * @brief Sleep for a duration of simulated time
+     *
+     * Returns at once, the timers due in the meantime fire on the calling thread.
+     *
+     * @param duration the time to sleep
+     */
+    template<typename Rep, typename Period>
+    void sleepFor(std::chrono::duration<Rep, Period> duration) {
+        advance(std::chrono::duration_cast<Duration>(duration));
+    }
+
+    /**
+     * @brief Sleep until a point in simulated time
+     *
+     * @param time the point in time to wake up at
+     */
+    void sleepUntil(TimePoint time);
+
+    /**
+     * @brief Set a timer that fires after a duration
+     *
+     * @param delay the time from now until the timer fires
+     * @param callback the callback
+     * @return TimerId the id to cancel the timer with
+     */
+    template<typename Rep, typename Period>
+    TimerId callAfter(std::chrono::duration<Rep, Period> delay, Callback callback) {
+        return callAt(now() + std::chrono::duration_cast<Duration>(delay), std::move(callback));
+    }
+
+    /**
+     * @brief Set a timer that fires at a point in time
+     *
+     * A timer in the past fires with the next advance.
+     *
+     * @param time the deadline of the timer
+     * @param callback the callback
+     * @return TimerId the id to cancel the timer with
+     */
+    TimerId callAt(TimePoint time, Callback callback);
+
+    /**
+     * @brief Cancel a timer
+     *
+     * @param id the id of the timer
+     * @return true the timer was cancelled before it fired
+     * @return false the timer already fired or was cancelled
+     */
+    bool cancel(TimerId id);
+
+    /**
+     * @brief Jump to the next timer and fire it
+     *
+     * @return true a timer fired
+     * @return false no timer was set
+     */
+    bool runNext();
+
+    /**
+     * @brief Fire timers in order until none are left
+     *
+     * @param limit the most timers to fire, bounds timers that keep setting new ones
+     * @return size_t the number of timers that fired
+     */
+    size_t runAll(size_t limit = SIZE_MAX);
+
+    /**
+     * @brief Get the number of timers that did not fire yet
+     *
+     * @return size_t the number of timers
+     */
+    size_t pendingTimers() const;
+
+    /**
+     * @brief Move the clock back to zero and drop all timers
+     */
+    void reset();
+
+    /**
+     * @brief Get the current clock of the calling thread
+     *
+     * @return VirtualClock* the clock of the test running on this thread, nullptr outside of a test
+     */
+    static VirtualClock* current();
+};
+
+} // namespace PidgeonPulse
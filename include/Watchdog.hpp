@@ -0,0 +1,113 @@
+/**
+ * @file Watchdog.hpp
+ * @author TL044CN
+ * @brief
+ * @version 0.1
+ * @date 2024-04-28
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace PidgeonPulse {
+
+/**
+ * @brief Fires callbacks once their timeout expired
+ *
+ * All timers share one thread and one hashed timer wheel: arming and
+ * disarming a timer is constant time and the thread only wakes up once per
+ * tick while timers are armed. Timers fire at most one tick late.
+ * Callbacks run on the watchdog thread, outside of its lock.
+ */
+class Watchdog {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+    using TimerId = uint64_t;
+
+private:
+    static constexpr size_t SLOT_COUNT = 256;
+
+    /**
+     * @brief An armed timer
+     */
+    struct Timer {
+        uint64_t expiryTick;
+        Callback callback;
+    };
+
+    Clock::duration mTick;
+    Clock::time_point mStart;
+    uint64_t mCurrentTick = 0;
+    TimerId mNextId = 1;
+
+    std::array<std::vector<TimerId>, SLOT_COUNT> mSlots;
+    std::unordered_map<TimerId, Timer> mTimers;
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mStopping = false;
+    std::thread mThread;
+
+    /**
+     * @brief Get the tick a point in time falls into, rounded up
+     *
+     * @param time the point in time
+     * @return uint64_t the tick
+     */
+    uint64_t tickOf(Clock::time_point time) const;
+
+    /**
+     * @brief The main loop of the watchdog thread
+     */
+    void run();
+
+public:
+    /**
+     * @brief Construct a new Watchdog object and start its thread
+     *
+     * @param tick the resolution of the timers
+     */
+    explicit Watchdog(Clock::duration tick = std::chrono::milliseconds(10));
+
+    /**
+     * @brief Destroy the Watchdog object
+     *
+     * Timers that did not fire yet are dropped.
+     */
+    ~Watchdog();
+
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    /**
+     * @brief Arm a timer
+     *
+     * @param timeout the time until the callback fires
+     * @param callback the callback
+     * @return TimerId the id to disarm the timer with
+     */
+    TimerId arm(Clock::duration timeout, Callback callback);
+
+    /**
+     * @brief Disarm a timer
+     *
+     * @param id the id of the timer
+     * @return true the timer was disarmed before it fired
+     * @return false the timer already fired or is firing right now
+     */
+    bool disarm(TimerId id);
+};
+
+} // namespace PidgeonPulse
@@ -0,0 +1,170 @@
+#include "AllocationTracker.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(PIDGEON_PULSE_HAVE_MALLOC_USABLE_SIZE)
+#include <malloc.h>
+#elif defined(PIDGEON_PULSE_HAVE_MALLOC_SIZE)
+#include <malloc/malloc.h>
+#endif
+
+namespace PidgeonPulse {
+
+namespace {
+
+/**
+ * @brief The counters of a thread, trivial so they need no thread local initialization
+ */
+struct Counters {
+    uint64_t allocations;
+    uint64_t deallocations;
+    uint64_t allocatedBytes;
+    uint64_t freedBytes;
+    int64_t live;
+    int64_t peak;
+    uint32_t scopes;
+};
+
+thread_local Counters tCounters;
+
+std::atomic<bool> gWarned = false;
+
+}
+
+AllocationTracker::Scope::Scope()
+: mStart{tCounters.allocations, tCounters.deallocations, tCounters.allocatedBytes, tCounters.freedBytes, 0, false},
+  mStartLive(tCounters.live), mOuterPeak(tCounters.peak) {
+    tCounters.peak = tCounters.live;
+    tCounters.scopes++;
+}
+
+AllocationTracker::Scope::~Scope() {
+    tCounters.scopes--;
+    tCounters.peak = std::max(mOuterPeak, tCounters.peak);
+}
+
+AllocationStats AllocationTracker::Scope::stats() const {
+    return {
+        tCounters.allocations - mStart.allocations,
+        tCounters.deallocations - mStart.deallocations,
+        tCounters.allocatedBytes - mStart.allocatedBytes,
+        tCounters.freedBytes - mStart.freedBytes,
+        static_cast<uint64_t>(std::max<int64_t>(tCounters.peak - mStartLive, 0)),
+        available()
+    };
+}
+
+bool AllocationTracker::available() {
+#ifdef PIDGEON_PULSE_TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AllocationTracker::warnUnavailable() {
+    if ( !gWarned.exchange(true) ) {
+        std::fprintf(stderr, "PidgeonPulse: allocations are not tracked, the allocation assertions pass unchecked"
+                             " (build with PIDGEON_PULSE_TRACK_ALLOCATIONS)\n");
+    }
+}
+
+} // namespace PidgeonPulse
+
+#ifdef PIDGEON_PULSE_TRACK_ALLOCATIONS
+
+namespace {
+
+using PidgeonPulse::tCounters;
+
+/**
+ * @brief Get the size of a block as the allocator sees it, the requested size is not known when it is freed
+ */
+std::size_t usableSize(void* pointer) {
+#if defined(PIDGEON_PULSE_HAVE_MALLOC_USABLE_SIZE)
+    return malloc_usable_size(pointer);
+#else
+    return malloc_size(pointer);
+#endif
+}
+
+void recordAllocation(void* pointer) {
+    if ( tCounters.scopes == 0 ) [[likely]] {
+        return;
+    }
+    int64_t size = static_cast<int64_t>(usableSize(pointer));
+    tCounters.allocations++;
+    tCounters.allocatedBytes += size;
+    tCounters.live += size;
+    tCounters.peak = std::max(tCounters.peak, tCounters.live);
+}
+
+void recordDeallocation(void* pointer) {
+    if ( tCounters.scopes == 0 || pointer == nullptr ) [[likely]] {
+        return;
+    }
+    int64_t size = static_cast<int64_t>(usableSize(pointer));
+    tCounters.deallocations++;
+    tCounters.freedBytes += size;
+    tCounters.live -= size;
+}
+
+void* allocate(std::size_t size, std::size_t alignment) {
+    size = std::max<std::size_t>(size, 1);
+    while ( true ) {
+        void* pointer = nullptr;
+        if ( alignment <= alignof(std::max_align_t) ) {
+            pointer = std::malloc(size);
+        } else if ( posix_memalign(&pointer, alignment, size) != 0 ) {
+            pointer = nullptr;
+        }
+        if ( pointer != nullptr ) {
+            recordAllocation(pointer);
+            return pointer;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if ( handler == nullptr ) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void deallocate(void* pointer) noexcept {
+    recordDeallocation(pointer);
+    std::free(pointer);
+}
+
+}
+
+// the array and nothrow forms forward to these
+void* operator new(std::size_t size) {
+    return allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    deallocate(pointer);
+}
+
+#endif
@@ -0,0 +1,110 @@
+#include "AsyncTest.hpp"
+#include "Watchdog.hpp"
+
+#include <unistd.h>
+
+namespace PidgeonPulse {
+
+namespace {
+
+/**
+ * @brief Get the timer thread of this process
+ *
+ * A forked process does not inherit the thread, so it starts its own.
+ * The watchdog is never destroyed, timers may still be armed at exit.
+ */
+Watchdog& timers() {
+    static std::mutex mutex;
+    static Watchdog* watchdog = nullptr;
+    static pid_t owner = 0;
+
+    std::lock_guard lock(mutex);
+    if ( owner != getpid() ) {
+        watchdog = new Watchdog(std::chrono::milliseconds(1));
+        owner = getpid();
+    }
+    return *watchdog;
+}
+
+}
+
+AsyncContext::AsyncContext(Scheduler& scheduler, VirtualClock& clock, std::function<void()> finished)
+: mScheduler(&scheduler), mClock(&clock), mFinished(std::move(finished)) {}
+
+void AsyncContext::resume(std::coroutine_handle<> handle) {
+    if ( mScheduler ) {
+        mScheduler->schedule([handle, clock = mClock]() {
+            VirtualClock::Scope clockScope(*clock);
+            handle.resume();
+        });
+        return;
+    }
+    // notified under the lock, the context is gone once drain() returned
+    std::lock_guard lock(mMutex);
+    mReady.push_back(handle);
+    mCondition.notify_one();
+}
+
+void AsyncContext::resume_after(Clock::duration delay, std::coroutine_handle<> handle) {
+    timers().arm(delay, [this, handle]() { resume(handle); });
+}
+
+void AsyncContext::finish() {
+    if ( mScheduler ) {
+        mFinished();
+        return;
+    }
+    std::lock_guard lock(mMutex);
+    mDone = true;
+    mCondition.notify_all();
+}
+
+void AsyncContext::drain() {
+    std::unique_lock lock(mMutex);
+    while ( true ) {
+        mCondition.wait(lock, [this]() { return mDone || !mReady.empty(); });
+        if ( mReady.empty() ) {
+            return;
+        }
+        std::coroutine_handle<> handle = mReady.front();
+        mReady.pop_front();
+        lock.unlock();
+        handle.resume();
+        lock.lock();
+    }
+}
+
+AsyncTest::AsyncTest(std::string name): Testable(std::move(name)) {}
+
+void AsyncTest::run() {
+    AsyncContext context;
+    Task<> task = run_async();
+    task.start(context);
+    context.drain();
+    if ( task.exception() ) {
+        std::rethrow_exception(task.exception());
+    }
+}
+
+void AsyncTest::start(std::stop_token stopToken, Scheduler& scheduler, std::function<void()> finished) {
+    // the setup and the first part of the body run on the calling worker
+    VirtualClock::Scope clockScope(get_clock());
+    mPhase = RunPhase();
+    mPhase.threadBound = false;
+    if ( !begin_run(std::move(stopToken), mPhase) ) {
+        finished();
+        return;
+    }
+
+    mContext = std::make_unique<AsyncContext>(scheduler, get_clock(), [this, finished = std::move(finished)]() {
+        std::exception_ptr exception = mTask->exception();
+        // the frame is suspended for the last time, nothing touches it after this
+        mTask.reset();
+        end_run(mPhase, exception, {}, {});
+        finished();
+    });
+    mTask.emplace(run_async());
+    mTask->start(*mContext);
+}
+
+} // namespace PidgeonPulse
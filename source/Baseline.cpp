@@ -0,0 +1,183 @@
+#include "Baseline.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+namespace PidgeonPulse {
+
+namespace {
+
+constexpr char MAGIC[4] = {'P', 'P', 'B', 'L'};
+constexpr uint32_t VERSION = 1;
+
+template<typename T>
+double median(std::vector<T> samples) {
+    auto middle = samples.begin() + samples.size() / 2;
+    std::nth_element(samples.begin(), middle, samples.end());
+    double upper = *middle;
+    if ( samples.size() % 2 == 1 ) {
+        return upper;
+    }
+    double lower = *std::max_element(samples.begin(), middle);
+    return (lower + upper) / 2;
+}
+
+}
+
+bool Baseline::load(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if ( file == nullptr ) {
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    uint64_t count = 0;
+    bool valid = std::fread(magic, sizeof(magic), 1, file) == 1
+        && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0
+        && std::fread(&version, sizeof(version), 1, file) == 1
+        && version == VERSION
+        && std::fread(&count, sizeof(count), 1, file) == 1;
+
+    std::unordered_map<uint64_t, std::vector<float>> samples;
+    for ( uint64_t index = 0; valid && index < count; index++ ) {
+        uint64_t key = 0;
+        uint32_t size = 0;
+        valid = std::fread(&key, sizeof(key), 1, file) == 1
+            && std::fread(&size, sizeof(size), 1, file) == 1;
+        if ( valid ) {
+            auto& entry = samples[key];
+            entry.resize(size);
+            valid = std::fread(entry.data(), sizeof(float), size, file) == size;
+        }
+    }
+    std::fclose(file);
+
+    if ( !valid ) {
+        return false;
+    }
+
+    for ( auto& [key, entry] : samples ) {
+        mSamples[key] = std::move(entry);
+    }
+    return true;
+}
+
+bool Baseline::save(const std::string& path) const {
+    std::string temporaryPath = path + ".tmp";
+    std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+    if ( file == nullptr ) {
+        return false;
+    }
+
+    uint64_t count = mSamples.size();
+    bool written = std::fwrite(MAGIC, sizeof(MAGIC), 1, file) == 1
+        && std::fwrite(&VERSION, sizeof(VERSION), 1, file) == 1
+        && std::fwrite(&count, sizeof(count), 1, file) == 1;
+    for ( auto& [key, samples] : mSamples ) {
+        uint32_t size = static_cast<uint32_t>(samples.size());
+        written = written
+            && std::fwrite(&key, sizeof(key), 1, file) == 1
+            && std::fwrite(&size, sizeof(size), 1, file) == 1
+            && std::fwrite(samples.data(), sizeof(float), size, file) == size;
+    }
+    written = std::fclose(file) == 0 && written;
+
+    if ( !written || std::rename(temporaryPath.c_str(), path.c_str()) != 0 ) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+void Baseline::replace(uint64_t key, const std::vector<double>& samples) {
+    auto& entry = mSamples[key];
+    entry.assign(samples.begin(), samples.end());
+}
+
+void Baseline::append(uint64_t key, double sample) {
+    auto& entry = mSamples[key];
+    if ( entry.size() >= WINDOW ) {
+        entry.erase(entry.begin(), entry.end() - (WINDOW - 1));
+    }
+    entry.push_back(static_cast<float>(sample));
+}
+
+const std::vector<float>* Baseline::lookup(uint64_t key) const {
+    auto entry = mSamples.find(key);
+    if ( entry == mSamples.end() ) {
+        return nullptr;
+    }
+    return &entry->second;
+}
+
+double Baseline::slowerPValue(const std::vector<float>& baseline, const std::vector<double>& current) {
+    double n1 = static_cast<double>(baseline.size());
+    double n2 = static_cast<double>(current.size());
+    if ( baseline.empty() || current.empty() ) {
+        return 1.0;
+    }
+
+    if ( current.size() == 1 ) {
+        // the rank of the sample among the baseline, ties count half
+        float value = static_cast<float>(current.front());
+        double notBelow = 0;
+        for ( float sample : baseline ) {
+            if ( sample > value ) notBelow += 1;
+            else if ( sample == value ) notBelow += 0.5;
+        }
+        return (notBelow + 1) / (n1 + 1);
+    }
+
+    // rank the pooled samples, tied samples share their average rank
+    std::vector<std::pair<double, bool>> pooled;
+    pooled.reserve(baseline.size() + current.size());
+    for ( float sample : baseline ) pooled.emplace_back(sample, false);
+    for ( double sample : current ) pooled.emplace_back(static_cast<float>(sample), true);
+    std::sort(pooled.begin(), pooled.end());
+
+    double currentRanks = 0;
+    double ties = 0;
+    for ( size_t start = 0; start < pooled.size(); ) {
+        size_t end = start;
+        while ( end < pooled.size() && pooled[end].first == pooled[start].first ) end++;
+        double rank = (start + 1 + end) / 2.0;
+        double tied = static_cast<double>(end - start);
+        ties += tied * tied * tied - tied;
+        for ( size_t index = start; index < end; index++ ) {
+            if ( pooled[index].second ) currentRanks += rank;
+        }
+        start = end;
+    }
+
+    double n = n1 + n2;
+    double u = currentRanks - n2 * (n2 + 1) / 2;
+    double mean = n1 * n2 / 2;
+    double variance = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)));
+    if ( variance <= 0 ) {
+        return 1.0;
+    }
+    // continuity correction towards the mean
+    double z = (u - mean - 0.5) / std::sqrt(variance);
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+BaselineComparison Baseline::compare(const std::vector<float>& baseline, const std::vector<double>& current,
+                                     double tolerance, double noiseFloor) {
+    BaselineComparison comparison;
+    if ( baseline.empty() || current.empty() ) {
+        return comparison;
+    }
+    comparison.baseline = median(baseline);
+    comparison.current = median(current);
+    comparison.pValue = slowerPValue(baseline, current);
+    comparison.regressed = comparison.delta() > tolerance
+        && comparison.current - comparison.baseline > noiseFloor
+        && comparison.pValue < SIGNIFICANCE;
+    return comparison;
+}
+
+} // namespace PidgeonPulse
@@ -0,0 +1,91 @@
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace PidgeonPulse {
+
+using Clock = std::chrono::steady_clock;
+
+Benchmark::Benchmark(std::string name, BenchmarkOptions options)
+: Testable(name), mOptions(options) {
+    if(mOptions.samples == 0) {
+        mOptions.samples = 1;
+    }
+}
+
+void Benchmark::iterations(uint64_t count) {
+    for(uint64_t i = 0; i < count; i++) {
+        iteration();
+    }
+}
+
+std::chrono::nanoseconds Benchmark::measure(uint64_t count) {
+    auto start = Clock::now();
+    iterations(count);
+    clobber();
+    return Clock::now() - start;
+}
+
+uint64_t Benchmark::calibrate() {
+    uint64_t count = 1;
+    while(true) {
+        auto elapsed = measure(count);
+        if(elapsed >= mOptions.sample_time || count >= mOptions.max_iterations) {
+            return count;
+        }
+
+        // grow towards the target sample time, but at least double and at most
+        // multiply by ten to stay robust against a noisy first measurement
+        double factor = 10;
+        if(elapsed.count() > 0) {
+            factor = 1.2 * mOptions.sample_time.count() / elapsed.count();
+        }
+        factor = std::clamp(factor, 2.0, 10.0);
+        count = std::min<uint64_t>(static_cast<uint64_t>(count * factor), mOptions.max_iterations);
+    }
+}
+
+void Benchmark::run() {
+    auto warmupEnd = Clock::now() + mOptions.warmup_time;
+    do {
+        iterations(1);
+    } while(Clock::now() < warmupEnd);
+
+    mStats = {};
+    mStats.iterations = calibrate();
+    mStats.samples.reserve(mOptions.samples);
+
+    for(uint32_t i = 0; i < mOptions.samples; i++) {
+        auto elapsed = measure(mStats.iterations);
+        mStats.samples.push_back(static_cast<double>(elapsed.count()) / mStats.iterations);
+    }
+
+    std::vector<double> sorted = mStats.samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    size_t count = sorted.size();
+    mStats.min = sorted.front();
+    mStats.median = count % 2 == 1
+        ? sorted[count / 2]
+        : (sorted[count / 2 - 1] + sorted[count / 2]) / 2;
+    mStats.p99 = sorted[std::min(count - 1, static_cast<size_t>(std::ceil(0.99 * count)) - 1)];
+
+    double sum = 0;
+    for(double sample : sorted) {
+        sum += sample;
+    }
+    mStats.mean = sum / count;
+
+    double variance = 0;
+    for(double sample : sorted) {
+        variance += (sample - mStats.mean) * (sample - mStats.mean);
+    }
+    mStats.stddev = count > 1 ? std::sqrt(variance / (count - 1)) : 0;
+}
+
+const BenchmarkStats& Benchmark::get_stats() const {
+    return mStats;
+}
+
+} // namespace PidgeonPulse
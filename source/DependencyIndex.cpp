@@ -0,0 +1,125 @@
+#include "DependencyIndex.hpp"
+
+#include <cstdio>
+
+namespace PidgeonPulse {
+
+std::string DependencyIndex::key(std::string_view collection, std::string_view test) {
+    std::string key;
+    key.reserve(collection.size() + test.size() + 1);
+    key.append(collection).append(1, '\t').append(test);
+    return key;
+}
+
+std::string_view DependencyIndex::normalize(std::string_view path) {
+    while ( path.starts_with("./") ) {
+        path.remove_prefix(2);
+    }
+    return path;
+}
+
+bool DependencyIndex::load(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "r");
+    if ( file == nullptr ) {
+        return false;
+    }
+
+    std::string line;
+    char buffer[4096];
+    while ( std::fgets(buffer, sizeof(buffer), file) != nullptr ) {
+        line += buffer;
+        if ( line.back() != '\n' && !std::feof(file) ) {
+            continue;
+        }
+        if ( line.back() == '\n' ) {
+            line.pop_back();
+        }
+
+        std::string_view rest = line;
+        size_t collectionEnd = rest.find('\t');
+        if ( collectionEnd != std::string_view::npos ) {
+            std::string_view collection = rest.substr(0, collectionEnd);
+            rest.remove_prefix(collectionEnd + 1);
+            size_t testEnd = rest.find('\t');
+            std::string_view test = rest.substr(0, testEnd);
+
+            std::vector<std::string> files;
+            while ( testEnd != std::string_view::npos ) {
+                rest.remove_prefix(testEnd + 1);
+                testEnd = rest.find('\t');
+                if ( std::string_view file = normalize(rest.substr(0, testEnd)); !file.empty() ) {
+                    files.emplace_back(file);
+                }
+            }
+            mDependencies[key(collection, test)] = std::move(files);
+        }
+        line.clear();
+    }
+    std::fclose(file);
+    return true;
+}
+
+bool DependencyIndex::save(const std::string& path) const {
+    std::string temporaryPath = path + ".tmp";
+    std::FILE* file = std::fopen(temporaryPath.c_str(), "w");
+    if ( file == nullptr ) {
+        return false;
+    }
+
+    bool written = true;
+    for ( auto& [testKey, files] : mDependencies ) {
+        written = written && std::fputs(testKey.c_str(), file) >= 0;
+        for ( auto& dependency : files ) {
+            written = written && std::fputc('\t', file) != EOF && std::fputs(dependency.c_str(), file) >= 0;
+        }
+        written = written && std::fputc('\n', file) != EOF;
+    }
+    written = std::fclose(file) == 0 && written;
+
+    if ( !written || std::rename(temporaryPath.c_str(), path.c_str()) != 0 ) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+void DependencyIndex::record(std::string_view collection, std::string_view test, std::vector<std::string> files) {
+    for ( auto& file : files ) {
+        if ( std::string_view normalized = normalize(file); normalized.size() != file.size() ) {
+            file = std::string(normalized);
+        }
+    }
+    mDependencies[key(collection, test)] = std::move(files);
+}
+
+const std::vector<std::string>* DependencyIndex::lookup(std::string_view collection, std::string_view test) const {
+    auto entry = mDependencies.find(key(collection, test));
+    if ( entry == mDependencies.end() ) {
+        return nullptr;
+    }
+    return &entry->second;
+}
+
+bool DependencyIndex::affected(std::string_view collection, std::string_view test, const std::unordered_set<std::string>& changedFiles) const {
+    const std::vector<std::string>* files = lookup(collection, test);
+    if ( files == nullptr ) {
+        return true;
+    }
+
+    for ( auto& dependency : *files ) {
+        if ( !dependency.ends_with('/') ) {
+            if ( changedFiles.contains(dependency) ) {
+                return true;
+            }
+            continue;
+        }
+        for ( auto& changed : changedFiles ) {
+            if ( changed.starts_with(dependency) ) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+} // namespace PidgeonPulse
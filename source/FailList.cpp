@@ -0,0 +1,221 @@
+#include "FailList.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace PidgeonPulse {
+
+namespace {
+
+constexpr size_t ARENA_BLOCK_SIZE = 64 * 1024;
+
+/**
+ * @brief Links an arena block to the ones allocated before it
+ */
+struct BlockHeader {
+    BlockHeader* next;
+};
+
+constexpr size_t BLOCK_HEADER_SIZE = alignof(std::max_align_t);
+static_assert(sizeof(BlockHeader) <= BLOCK_HEADER_SIZE);
+
+// keeps the arena blocks of all threads reachable until the end of the program
+std::atomic<BlockHeader*> gArenaBlocks = nullptr;
+
+/**
+ * @brief Allocate an arena block
+ *
+ * The blocks come from malloc, the allocation tracker only sees operator new,
+ * so the first failure on a thread is not counted against its test.
+ *
+ * @return std::byte* the usable memory of the block
+ */
+std::byte* allocateArenaBlock() {
+    void* memory = std::malloc(BLOCK_HEADER_SIZE + ARENA_BLOCK_SIZE);
+    if ( memory == nullptr ) {
+        throw std::bad_alloc();
+    }
+    auto* header = new (memory) BlockHeader{gArenaBlocks.load(std::memory_order_relaxed)};
+    while ( !gArenaBlocks.compare_exchange_weak(header->next, header, std::memory_order_release, std::memory_order_relaxed) ) {
+    }
+    return static_cast<std::byte*>(memory) + BLOCK_HEADER_SIZE;
+}
+
+/**
+ * @brief The bump allocator of a worker thread
+ */
+struct Arena {
+    std::byte* current = nullptr;
+    size_t remaining = 0;
+
+    void* allocate(size_t size, size_t alignment) {
+        size_t padding = (alignment - reinterpret_cast<uintptr_t>(current) % alignment) % alignment;
+        if ( current == nullptr || padding + size > remaining ) {
+            current = allocateArenaBlock();
+            remaining = ARENA_BLOCK_SIZE;
+            padding = 0;
+        }
+        void* memory = current + padding;
+        current += padding + size;
+        remaining -= padding + size;
+        return memory;
+    }
+};
+
+thread_local Arena tArena;
+
+}
+
+thread_local FailList::Chunk* FailList::tFreeChunks = nullptr;
+thread_local FailList::TextBlock* FailList::tFreeTextBlocks = nullptr;
+
+FailList::Chunk* FailList::allocateChunk() {
+    static_assert(sizeof(Chunk) <= ARENA_BLOCK_SIZE);
+    if ( tFreeChunks != nullptr ) {
+        Chunk* chunk = tFreeChunks;
+        tFreeChunks = chunk->next;
+        chunk->next = nullptr;
+        return chunk;
+    }
+    return new (tArena.allocate(sizeof(Chunk), alignof(Chunk))) Chunk();
+}
+
+FailList::TextBlock* FailList::allocateTextBlock() {
+    static_assert(sizeof(TextBlock) <= ARENA_BLOCK_SIZE);
+    if ( tFreeTextBlocks != nullptr ) {
+        TextBlock* block = tFreeTextBlocks;
+        tFreeTextBlocks = block->next;
+        block->next = nullptr;
+        return block;
+    }
+    return new (tArena.allocate(sizeof(TextBlock), alignof(TextBlock))) TextBlock();
+}
+
+const char* FailList::storeText(std::string_view text) {
+    static_assert(MAX_TEXT_SIZE < TextBlock::CAPACITY);
+    constexpr std::string_view ellipsis = "...";
+    bool truncated = text.size() > MAX_TEXT_SIZE;
+    if ( truncated ) {
+        text = text.substr(0, MAX_TEXT_SIZE - ellipsis.size());
+    }
+
+    size_t size = text.size() + (truncated ? ellipsis.size() : 0);
+    if ( mTextTail == nullptr || mTextTail->used + size + 1 > TextBlock::CAPACITY ) {
+        // reuse the blocks of earlier runs before taking new ones
+        TextBlock* next = mTextTail != nullptr ? mTextTail->next : mTextHead;
+        if ( next == nullptr ) {
+            next = allocateTextBlock();
+            if ( mTextTail != nullptr ) {
+                mTextTail->next = next;
+            } else {
+                mTextHead = next;
+            }
+        }
+        next->used = 0;
+        mTextTail = next;
+    }
+    char* copy = mTextTail->text.data() + mTextTail->used;
+    mTextTail->used += size + 1;
+    std::memcpy(copy, text.data(), text.size());
+    if ( truncated ) {
+        std::memcpy(copy + text.size(), ellipsis.data(), ellipsis.size());
+    }
+    copy[size] = '\0';
+    return copy;
+}
+
+FailList::~FailList() {
+    // the exceptions are released, the chunks and text blocks go to the free lists of this thread
+    Chunk* chunk = mHead;
+    while ( chunk != nullptr ) {
+        Chunk* next = chunk->next;
+        chunk->items = {};
+        chunk->next = tFreeChunks;
+        tFreeChunks = chunk;
+        chunk = next;
+    }
+
+    TextBlock* block = mTextHead;
+    while ( block != nullptr ) {
+        TextBlock* next = block->next;
+        block->used = 0;
+        block->next = tFreeTextBlocks;
+        tFreeTextBlocks = block;
+        block = next;
+    }
+}
+
+void FailList::push(const FailInfo& failInfo) {
+    if ( mSize >= MAX_RECORDED ) {
+        mDropped++;
+        return;
+    }
+
+    if ( mSize < INLINE_CAPACITY ) {
+        mInline[mSize++] = failInfo;
+        return;
+    }
+
+    size_t slot = (mSize - INLINE_CAPACITY) % CHUNK_CAPACITY;
+    if ( slot == 0 ) {
+        Chunk* next = mTail != nullptr ? mTail->next : mHead;
+        if ( next == nullptr ) {
+            next = allocateChunk();
+            if ( mTail != nullptr ) {
+                mTail->next = next;
+            } else {
+                mHead = next;
+            }
+        }
+        mTail = next;
+    }
+
+    mTail->items[slot] = failInfo;
+    mSize++;
+}
+
+void FailList::clear() {
+    size_t index = 0;
+    for ( ; index < mSize && index < INLINE_CAPACITY; index++ ) {
+        mInline[index] = {};
+    }
+    for ( Chunk* chunk = mHead; chunk != nullptr && index < mSize; chunk = chunk->next ) {
+        for ( size_t slot = 0; slot < CHUNK_CAPACITY && index < mSize; slot++, index++ ) {
+            chunk->items[slot] = {};
+        }
+    }
+
+    mTail = nullptr;
+    mTextTail = nullptr;
+    mSize = 0;
+    mDropped = 0;
+}
+
+void FailList::swap(FailList& other) noexcept {
+    // the texts live in the blocks, so the failures stay valid in their new list
+    std::swap(mInline, other.mInline);
+    std::swap(mHead, other.mHead);
+    std::swap(mTail, other.mTail);
+    std::swap(mSize, other.mSize);
+    std::swap(mDropped, other.mDropped);
+    std::swap(mTextHead, other.mTextHead);
+    std::swap(mTextTail, other.mTextTail);
+}
+
+const FailInfo& FailList::operator[](size_t index) const {
+    if ( index < INLINE_CAPACITY ) {
+        return mInline[index];
+    }
+    index -= INLINE_CAPACITY;
+    const Chunk* chunk = mHead;
+    for ( size_t i = 0; i < index / CHUNK_CAPACITY; i++ ) {
+        chunk = chunk->next;
+    }
+    return chunk->items[index % CHUNK_CAPACITY];
+}
+
+} // namespace PidgeonPulse
@@ -0,0 +1,15 @@
+#include "Fixture.hpp"
+
+namespace PidgeonPulse {
+
+void FixtureBase::retain() {
+    mUsers++;
+}
+
+void FixtureBase::release() {
+    if ( mUsers.fetch_sub(1) == 1 ) {
+        destroy();
+    }
+}
+
+} // namespace PidgeonPulse
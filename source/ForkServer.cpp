@@ -0,0 +1,499 @@
+#include "ForkServer.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <unordered_set>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace PidgeonPulse {
+
+namespace {
+
+constexpr uint32_t NO_STRING = UINT32_MAX;
+
+bool readFully(int fd, void* data, size_t size) {
+    char* bytes = static_cast<char*>(data);
+    while ( size > 0 ) {
+        ssize_t count = read(fd, bytes, size);
+        if ( count < 0 && errno == EINTR ) continue;
+        if ( count <= 0 ) return false;
+        bytes += count;
+        size -= count;
+    }
+    return true;
+}
+
+bool writeFully(int fd, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while ( size > 0 ) {
+        ssize_t count = write(fd, bytes, size);
+        if ( count < 0 && errno == EINTR ) continue;
+        if ( count <= 0 ) return false;
+        bytes += count;
+        size -= count;
+    }
+    return true;
+}
+
+/**
+ * @brief Let crashes kill a worker process with the default action
+ *
+ * A forked worker inherits the handlers of the host, e.g. the ones of a
+ * test framework, which would report the crash from inside the worker.
+ */
+void restoreCrashSignals() {
+    constexpr int SIGNALS[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+    sigset_t mask;
+    sigemptyset(&mask);
+    for ( int signal : SIGNALS ) {
+        std::signal(signal, SIG_DFL);
+        sigaddset(&mask, signal);
+    }
+    sigprocmask(SIG_UNBLOCK, &mask, nullptr);
+}
+
+template<typename T>
+void put(std::vector<char>& message, T value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    message.insert(message.end(), bytes, bytes + sizeof(T));
+}
+
+void putString(std::vector<char>& message, const char* value, size_t size) {
+    if ( value == nullptr ) {
+        put<uint32_t>(message, NO_STRING);
+        return;
+    }
+    put<uint32_t>(message, static_cast<uint32_t>(size));
+    message.insert(message.end(), value, value + size);
+}
+
+/**
+ * @brief Reads values from a received message, stops at the end of the message
+ */
+class MessageReader {
+    const char* mData;
+    size_t mSize;
+    size_t mOffset = 0;
+
+public:
+    MessageReader(const char* data, size_t size): mData(data), mSize(size) {}
+
+    template<typename T>
+    T get() {
+        T value{};
+        if ( mOffset + sizeof(T) <= mSize ) {
+            std::memcpy(&value, mData + mOffset, sizeof(T));
+        }
+        mOffset += sizeof(T);
+        return value;
+    }
+
+    bool getString(std::string& value) {
+        uint32_t size = get<uint32_t>();
+        if ( size == NO_STRING || mOffset + size > mSize ) {
+            return false;
+        }
+        value.assign(mData + mOffset, size);
+        mOffset += size;
+        return true;
+    }
+};
+
+} // namespace
+
+ForkServer::ForkServer(const std::vector<Testable*>& tests, std::function<void(size_t)> onFinished,
+                       std::stop_token stopToken)
+: mTests(tests), mOnFinished(std::move(onFinished)), mStopToken(std::move(stopToken)) {}
+
+ForkServer::~ForkServer() {
+    for ( auto& worker : mWorkers ) {
+        reapWorker(worker);
+    }
+}
+
+const char* ForkServer::intern(const std::string& value) {
+    static std::unordered_set<std::string> strings;
+    return strings.insert(value).first->c_str();
+}
+
+void ForkServer::spawnWorker(size_t index) {
+    int commandPipe[2];
+    int resultPipe[2];
+    if ( pipe(commandPipe) != 0 ) {
+        throw std::runtime_error("ForkServer: could not create pipe");
+    }
+    if ( pipe(resultPipe) != 0 ) {
+        close(commandPipe[0]);
+        close(commandPipe[1]);
+        throw std::runtime_error("ForkServer: could not create pipe");
+    }
+
+    std::fflush(nullptr);
+    pid_t pid = fork();
+    if ( pid < 0 ) {
+        throw std::runtime_error("ForkServer: could not fork worker");
+    }
+
+    if ( pid == 0 ) {
+        close(commandPipe[1]);
+        close(resultPipe[0]);
+        for ( auto& worker : mWorkers ) {
+            if ( worker.commandFd >= 0 ) close(worker.commandFd);
+            if ( worker.resultFd >= 0 ) close(worker.resultFd);
+        }
+        restoreCrashSignals();
+        workerLoop(commandPipe[0], resultPipe[1]);
+    }
+
+    close(commandPipe[0]);
+    close(resultPipe[1]);
+
+    Worker& worker = mWorkers[index];
+    worker.pid = pid;
+    worker.commandFd = commandPipe[1];
+    worker.resultFd = resultPipe[0];
+    worker.currentTest = -1;
+    worker.buffer.clear();
+    worker.hasDeadline = false;
+    worker.timedOut = false;
+}
+
+int ForkServer::reapWorker(Worker& worker) {
+    if ( worker.commandFd >= 0 ) close(worker.commandFd);
+    if ( worker.resultFd >= 0 ) close(worker.resultFd);
+    worker.commandFd = -1;
+    worker.resultFd = -1;
+
+    int status = 0;
+    if ( worker.pid > 0 ) {
+        while ( waitpid(worker.pid, &status, 0) < 0 && errno == EINTR ) {}
+    }
+    worker.pid = -1;
+    return status;
+}
+
+void ForkServer::workerLoop(int commandFd, int resultFd) {
+    std::vector<char> message;
+    uint32_t index;
+    while ( readFully(commandFd, &index, sizeof(index)) ) {
+        if ( index >= mTests.size() ) {
+            _exit(EXIT_FAILURE);
+        }
+        (*mTests[index])();
+        std::fflush(nullptr);
+
+        message.clear();
+        put<uint32_t>(message, 0);
+        serializeResult(index, message);
+        uint32_t size = static_cast<uint32_t>(message.size() - sizeof(uint32_t));
+        std::memcpy(message.data(), &size, sizeof(size));
+
+        if ( !writeFully(resultFd, message.data(), message.size()) ) {
+            _exit(EXIT_FAILURE);
+        }
+    }
+    // never run the static destructors of the forked copy of the parent
+    _exit(EXIT_SUCCESS);
+}
+
+void ForkServer::serializeResult(uint32_t index, std::vector<char>& message) const {
+    const Testable& test = *mTests[index];
+
+    put<uint32_t>(message, index);
+    put<uint8_t>(message, static_cast<uint8_t>(test.mState.load()));
+    put<int64_t>(message, test.mStartTime.time_since_epoch().count());
+    put<int64_t>(message, test.mEndTime.time_since_epoch().count());
+    // the steady clock is shared by all processes, so the phases line up with the parent
+    put<int64_t>(message, test.mMetrics.setupStart.time_since_epoch().count());
+    put<int64_t>(message, test.mMetrics.runStart.time_since_epoch().count());
+    put<int64_t>(message, test.mMetrics.runEnd.time_since_epoch().count());
+    put<int64_t>(message, test.mMetrics.teardownEnd.time_since_epoch().count());
+    put<int64_t>(message, test.mMetrics.cpuTime.count());
+    put<uint8_t>(message, test.mMetrics.cpuTimeMeasured);
+    put<AllocationStats>(message, test.mMetrics.allocations);
+    put<PerfStats>(message, test.mMetrics.counters);
+    put<uint64_t>(message, test.mFailInfos.dropped());
+    put<uint32_t>(message, static_cast<uint32_t>(test.mFailInfos.size()));
+
+    for ( auto& failInfo : test.mFailInfos ) {
+        put<int32_t>(message, failInfo.line);
+        putString(message, failInfo.file, failInfo.file ? std::strlen(failInfo.file) : 0);
+        putString(message, failInfo.expression, failInfo.expression ? std::strlen(failInfo.expression) : 0);
+        putString(message, failInfo.message, failInfo.message ? std::strlen(failInfo.message) : 0);
+        if ( !failInfo.exception ) {
+            putString(message, nullptr, 0);
+            continue;
+        }
+        try {
+            std::rethrow_exception(failInfo.exception);
+        } catch ( const std::exception& e ) {
+            putString(message, e.what(), std::strlen(e.what()));
+        } catch ( ... ) {
+            const char* unknown = "Unknown exception";
+            putString(message, unknown, std::strlen(unknown));
+        }
+    }
+}
+
+void ForkServer::applyResult(const char* message, size_t size) {
+    using TimePoint = std::chrono::time_point<std::chrono::high_resolution_clock>;
+
+    MessageReader reader(message, size);
+    uint32_t index = reader.get<uint32_t>();
+    if ( index >= mTests.size() ) {
+        return;
+    }
+    Testable& test = *mTests[index];
+
+    test.mState = static_cast<Testable::STATE>(reader.get<uint8_t>());
+    test.mStartTime = TimePoint(TimePoint::duration(reader.get<int64_t>()));
+    test.mEndTime = TimePoint(TimePoint::duration(reader.get<int64_t>()));
+    auto getPhase = [&reader]() {
+        return TestMetrics::Clock::time_point(TestMetrics::Clock::duration(reader.get<int64_t>()));
+    };
+    test.mMetrics.setupStart = getPhase();
+    test.mMetrics.runStart = getPhase();
+    test.mMetrics.runEnd = getPhase();
+    test.mMetrics.teardownEnd = getPhase();
+    test.mMetrics.cpuTime = std::chrono::nanoseconds(reader.get<int64_t>());
+    test.mMetrics.cpuTimeMeasured = reader.get<uint8_t>() != 0;
+    test.mMetrics.allocations = reader.get<AllocationStats>();
+    test.mMetrics.counters = reader.get<PerfStats>();
+
+    test.mFailInfos.clear();
+    test.mFailInfos.addDropped(reader.get<uint64_t>());
+    uint32_t failCount = reader.get<uint32_t>();
+    std::string text;
+    for ( uint32_t i = 0; i < failCount; i++ ) {
+        Testable::FailInfo failInfo{nullptr, reader.get<int32_t>(), nullptr};
+        if ( reader.getString(text) ) {
+            failInfo.file = intern(text);
+        }
+        if ( reader.getString(text) ) {
+            failInfo.expression = intern(text);
+        }
+        if ( reader.getString(text) ) {
+            failInfo.message = test.mFailInfos.storeText(text);
+        }
+        if ( reader.getString(text) ) {
+            failInfo.exception = std::make_exception_ptr(std::runtime_error(text));
+        }
+        test.mFailInfos.push(failInfo);
+    }
+}
+
+void ForkServer::failCrashedTest(uint32_t index, int status) {
+    Testable& test = *mTests[index];
+
+    std::string reason;
+    if ( WIFSIGNALED(status) ) {
+        int signal = WTERMSIG(status);
+        reason = "Worker process killed by signal " + std::to_string(signal) + " (" + strsignal(signal) + ")";
+    } else if ( WIFEXITED(status) ) {
+        reason = "Worker process exited with status " + std::to_string(WEXITSTATUS(status));
+    } else {
+        reason = "Worker process terminated";
+    }
+
+    test.mState = Testable::STATE::FAIL_WITH_EXCEPTION;
+    test.mStartTime = test.mEndTime = std::chrono::high_resolution_clock::now();
+    auto now = TestMetrics::Clock::now();
+    test.mMetrics.setupStart = test.mMetrics.runStart = test.mMetrics.runEnd = test.mMetrics.teardownEnd = now;
+    test.mMetrics.cpuTime = std::chrono::nanoseconds::zero();
+    test.mMetrics.cpuTimeMeasured = false;
+    test.mMetrics.allocations = {};
+    test.mMetrics.counters = {};
+    test.mFailInfos.clear();
+    test.mFailInfos.push({nullptr, 0, std::make_exception_ptr(std::runtime_error(reason))});
+}
+
+void ForkServer::dispatch(Worker& worker) {
+    if ( mPendingTests.empty() ) {
+        return;
+    }
+
+    uint32_t index = mPendingTests.front();
+    mPendingTests.pop_front();
+
+    worker.currentTest = index;
+    worker.started = std::chrono::steady_clock::now();
+    mTests[index]->mMetrics.worker = static_cast<size_t>(&worker - mWorkers.data());
+    worker.hasDeadline = index < mTimeouts.size() && mTimeouts[index].count() > 0;
+    if ( worker.hasDeadline ) {
+        worker.deadline = worker.started + mTimeouts[index];
+    }
+    mRunningTests++;
+    // a failed write means the worker died while idle, which is noticed as end of file when polling
+    writeFully(worker.commandFd, &index, sizeof(index));
+}
+
+int ForkServer::enforceDeadlines() {
+    using namespace std::chrono;
+
+    auto now = steady_clock::now();
+    std::optional<steady_clock::duration> next;
+    for ( auto& worker : mWorkers ) {
+        if ( worker.currentTest < 0 || !worker.hasDeadline || worker.timedOut ) {
+            continue;
+        }
+        if ( now < worker.deadline ) {
+            next = std::min(next.value_or(worker.deadline - now), worker.deadline - now);
+            continue;
+        }
+
+        std::fprintf(stderr, "PidgeonPulse: %s timed out after %lld ms, killing its worker process\n",
+                     mTests[worker.currentTest]->get_name().c_str(),
+                     static_cast<long long>(mTimeouts[worker.currentTest].count()));
+        for ( auto& other : mWorkers ) {
+            if ( &other != &worker && other.currentTest >= 0 && !other.timedOut ) {
+                std::fprintf(stderr, "  still running: %s (for %lld ms)\n",
+                             mTests[other.currentTest]->get_name().c_str(),
+                             static_cast<long long>(duration_cast<milliseconds>(now - other.started).count()));
+            }
+        }
+        kill(worker.pid, SIGKILL);
+        worker.timedOut = true;
+    }
+
+    if ( !next ) {
+        return -1;
+    }
+    return static_cast<int>(std::min<int64_t>(ceil<milliseconds>(*next).count(), INT32_MAX));
+}
+
+void ForkServer::skipPending() {
+    while ( !mPendingTests.empty() ) {
+        uint32_t index = mPendingTests.front();
+        mPendingTests.pop_front();
+        mTests[index]->mark_skipped();
+        if ( mOnFinished ) mOnFinished(index);
+    }
+}
+
+void ForkServer::receive(size_t slot) {
+    Worker& worker = mWorkers[slot];
+
+    char chunk[4096];
+    ssize_t count = read(worker.resultFd, chunk, sizeof(chunk));
+    if ( count < 0 && errno == EINTR ) {
+        return;
+    }
+
+    if ( count <= 0 ) {
+        int64_t crashedTest = worker.currentTest;
+        int status = reapWorker(worker);
+        if ( crashedTest >= 0 && worker.timedOut ) {
+            Testable& test = *mTests[crashedTest];
+            test.mFailInfos.clear();
+            test.mState = Testable::STATE::NOT_RUN;
+            test.mark_timed_out(mTimeouts[crashedTest]);
+        } else if ( crashedTest >= 0 ) {
+            failCrashedTest(static_cast<uint32_t>(crashedTest), status);
+        }
+        if ( crashedTest >= 0 ) {
+            mRunningTests--;
+            if ( mOnFinished ) mOnFinished(static_cast<size_t>(crashedTest));
+        }
+        spawnWorker(slot);
+        return;
+    }
+
+    worker.buffer.insert(worker.buffer.end(), chunk, chunk + count);
+
+    uint32_t size;
+    while ( worker.buffer.size() >= sizeof(size) ) {
+        std::memcpy(&size, worker.buffer.data(), sizeof(size));
+        if ( worker.buffer.size() < sizeof(size) + size ) {
+            break;
+        }
+        applyResult(worker.buffer.data() + sizeof(size), size);
+        worker.buffer.erase(worker.buffer.begin(), worker.buffer.begin() + sizeof(size) + size);
+
+        size_t finished = static_cast<size_t>(worker.currentTest);
+        worker.currentTest = -1;
+        mRunningTests--;
+        if ( mOnFinished ) mOnFinished(finished);
+    }
+}
+
+void ForkServer::setTimeouts(std::vector<std::chrono::milliseconds> timeouts) {
+    mTimeouts = std::move(timeouts);
+}
+
+void ForkServer::run(size_t workerCount) {
+    if ( workerCount == 0 ) {
+        workerCount = 1;
+    }
+    workerCount = std::min(workerCount, std::max<size_t>(mTests.size(), 1));
+
+    auto queued = TestMetrics::Clock::now();
+    for ( uint32_t i = 0; i < mTests.size(); i++ ) {
+        mPendingTests.push_back(i);
+        mTests[i]->mMetrics.queued = queued;
+    }
+
+    struct sigaction ignore{};
+    struct sigaction previous{};
+    ignore.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &ignore, &previous);
+
+    try {
+        mWorkers.resize(workerCount);
+        for ( size_t i = 0; i < workerCount; i++ ) {
+            spawnWorker(i);
+        }
+
+        std::vector<pollfd> pollFds;
+        std::vector<size_t> pollSlots;
+        while ( !mPendingTests.empty() || mRunningTests > 0 ) {
+            if ( mStopToken.stop_requested() ) {
+                skipPending();
+                if ( mRunningTests == 0 ) {
+                    break;
+                }
+            }
+            for ( auto& worker : mWorkers ) {
+                // a killed worker gets its next test once it was respawned
+                if ( worker.currentTest < 0 && !worker.timedOut ) {
+                    dispatch(worker);
+                }
+            }
+
+            pollFds.clear();
+            pollSlots.clear();
+            for ( size_t i = 0; i < mWorkers.size(); i++ ) {
+                if ( mWorkers[i].currentTest >= 0 || mWorkers[i].timedOut ) {
+                    pollFds.push_back({mWorkers[i].resultFd, POLLIN, 0});
+                    pollSlots.push_back(i);
+                }
+            }
+
+            if ( poll(pollFds.data(), pollFds.size(), enforceDeadlines()) < 0 ) {
+                if ( errno == EINTR ) continue;
+                throw std::runtime_error("ForkServer: could not poll workers");
+            }
+
+            for ( size_t i = 0; i < pollFds.size(); i++ ) {
+                if ( pollFds[i].revents != 0 ) {
+                    receive(pollSlots[i]);
+                }
+            }
+        }
+    } catch ( ... ) {
+        sigaction(SIGPIPE, &previous, nullptr);
+        throw;
+    }
+
+    for ( auto& worker : mWorkers ) {
+        reapWorker(worker);
+    }
+    sigaction(SIGPIPE, &previous, nullptr);
+}
+
+} // namespace PidgeonPulse
@@ -0,0 +1,122 @@
+#include "JUnitReporter.hpp"
+#include "TestCollection.hpp"
+
+namespace PidgeonPulse {
+
+JUnitReporter::JUnitReporter(std::unique_ptr<OutputSink> sink)
+: mOwnedSink(std::move(sink)), mSink(*mOwnedSink) {}
+
+JUnitReporter::JUnitReporter(OutputSink& sink): mSink(sink) {}
+
+void JUnitReporter::writeEscaped(std::string_view text) {
+    size_t start = 0;
+    for ( size_t i = 0; i < text.size(); i++ ) {
+        std::string_view replacement;
+        unsigned char character = static_cast<unsigned char>(text[i]);
+        switch ( character ) {
+        case '&': replacement = "&amp;"; break;
+        case '<': replacement = "&lt;"; break;
+        case '>': replacement = "&gt;"; break;
+        case '"': replacement = "&quot;"; break;
+        case '\'': replacement = "&apos;"; break;
+        case '\t':
+        case '\n':
+        case '\r':
+            continue;
+        default:
+            if ( character >= 0x20 ) continue;
+            // control characters are not allowed in XML 1.0, not even escaped
+            replacement = "?";
+        }
+        mSink.write(text.substr(start, i - start));
+        mSink.write(replacement);
+        start = i + 1;
+    }
+    mSink.write(text.substr(start));
+}
+
+void JUnitReporter::writeCounters(const PerfStats& counters) {
+    auto property = [this](const char* name, uint64_t value) {
+        mSink.write("        <property name=\"");
+        mSink.write(name);
+        mSink.write("\" value=\"");
+        mSink.writeNumber(value);
+        mSink.write("\"/>\n");
+    };
+    mSink.write("      <properties>\n");
+    property("cycles", counters.cycles);
+    property("instructions", counters.instructions);
+    property("cache_misses", counters.cacheMisses);
+    property("branch_misses", counters.branchMisses);
+    mSink.write("      </properties>\n");
+}
+
+void JUnitReporter::runStarting() {
+    mSink.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                "<testsuites name=\"PidgeonPulse\">\n"
+                "  <testsuite name=\"PidgeonPulse\">\n");
+}
+
+void JUnitReporter::testFinished(const TestCollection& collection, const Testable& test) {
+    mSink.write("    <testcase classname=\"");
+    writeEscaped(collection.getName());
+    mSink.write("\" name=\"");
+    writeEscaped(test.get_name());
+    mSink.write("\" time=\"");
+    mSink.writeNumber(test.get_duration().count(), 6);
+
+    const PerfStats& counters = test.get_metrics().counters;
+    if ( test.get_result() && !counters.measured ) {
+        mSink.write("\"/>\n");
+        return;
+    }
+    mSink.write("\">\n");
+    if ( counters.measured ) {
+        writeCounters(counters);
+    }
+    if ( test.get_result() ) {
+        mSink.write("    </testcase>\n");
+        return;
+    }
+    if ( test.was_skipped() ) {
+        mSink.write("      <skipped/>\n"
+                    "    </testcase>\n");
+        return;
+    }
+
+    const char* element = test.threw_exception() ? "error" : "failure";
+    for ( auto& failInfo : test.get_fail_infos() ) {
+        mSink.write("      <");
+        mSink.write(element);
+        mSink.write(" message=\"");
+        if ( failInfo.exception ) {
+            writeEscaped(exceptionMessage(failInfo.exception));
+        } else if ( failInfo.message ) {
+            writeEscaped(failInfo.message);
+        } else {
+            mSink.write("Test failed");
+        }
+        mSink.write("\">");
+        if ( failInfo.file ) {
+            writeEscaped(failInfo.file);
+            mSink.write(':');
+            mSink.writeNumber(static_cast<int64_t>(failInfo.line));
+        }
+        if ( failInfo.expression ) {
+            mSink.write(": ");
+            writeEscaped(failInfo.expression);
+        }
+        mSink.write("</");
+        mSink.write(element);
+        mSink.write(">\n");
+    }
+    mSink.write("    </testcase>\n");
+}
+
+void JUnitReporter::runFinished(const TestStats&) {
+    mSink.write("  </testsuite>\n"
+                "</testsuites>\n");
+    mSink.flush();
+}
+
+} // namespace PidgeonPulse
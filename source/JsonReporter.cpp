@@ -0,0 +1,157 @@
+#include "JsonReporter.hpp"
+#include "TestCollection.hpp"
+
+namespace PidgeonPulse {
+
+JsonReporter::JsonReporter(std::unique_ptr<OutputSink> sink)
+: mOwnedSink(std::move(sink)), mSink(*mOwnedSink) {}
+
+JsonReporter::JsonReporter(OutputSink& sink): mSink(sink) {}
+
+void JsonReporter::testFinished(const TestCollection& collection, const Testable& test) {
+    mSink.write("{\"type\":\"test\",\"collection\":");
+    mSink.writeJsonString(collection.getName());
+    mSink.write(",\"name\":");
+    mSink.writeJsonString(test.get_name());
+    mSink.write(",\"result\":");
+    if ( test.was_skipped() ) {
+        mSink.write("\"skipped\"");
+    } else {
+        mSink.write(test.get_result() ? "\"passed\"" : "\"failed\"");
+    }
+    mSink.write(",\"duration\":");
+    mSink.writeNumber(test.get_duration().count(), 9);
+    // metrics that were not measured are left out rather than reported as 0
+    if ( const AllocationStats& allocations = test.get_metrics().allocations; allocations.measured ) {
+        mSink.write(",\"allocations\":{\"count\":");
+        mSink.writeNumber(allocations.allocations);
+        mSink.write(",\"bytes\":");
+        mSink.writeNumber(allocations.allocatedBytes);
+        mSink.write(",\"peak_bytes\":");
+        mSink.writeNumber(allocations.peakBytes);
+        mSink.write(",\"leaked_bytes\":");
+        mSink.writeNumber(allocations.leakedBytes());
+        mSink.write('}');
+    }
+    if ( const PerfStats& counters = test.get_metrics().counters; counters.measured ) {
+        mSink.write(",\"counters\":{\"cycles\":");
+        mSink.writeNumber(counters.cycles);
+        mSink.write(",\"instructions\":");
+        mSink.writeNumber(counters.instructions);
+        mSink.write(",\"cache_misses\":");
+        mSink.writeNumber(counters.cacheMisses);
+        mSink.write(",\"branch_misses\":");
+        mSink.writeNumber(counters.branchMisses);
+        mSink.write(",\"ipc\":");
+        mSink.writeNumber(counters.ipc(), 3);
+        mSink.write('}');
+    }
+    mSink.write(",\"failures\":[");
+
+    bool first = true;
+    for ( auto& failInfo : test.get_fail_infos() ) {
+        if ( !first ) {
+            mSink.write(',');
+        }
+        first = false;
+
+        mSink.write("{\"file\":");
+        if ( failInfo.file ) {
+            mSink.writeJsonString(failInfo.file);
+        } else {
+            mSink.write("null");
+        }
+        mSink.write(",\"line\":");
+        mSink.writeNumber(static_cast<int64_t>(failInfo.line));
+        mSink.write(",\"exception\":");
+        if ( failInfo.exception ) {
+            mSink.writeJsonString(exceptionMessage(failInfo.exception));
+        } else {
+            mSink.write("null");
+        }
+        mSink.write(",\"expression\":");
+        if ( failInfo.expression ) {
+            mSink.writeJsonString(failInfo.expression);
+        } else {
+            mSink.write("null");
+        }
+        mSink.write(",\"message\":");
+        if ( failInfo.message ) {
+            mSink.writeJsonString(failInfo.message);
+        } else {
+            mSink.write("null");
+        }
+        mSink.write('}');
+    }
+    mSink.write("],\"dropped_failures\":");
+    mSink.writeNumber(test.get_fail_infos().dropped());
+    mSink.write("}\n");
+}
+
+void JsonReporter::baselineCompared(const TestCollection& collection, const Testable& test, const BaselineComparison& comparison) {
+    mSink.write("{\"type\":\"baseline\",\"collection\":");
+    mSink.writeJsonString(collection.getName());
+    mSink.write(",\"name\":");
+    mSink.writeJsonString(test.get_name());
+    mSink.write(",\"baseline\":");
+    mSink.writeNumber(comparison.baseline, 9);
+    mSink.write(",\"current\":");
+    mSink.writeNumber(comparison.current, 9);
+    mSink.write(",\"delta\":");
+    mSink.writeNumber(comparison.delta(), 4);
+    mSink.write(",\"p_value\":");
+    mSink.writeNumber(comparison.pValue, 4);
+    mSink.write(",\"regressed\":");
+    mSink.write(comparison.regressed ? "true" : "false");
+    mSink.write("}\n");
+}
+
+void JsonReporter::collectionFinished(const TestCollection& collection, const TestStats& stats) {
+    mSink.write("{\"type\":\"collection\",\"name\":");
+    mSink.writeJsonString(collection.getName());
+    mSink.write(",\"total\":");
+    mSink.writeNumber(static_cast<uint64_t>(stats.total));
+    mSink.write(",\"failed\":");
+    mSink.writeNumber(static_cast<uint64_t>(stats.failed));
+    mSink.write(",\"skipped\":");
+    mSink.writeNumber(static_cast<uint64_t>(stats.skipped));
+    mSink.write("}\n");
+}
+
+void JsonReporter::repeatFinished(const std::vector<RepeatStats>& results, size_t repetitions, uint64_t seed) {
+    for ( auto& result : results ) {
+        mSink.write("{\"type\":\"repeat\",\"collection\":");
+        mSink.writeJsonString(result.collection->getName());
+        mSink.write(",\"name\":");
+        mSink.writeJsonString(result.test->get_name());
+        mSink.write(",\"runs\":");
+        mSink.writeNumber(static_cast<uint64_t>(result.runs));
+        mSink.write(",\"failed\":");
+        mSink.writeNumber(static_cast<uint64_t>(result.failed));
+        mSink.write(",\"skipped\":");
+        mSink.writeNumber(static_cast<uint64_t>(result.skipped));
+        mSink.write(",\"pass_rate\":");
+        mSink.writeNumber(result.passRate(), 4);
+        mSink.write(",\"flaky\":");
+        mSink.write(result.isFlaky() ? "true" : "false");
+        mSink.write("}\n");
+    }
+    mSink.write("{\"type\":\"repetitions\",\"count\":");
+    mSink.writeNumber(static_cast<uint64_t>(repetitions));
+    mSink.write(",\"seed\":");
+    mSink.writeNumber(seed);
+    mSink.write("}\n");
+}
+
+void JsonReporter::runFinished(const TestStats& stats) {
+    mSink.write("{\"type\":\"run\",\"total\":");
+    mSink.writeNumber(static_cast<uint64_t>(stats.total));
+    mSink.write(",\"failed\":");
+    mSink.writeNumber(static_cast<uint64_t>(stats.failed));
+    mSink.write(",\"skipped\":");
+    mSink.writeNumber(static_cast<uint64_t>(stats.skipped));
+    mSink.write("}\n");
+    mSink.flush();
+}
+
+} // namespace PidgeonPulse
@@ -0,0 +1,110 @@
+#include "OutputSink.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+namespace PidgeonPulse {
+
+void OutputSink::write(std::string_view text) {
+    while ( !text.empty() ) {
+        if ( mUsed == mBuffer.size() ) {
+            flush();
+        }
+        size_t count = std::min(text.size(), mBuffer.size() - mUsed);
+        std::memcpy(mBuffer.data() + mUsed, text.data(), count);
+        mUsed += count;
+        text.remove_prefix(count);
+    }
+}
+
+void OutputSink::writeNumber(uint64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    write(std::string_view(digits, result.ptr - digits));
+}
+
+void OutputSink::writeNumber(int64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    write(std::string_view(digits, result.ptr - digits));
+}
+
+void OutputSink::writeNumber(double value, int precision) {
+    char digits[64];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::fixed, precision);
+    if ( result.ec != std::errc() ) {
+        write("nan");
+        return;
+    }
+    write(std::string_view(digits, result.ptr - digits));
+}
+
+void OutputSink::writeJsonString(std::string_view text) {
+    static constexpr char HEX[] = "0123456789abcdef";
+
+    write('"');
+    size_t start = 0;
+    for ( size_t i = 0; i < text.size(); i++ ) {
+        unsigned char character = static_cast<unsigned char>(text[i]);
+        if ( character >= 0x20 && character != '"' && character != '\\' ) {
+            continue;
+        }
+        write(text.substr(start, i - start));
+        start = i + 1;
+        switch ( character ) {
+        case '"': write("\\\""); break;
+        case '\\': write("\\\\"); break;
+        case '\n': write("\\n"); break;
+        case '\r': write("\\r"); break;
+        case '\t': write("\\t"); break;
+        default:
+            write("\\u00");
+            write(HEX[character >> 4]);
+            write(HEX[character & 0xF]);
+        }
+    }
+    write(text.substr(start));
+    write('"');
+}
+
+void OutputSink::flush() {
+    if ( mUsed > 0 ) {
+        writeOut(mBuffer.data(), mUsed);
+        mUsed = 0;
+    }
+}
+
+FileSink::FileSink(const std::string& path)
+: mFile(std::fopen(path.c_str(), "wb")), mOwnsFile(true) {
+    if ( mFile == nullptr ) {
+        throw std::runtime_error("Could not open report file: " + path);
+    }
+}
+
+FileSink::FileSink(std::FILE* file): mFile(file), mOwnsFile(false) {}
+
+FileSink::~FileSink() {
+    flush();
+    if ( mOwnsFile ) {
+        std::fclose(mFile);
+    } else {
+        std::fflush(mFile);
+    }
+}
+
+void FileSink::writeOut(const char* data, size_t size) {
+    std::fwrite(data, 1, size, mFile);
+    std::fflush(mFile);
+}
+
+void StringSink::writeOut(const char* data, size_t size) {
+    mString.append(data, size);
+}
+
+std::string StringSink::str() {
+    flush();
+    return mString;
+}
+
+} // namespace PidgeonPulse
@@ -0,0 +1,169 @@
+#include "PerfCounters.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace PidgeonPulse {
+
+namespace {
+
+std::atomic<bool> gEnabled = false;
+
+constexpr size_t EVENT_COUNT = 4;
+
+/**
+ * @brief A read of the counter group: the events, then the enabled and running times
+ */
+using Reading = uint64_t[EVENT_COUNT + 2];
+
+#ifdef __linux__
+
+std::atomic<bool> gWarned = false;
+
+constexpr uint64_t EVENTS[EVENT_COUNT] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+/**
+ * @brief The counter group of a thread
+ *
+ * A forked process inherits the descriptors, but they keep counting
+ * the thread of the parent, so the group is opened again after a fork.
+ */
+class ThreadCounters {
+private:
+    int mFds[EVENT_COUNT] = {-1, -1, -1, -1};
+    pid_t mOwner = 0;
+    bool mAvailable = false;
+
+    void close() {
+        for ( int& fd : mFds ) {
+            if ( fd >= 0 ) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+    }
+
+    bool open() {
+        for ( size_t i = 0; i < EVENT_COUNT; i++ ) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = EVENTS[i];
+            attr.disabled = i == 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            long fd = syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : mFds[0], PERF_FLAG_FD_CLOEXEC);
+            if ( fd < 0 ) {
+                int error = errno;
+                close();
+                if ( !gWarned.exchange(true) ) {
+                    std::fprintf(stderr, "PidgeonPulse: hardware performance counters are not available: %s%s\n",
+                                 std::strerror(error),
+                                 error == EACCES || error == EPERM ? " (see /proc/sys/kernel/perf_event_paranoid)" : "");
+                }
+                return false;
+            }
+            mFds[i] = static_cast<int>(fd);
+        }
+        return ioctl(mFds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == 0;
+    }
+
+public:
+    ~ThreadCounters() {
+        close();
+    }
+
+    bool read(Reading& reading) {
+        pid_t process = getpid();
+        if ( mOwner != process ) {
+            close();
+            mOwner = process;
+            mAvailable = open();
+        }
+        if ( !mAvailable ) {
+            return false;
+        }
+
+        // nr, time enabled, time running, then the value of every event
+        uint64_t data[EVENT_COUNT + 3];
+        if ( ::read(mFds[0], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[0] != EVENT_COUNT ) {
+            return false;
+        }
+        for ( size_t i = 0; i < EVENT_COUNT; i++ ) {
+            reading[i] = data[i + 3];
+        }
+        reading[EVENT_COUNT] = data[1];
+        reading[EVENT_COUNT + 1] = data[2];
+        return true;
+    }
+};
+
+thread_local ThreadCounters tCounters;
+
+bool readCounters(Reading& reading) {
+    return tCounters.read(reading);
+}
+
+#else
+
+bool readCounters(Reading&) {
+    return false;
+}
+
+#endif
+
+}
+
+PerfCounters::Scope::Scope(): mStart{}, mActive(false) {
+    if ( gEnabled.load(std::memory_order_relaxed) ) {
+        mActive = readCounters(mStart);
+    }
+}
+
+PerfStats PerfCounters::Scope::stats() const {
+    PerfStats stats;
+    Reading end;
+    if ( !mActive || !readCounters(end) ) {
+        return stats;
+    }
+
+    uint64_t enabled = end[EVENT_COUNT] - mStart[EVENT_COUNT];
+    uint64_t running = end[EVENT_COUNT + 1] - mStart[EVENT_COUNT + 1];
+    // the group only counted for part of the time if the kernel multiplexed it
+    double scale = running == 0 ? 0.0 : static_cast<double>(enabled) / running;
+    auto delta = [&](size_t event) {
+        return static_cast<uint64_t>(static_cast<double>(end[event] - mStart[event]) * scale);
+    };
+    stats.cycles = delta(0);
+    stats.instructions = delta(1);
+    stats.cacheMisses = delta(2);
+    stats.branchMisses = delta(3);
+    stats.measured = true;
+    return stats;
+}
+
+void PerfCounters::setEnabled(bool enabled) {
+    gEnabled = enabled;
+}
+
+bool PerfCounters::enabled() {
+    return gEnabled;
+}
+
+} // namespace PidgeonPulse
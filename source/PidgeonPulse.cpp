@@ -1,22 +1,366 @@
 #include "PidgeonPulse.hpp"
 #include "TestController.hpp"
+#include "TextReporter.hpp"
+#include "JUnitReporter.hpp"
+#include "JsonReporter.hpp"
+#include "TraceReporter.hpp"
 
-#include <fstream>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #ifdef PIDGEON_PULSE_CONFIG_MAIN
 
 using namespace PidgeonPulse;
 
+namespace {
+
+/**
+ * @brief The options of the test runner
+ */
+struct Options {
+    std::vector<std::string_view> reporters;
+    std::string_view trace;
+    // only written when asked for, a plain run leaves the working directory alone
+    std::string timingCache;
+    std::string dependencyIndex;
+    std::string_view changedFiles;
+    std::string pluginCache = ".pidgeonpulse.plugins";
+    bool plugins = false;
+    size_t shardIndex = 0;
+    size_t shardCount = 1;
+    bool shardByDuration = false;
+    size_t repeat = 0;
+    bool untilFail = false;
+    // the tests a baseline gates run after each other, with --update-baseline every test does
+    std::string baseline;
+    bool updateBaseline = false;
+    size_t baselineTolerance = 10;
+};
+
+/**
+ * @brief Parse a number option
+ *
+ * @tparam T the type of the number
+ * @param text the text of the number
+ * @param value the parsed number
+ * @return true the text is a number
+ * @return false the text is no number
+ */
+template<typename T>
+bool parseNumber(std::string_view text, T& value) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+/**
+ * @brief Parse the shard balancing mode
+ *
+ * @param text either "count" or "duration"
+ * @param byDuration whether the shards are balanced by duration
+ * @return true the mode is valid
+ * @return false the mode is unknown
+ */
+bool parseShardBalance(std::string_view text, bool& byDuration) {
+    if ( text != "count" && text != "duration" ) {
+        return false;
+    }
+    byDuration = text == "duration";
+    return true;
+}
+
+/**
+ * @brief Read a list of files, one per line
+ *
+ * @param path the path of the list, "-" for stdin
+ * @param files the files, empty lines are ignored
+ * @return true the list was read
+ * @return false the list could not be opened
+ */
+bool readFileList(std::string_view path, std::vector<std::string>& files) {
+    std::FILE* file = path == "-" ? stdin : std::fopen(std::string(path).c_str(), "r");
+    if ( file == nullptr ) {
+        return false;
+    }
+
+    std::string line;
+    for ( int character = std::fgetc(file); character != EOF; character = std::fgetc(file) ) {
+        if ( character != '\n' && character != '\r' ) {
+            line += static_cast<char>(character);
+        } else if ( !line.empty() ) {
+            files.push_back(std::move(line));
+            line.clear();
+        }
+    }
+    if ( !line.empty() ) {
+        files.push_back(std::move(line));
+    }
+
+    if ( file != stdin ) {
+        std::fclose(file);
+    }
+    return true;
+}
+
+/**
+ * @brief Open the sink for a reporter
+ *
+ * @param path the path of the report file, "-" for stdout
+ * @param defaultPath the path used if no path was given
+ * @param options the options of the runner, each shard gets its own default path
+ * @return std::unique_ptr<OutputSink> the sink
+ */
+std::unique_ptr<OutputSink> openSink(std::string_view path, const char* defaultPath, const Options& options) {
+    if ( path == "-" ) {
+        return std::make_unique<FileSink>(stdout);
+    }
+    if ( !path.empty() ) {
+        return std::make_unique<FileSink>(std::string(path));
+    }
+    if ( options.shardCount > 1 ) {
+        return std::make_unique<FileSink>(std::string(defaultPath) + ".shard-" + std::to_string(options.shardIndex));
+    }
+    return std::make_unique<FileSink>(std::string(defaultPath));
+}
+
+/**
+ * @brief Add a reporter given as <name>[:<path>]
+ *
+ * @param specification the reporter name and optional report path
+ * @param options the options of the runner
+ * @return true the reporter was added
+ * @return false the reporter name is unknown
+ */
+bool addReporter(std::string_view specification, const Options& options) {
+    size_t separator = specification.find(':');
+    std::string_view name = specification.substr(0, separator);
+    std::string_view path = separator == std::string_view::npos ? "" : specification.substr(separator + 1);
+
+    if ( name == "text" ) {
+        TestController::addReporter(std::make_unique<TextReporter>(openSink(path, "test.report", options)));
+    } else if ( name == "junit" ) {
+        TestController::addReporter(std::make_unique<JUnitReporter>(openSink(path, "test.report.xml", options)));
+    } else if ( name == "json" ) {
+        TestController::addReporter(std::make_unique<JsonReporter>(openSink(path, "test.report.jsonl", options)));
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Read the options that can be given as environment variables
+ *
+ * @param options the options to fill
+ * @return true all variables are valid
+ * @return false a variable is invalid
+ */
+bool parseEnvironment(Options& options) {
+    if ( const char* value = std::getenv("PIDGEON_PULSE_SHARD_INDEX") ) {
+        if ( !parseNumber(value, options.shardIndex) ) return false;
+    }
+    if ( const char* value = std::getenv("PIDGEON_PULSE_SHARD_COUNT") ) {
+        if ( !parseNumber(value, options.shardCount) ) return false;
+    }
+    if ( const char* value = std::getenv("PIDGEON_PULSE_SHARD_BALANCE") ) {
+        if ( !parseShardBalance(value, options.shardByDuration) ) return false;
+    }
+    return true;
+}
+
+}
+
 int main(int argc, char** argv) {
 
-    std::ofstream logFile("test.report");
+    Options options;
+    if ( !parseEnvironment(options) ) {
+        std::fprintf(stderr, "Invalid PIDGEON_PULSE_SHARD_* environment variable\n");
+        return EXIT_FAILURE;
+    }
+
+    for ( int i = 1; i < argc; i++ ) {
+        std::string_view argument = argv[i];
+        bool valid = true;
+        if ( argument.starts_with("--workers=") ) {
+            size_t workers = 0;
+            valid = parseNumber(argument.substr(10), workers);
+            TestController::setWorkerCount(workers);
+        } else if ( argument == "--isolate" ) {
+            TestController::setIsolation(true);
+        } else if ( argument.starts_with("--reporter=") ) {
+            options.reporters.push_back(argument.substr(11));
+        } else if ( argument.starts_with("--timing-cache=") ) {
+            options.timingCache = argument.substr(15);
+        } else if ( argument == "--no-timing-cache" ) {
+            options.timingCache.clear();
+        } else if ( argument.starts_with("--dependency-index=") ) {
+            options.dependencyIndex = argument.substr(19);
+        } else if ( argument == "--no-dependency-index" ) {
+            options.dependencyIndex.clear();
+        } else if ( argument.starts_with("--changed-files=") ) {
+            options.changedFiles = argument.substr(16);
+            valid = !options.changedFiles.empty();
+        } else if ( argument.starts_with("--shard-index=") ) {
+            valid = parseNumber(argument.substr(14), options.shardIndex);
+        } else if ( argument.starts_with("--shard-count=") ) {
+            valid = parseNumber(argument.substr(14), options.shardCount);
+        } else if ( argument.starts_with("--shard-balance=") ) {
+            valid = parseShardBalance(argument.substr(16), options.shardByDuration);
+        } else if ( argument == "--fail-fast" ) {
+            TestController::setMaxFailures(1);
+        } else if ( argument.starts_with("--max-failures=") ) {
+            size_t maxFailures = 0;
+            valid = parseNumber(argument.substr(15), maxFailures);
+            TestController::setMaxFailures(maxFailures);
+        } else if ( argument.starts_with("--timeout=") ) {
+            size_t timeout = 0;
+            valid = parseNumber(argument.substr(10), timeout);
+            TestController::setTimeout(std::chrono::milliseconds(timeout));
+        } else if ( argument.starts_with("--filter=") ) {
+            try {
+                TestController::addFilter(argument.substr(9));
+            } catch ( const std::invalid_argument& e ) {
+                std::fprintf(stderr, "%s\n", e.what());
+                valid = false;
+            }
+        } else if ( argument.starts_with("--plugin=") ) {
+            TestController::addPlugin(std::string(argument.substr(9)));
+            options.plugins = true;
+        } else if ( argument.starts_with("--plugin-dir=") ) {
+            try {
+                TestController::addPluginDirectory(std::string(argument.substr(13)));
+            } catch ( const std::runtime_error& e ) {
+                std::fprintf(stderr, "%s\n", e.what());
+                valid = false;
+            }
+            options.plugins = true;
+        } else if ( argument.starts_with("--plugin-cache=") ) {
+            options.pluginCache = argument.substr(15);
+        } else if ( argument == "--no-plugin-cache" ) {
+            options.pluginCache.clear();
+        } else if ( argument.starts_with("--trace=") ) {
+            options.trace = argument.substr(8);
+            valid = !options.trace.empty();
+        } else if ( argument.starts_with("--repeat=") ) {
+            valid = parseNumber(argument.substr(9), options.repeat) && options.repeat > 0;
+        } else if ( argument == "--until-fail" ) {
+            options.untilFail = true;
+        } else if ( argument.starts_with("--baseline=") ) {
+            options.baseline = argument.substr(11);
+            valid = !options.baseline.empty();
+        } else if ( argument == "--perf-counters" ) {
+            TestController::setPerfCounters(true);
+        } else if ( argument == "--update-baseline" ) {
+            options.updateBaseline = true;
+        } else if ( argument.starts_with("--baseline-tolerance=") ) {
+            valid = parseNumber(argument.substr(21), options.baselineTolerance);
+        } else if ( argument.starts_with("--seed=") ) {
+            uint64_t seed = 0;
+            valid = parseNumber(argument.substr(7), seed);
+            TestController::setSeed(seed);
+        } else {
+            // a mistyped option would otherwise run with the defaults
+            std::fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+
+        if ( !valid ) {
+            std::fprintf(stderr, "Invalid argument: %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if ( options.shardCount == 0 || options.shardIndex >= options.shardCount ) {
+        std::fprintf(stderr, "The shard index has to be less than the shard count\n");
+        return EXIT_FAILURE;
+    }
+    if ( options.shardByDuration && options.timingCache.empty() ) {
+        std::fprintf(stderr, "--shard-balance=duration needs a --timing-cache file\n");
+        return EXIT_FAILURE;
+    }
+    TestController::setShard(options.shardIndex, options.shardCount, options.shardByDuration);
+    if ( options.repeat > 0 || options.untilFail ) {
+        // without --repeat, --until-fail repeats until a test fails
+        TestController::setRepeat(options.repeat, options.untilFail);
+    }
+
+    if ( !options.timingCache.empty() ) {
+        TestController::setTimingCache(options.timingCache);
+    }
+
+    if ( options.updateBaseline && options.baseline.empty() ) {
+        std::fprintf(stderr, "--update-baseline needs a --baseline file\n");
+        return EXIT_FAILURE;
+    }
+    if ( !options.baseline.empty() ) {
+        TestController::setBaseline(options.baseline, options.baselineTolerance / 100.0, options.updateBaseline);
+    }
+
+    if ( options.plugins && !options.pluginCache.empty() ) {
+        TestController::setPluginCache(options.pluginCache);
+    }
+
+    if ( !options.changedFiles.empty() && options.dependencyIndex.empty() ) {
+        std::fprintf(stderr, "--changed-files needs a --dependency-index file\n");
+        return EXIT_FAILURE;
+    }
+    if ( !options.dependencyIndex.empty() ) {
+        TestController::setDependencyIndex(options.dependencyIndex);
+    }
+    if ( !options.changedFiles.empty() ) {
+        std::vector<std::string> files;
+        if ( !readFileList(options.changedFiles, files) ) {
+            std::fprintf(stderr, "Can not read the changed files from %.*s\n",
+                         static_cast<int>(options.changedFiles.size()), options.changedFiles.data());
+            return EXIT_FAILURE;
+        }
+        TestController::setChangedFiles(files);
+    }
+
+    if ( options.reporters.empty() ) {
+        options.reporters.push_back("text");
+    }
+    try {
+        for ( auto reporter : options.reporters ) {
+            if ( !addReporter(reporter, options) ) {
+                std::fprintf(stderr, "Unknown reporter: %.*s\n", static_cast<int>(reporter.size()), reporter.data());
+                return EXIT_FAILURE;
+            }
+        }
+
+        if ( !options.trace.empty() ) {
+            TestController::addReporter(std::make_unique<TraceReporter>(openSink(options.trace, "trace.json", options)));
+        }
+    } catch ( const std::runtime_error& e ) {
+        // a report file that can not be written, the message names it
+        std::fprintf(stderr, "%s\n", e.what());
+        return EXIT_FAILURE;
+    }
 
-    TestController::runTests();
-    logFile << TestController::generateReport();
+    try {
+        TestController::runTests();
+    } catch ( const std::runtime_error& e ) {
+        // a plugin that can not be loaded
+        std::fprintf(stderr, "%s\n", e.what());
+        return EXIT_FAILURE;
+    }
 
-    logFile.close();
+    if ( size_t abandoned = TestController::getAbandonedTestCount(); abandoned > 0 ) {
+        // the threads of the abandoned tests may still be running, skip the static destructors
+        std::fprintf(stderr, "PidgeonPulse: %zu tests timed out and were abandoned\n", abandoned);
+        std::fflush(nullptr);
+        std::_Exit(EXIT_FAILURE);
+    }
 
-    return EXIT_SUCCESS;
+    // failed and regressed tests fail the run, so CI can gate on the exit status
+    return TestController::getRunStats().failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include "PluginLoader.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+
+#include <dlfcn.h>
+
+namespace PidgeonPulse {
+
+namespace {
+
+/**
+ * @brief Read a line without its line break
+ *
+ * @param file the file
+ * @param line the line
+ * @return true a line was read
+ * @return false the end of the file was reached
+ */
+bool readLine(std::FILE* file, std::string& line) {
+    line.clear();
+    int character;
+    while ( (character = std::fgetc(file)) != EOF && character != '\n' ) {
+        line += static_cast<char>(character);
+    }
+    return character != EOF || !line.empty();
+}
+
+/**
+ * @brief Split off the next tab separated field
+ *
+ * @param rest the remaining text, the field and its tab are removed
+ * @return std::string_view the field
+ */
+std::string_view nextField(std::string_view& rest) {
+    size_t end = rest.find('\t');
+    std::string_view field = rest.substr(0, end);
+    rest.remove_prefix(end == std::string_view::npos ? rest.size() : end + 1);
+    return field;
+}
+
+}
+
+bool PluginLoader::stat(const std::string& path, int64_t& modified, uint64_t& size) {
+    std::error_code error;
+    auto time = std::filesystem::last_write_time(path, error);
+    if ( error ) {
+        return false;
+    }
+    size = std::filesystem::file_size(path, error);
+    modified = static_cast<int64_t>(time.time_since_epoch().count());
+    return !error;
+}
+
+void PluginLoader::addModule(std::string path) {
+    mPlugins.push_back({std::move(path)});
+}
+
+size_t PluginLoader::addDirectory(const std::string& path) {
+    std::error_code error;
+    std::vector<std::string> modules;
+    for ( auto& entry : std::filesystem::directory_iterator(path, error) ) {
+        if ( entry.is_regular_file() && entry.path().extension() == ".so" ) {
+            modules.push_back(entry.path().string());
+        }
+    }
+    if ( error ) {
+        throw std::runtime_error("Can not read the plugin directory " + path + ": " + error.message());
+    }
+
+    // the registration order decides the shards, so it must not depend on the file system
+    std::sort(modules.begin(), modules.end());
+    for ( auto& module : modules ) {
+        addModule(std::move(module));
+    }
+    return modules.size();
+}
+
+bool PluginLoader::loadCache(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "r");
+    if ( file == nullptr ) {
+        return false;
+    }
+
+    std::string line;
+    CacheEntry* entry = nullptr;
+    while ( readLine(file, line) ) {
+        std::string_view rest = line;
+        std::string_view kind = nextField(rest);
+        if ( kind == "module" ) {
+            std::string module(nextField(rest));
+            std::string_view modified = nextField(rest);
+            std::string_view size = nextField(rest);
+            entry = &mCache[module];
+            *entry = {};
+            std::from_chars(modified.data(), modified.data() + modified.size(), entry->modified);
+            std::from_chars(size.data(), size.data() + size.size(), entry->size);
+        } else if ( kind.empty() && entry != nullptr ) {
+            std::string_view collection = nextField(rest);
+            std::string_view test = nextField(rest);
+            entry->tests.push_back({std::string(collection), std::string(test), std::string(rest)});
+        }
+    }
+    std::fclose(file);
+    return true;
+}
+
+bool PluginLoader::saveCache(const std::string& path) const {
+    std::string temporaryPath = path + ".tmp";
+    std::FILE* file = std::fopen(temporaryPath.c_str(), "w");
+    if ( file == nullptr ) {
+        return false;
+    }
+
+    bool written = true;
+    for ( auto& [module, entry] : mCache ) {
+        written = written && std::fprintf(file, "module\t%s\t%lld\t%llu\n", module.c_str(),
+                                          static_cast<long long>(entry.modified),
+                                          static_cast<unsigned long long>(entry.size)) >= 0;
+        for ( auto& test : entry.tests ) {
+            written = written && std::fprintf(file, "\t%s\t%s\t%s\n", test.collection.c_str(),
+                                              test.test.c_str(), test.tags.c_str()) >= 0;
+        }
+    }
+    written = std::fclose(file) == 0 && written;
+
+    if ( !written || std::rename(temporaryPath.c_str(), path.c_str()) != 0 ) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool PluginLoader::selects(const Plugin& plugin, const TestFilter& filter) const {
+    if ( filter.empty() ) {
+        return true;
+    }
+
+    auto entry = mCache.find(plugin.path);
+    int64_t modified = 0;
+    uint64_t size = 0;
+    if ( entry == mCache.end() || !stat(plugin.path, modified, size)
+         || entry->second.modified != modified || entry->second.size != size ) {
+        return true;
+    }
+
+    return std::any_of(entry->second.tests.begin(), entry->second.tests.end(), [&filter](const CachedTest& test) {
+        return filter.matches(test.collection, test.test, test.tags);
+    });
+}
+
+void PluginLoader::record(const Plugin& plugin, std::vector<CachedTest> tests) {
+    CacheEntry entry;
+    if ( !stat(plugin.path, entry.modified, entry.size) ) {
+        return;
+    }
+    entry.tests = std::move(tests);
+    mCache[plugin.path] = std::move(entry);
+}
+
+void PluginLoader::open(Plugin& plugin) {
+    plugin.handle = dlopen(plugin.path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if ( plugin.handle == nullptr ) {
+        const char* error = dlerror();
+        throw std::runtime_error("Can not load the plugin " + plugin.path + ": " + (error ? error : "unknown error"));
+    }
+}
+
+void PluginLoader::close(Plugin& plugin) {
+    if ( plugin.handle != nullptr ) {
+        dlclose(plugin.handle);
+        plugin.handle = nullptr;
+    }
+}
+
+} // namespace PidgeonPulse
@@ -0,0 +1,158 @@
+#include "Scheduler.hpp"
+
+namespace PidgeonPulse {
+
+namespace {
+thread_local Scheduler* tCurrentScheduler = nullptr;
+thread_local size_t tCurrentWorker = 0;
+}
+
+Scheduler::Scheduler(size_t workerCount) {
+    if ( workerCount == 0 ) {
+        workerCount = defaultWorkerCount();
+    }
+
+    mWorkers.reserve(workerCount);
+    for ( size_t i = 0; i < workerCount; i++ ) {
+        mWorkers.push_back(std::make_shared<Worker>());
+    }
+    for ( size_t i = 0; i < workerCount; i++ ) {
+        mWorkers[i]->thread = std::thread(&Scheduler::workerLoop, this, i, 0);
+    }
+}
+
+Scheduler::~Scheduler() {
+    wait();
+    {
+        std::lock_guard lock(mSleepMutex);
+        mStopping = true;
+    }
+    mWakeCondition.notify_all();
+
+    for ( auto& worker : mWorkers ) {
+        std::thread thread;
+        {
+            std::lock_guard lock(worker->mutex);
+            thread = std::move(worker->thread);
+        }
+        if ( thread.joinable() ) {
+            thread.join();
+        }
+    }
+}
+
+size_t Scheduler::defaultWorkerCount() {
+    size_t count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+void Scheduler::schedule(Job job) {
+    size_t index;
+    if ( tCurrentScheduler == this ) {
+        index = tCurrentWorker;
+    } else {
+        index = mNextWorker.fetch_add(1, std::memory_order_relaxed) % mWorkers.size();
+    }
+
+    mPendingJobs.fetch_add(1);
+    {
+        std::lock_guard lock(mWorkers[index]->mutex);
+        mWorkers[index]->jobs.push_back(std::move(job));
+    }
+    // notified under the lock, a caller outside of the workers may otherwise
+    // still touch the condition after the job ran and the scheduler is gone
+    std::lock_guard lock(mSleepMutex);
+    mQueuedJobs.fetch_add(1);
+    mWakeCondition.notify_one();
+}
+
+void Scheduler::wait() {
+    std::unique_lock lock(mSleepMutex);
+    mIdleCondition.wait(lock, [this]() { return mPendingJobs.load() == 0; });
+}
+
+bool Scheduler::takeJob(size_t index, Job& job) {
+    {
+        Worker& own = *mWorkers[index];
+        std::lock_guard lock(own.mutex);
+        if ( !own.jobs.empty() ) {
+            job = std::move(own.jobs.front());
+            own.jobs.pop_front();
+            return true;
+        }
+    }
+
+    for ( size_t offset = 1; offset < mWorkers.size(); offset++ ) {
+        Worker& victim = *mWorkers[(index + offset) % mWorkers.size()];
+        std::lock_guard lock(victim.mutex);
+        if ( !victim.jobs.empty() ) {
+            job = std::move(victim.jobs.back());
+            victim.jobs.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Scheduler::finishJob() {
+    if ( mPendingJobs.fetch_sub(1) == 1 ) {
+        std::lock_guard lock(mSleepMutex);
+        mIdleCondition.notify_all();
+    }
+}
+
+void Scheduler::abandonWorker(size_t index) {
+    Worker& worker = *mWorkers[index];
+    std::thread abandoned;
+    {
+        std::lock_guard lock(worker.mutex);
+        uint64_t generation = ++worker.generation;
+        abandoned = std::move(worker.thread);
+        worker.thread = std::thread(&Scheduler::workerLoop, this, index, generation);
+    }
+    abandoned.detach();
+    finishJob();
+}
+
+std::optional<size_t> Scheduler::currentWorker() const {
+    if ( tCurrentScheduler != this ) {
+        return std::nullopt;
+    }
+    return tCurrentWorker;
+}
+
+void Scheduler::workerLoop(size_t index, uint64_t generation) {
+    tCurrentScheduler = this;
+    tCurrentWorker = index;
+
+    // keeps the worker alive for an abandoned thread that outlives the Scheduler
+    std::shared_ptr<Worker> self = mWorkers[index];
+
+    Job job;
+    while ( true ) {
+        if ( takeJob(index, job) ) {
+            mQueuedJobs.fetch_sub(1);
+            try {
+                job();
+            } catch ( ... ) {
+                // jobs report their own failures, a throwing job must not take the worker down
+            }
+            if ( self->generation.load() != generation ) {
+                tCurrentScheduler = nullptr;
+                return;
+            }
+            job = nullptr;
+            finishJob();
+            continue;
+        }
+
+        std::unique_lock lock(mSleepMutex);
+        mWakeCondition.wait(lock, [this]() { return mStopping || mQueuedJobs.load() > 0; });
+        if ( mStopping && mQueuedJobs.load() == 0 ) {
+            return;
+        }
+    }
+}
+
+} // namespace PidgeonPulse
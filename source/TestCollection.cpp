@@ -1,74 +1,71 @@
 #include "TestCollection.hpp"
 #include "TestController.hpp"
+#include "TextReporter.hpp"
+
 namespace PidgeonPulse {
 
 TestCollection::TestCollection(std::string name): mTestCollectionName(name) {
-    mThreadPool.pause();
     TestController::getInstance().mTestCollections.push_back(this);
 }
 
 TestCollection::~TestCollection() {
-    mTests.clear();
-}
-
-
-std::string TestCollection::createFailReport(Testable* test) {
-    std::string report = "\tTest failed: " + test->get_name() + "\n";
-
-    for ( auto& failInfo : test->get_fail_infos() ) {
-        report += "\t File: " + std::string(failInfo.file) + ":" + std::to_string(failInfo.line) + "\n";
-        if ( failInfo.exception ) {
-            try {
-                std::rethrow_exception(failInfo.exception);
-            } catch ( const std::exception& e ) {
-                report += std::string("\t Exception: ") + e.what() + "\n";
-            } catch ( ... ) {
-                report += "\t Exception: Unknown exception\n";
-            }
-        }
-        report += "\n";
+    // the controller may already be gone, or be destroying this collection
+    if ( auto controller = TestController::tryGetInstance() ) {
+        controller->unregisterTestCollection(this);
     }
-
-    return report;
 }
 
 void TestCollection::addTest(Testable* test) {
     mTests.push_back(test);
-    mTestFutures.push_back(mThreadPool.queueJob(
-        [test]() {
-            (*test)();
-        })
-    );
 }
 
-void TestCollection::runTests() {
-    mThreadPool.resume();
+void TestCollection::addTest(std::unique_ptr<Testable> test) {
+    mTests.push_back(test.get());
+    mOwnedTests.push_back(std::move(test));
+}
 
-    for ( auto& future : mTestFutures ) {
-        future.wait();
+std::vector<Testable*> TestCollection::takePendingTests() {
+    size_t size = mTests.size();
+    std::vector<Testable*> tests;
+    tests.reserve(size - mQueuedTests);
+    for ( size_t index = mQueuedTests; index < size; index++ ) {
+        tests.push_back(mTests[index]);
     }
+    mQueuedTests = size;
+    return tests;
 }
 
-std::string TestCollection::generateReport() {
-    std::string report = "Test Collection: " + mTestCollectionName + "\n";
+void TestCollection::runTests() {
+    std::vector<TestController::TestJob> jobs;
+    for ( auto test : takePendingTests() ) {
+        jobs.push_back({this, test});
+    }
+    TestController::runJobs(std::move(jobs));
+}
 
-    if ( mThreadPool.hasTasks() ) {
+void TestCollection::report(Reporter& reporter) {
+    if ( mQueuedTests < mTests.size() ) {
         runTests();
     }
 
-    uint32_t testCount = mTests.size();
-    uint32_t failedCount = 0;
-
-    for ( auto& test : mTests ) {
-        if ( !test->get_result() ) {
-            failedCount++;
-            report += createFailReport(test);
+    TestStats stats;
+    reporter.collectionStarting(*this);
+    for ( auto test : mTests ) {
+        // not selected by the filter, the shard or the changed files
+        if ( !test->result_ready() ) {
+            continue;
         }
+        stats.add(*test);
+        reporter.testFinished(*this, *test);
     }
+    reporter.collectionFinished(*this, stats);
+}
 
-    report += "Stats: failed " + std::to_string(failedCount) + " of " + std::to_string(testCount) + " tests\n";
-
-    return report;
+std::string TestCollection::generateReport() {
+    StringSink sink;
+    TextReporter reporter(sink);
+    report(reporter);
+    return sink.str();
 }
 
 } // namespace PidgeonPulse
\ No newline at end of file
@@ -1,35 +1,930 @@
 #include "TestController.hpp"
+#include "AsyncTest.hpp"
+#include "Benchmark.hpp"
+#include "ForkServer.hpp"
+#include "Random.hpp"
+#include "TextReporter.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
 
 using namespace PidgeonPulse;
 
+namespace {
+
+/**
+ * @brief Keep a collection alive until the process exits
+ *
+ * @param collection the collection, one of its abandoned tests may still be running
+ */
+void keepUntilExit(std::unique_ptr<TestCollection> collection) {
+    static auto* kept = new std::vector<std::unique_ptr<TestCollection>>();
+    kept->push_back(std::move(collection));
+}
+
+}
+
 TestCollection& TestController::addTestCollection(std::string name) {
-    auto& controller = TestController::getInstance();
-    controller.mTestCollections.push_back(new TestCollection(name));
-    return *controller.mTestCollections.back();
+    // the TestCollection registers itself with the controller
+    auto collection = std::make_unique<TestCollection>(std::move(name));
+    TestCollection& reference = *collection;
+    getInstance().mOwnedCollections.push_back(std::move(collection));
+    return reference;
+}
+
+void TestController::unregisterTestCollection(const TestCollection* collection) {
+    for (auto& registered : mTestCollections) {
+        if (registered == collection) {
+            registered = nullptr;
+            return;
+        }
+    }
+}
+
+void TestController::reset() {
+    Singleton<TestController>::reset();
+}
+
+void TestController::instantiateRegisteredTests() {
+    std::unordered_map<std::string_view, TestCollection*> collections;
+    for (auto collection : mTestCollections) {
+        if (collection) {
+            collections.try_emplace(collection->getName(), collection);
+        }
+    }
+
+    for (auto& descriptor : mRegistry) {
+        if (descriptor.instantiated) {
+            continue;
+        }
+        auto entry = collections.find(descriptor.collection);
+        TestCollection* collection = entry == collections.end() ? nullptr : entry->second;
+        std::string_view collectionTags = collection ? std::string_view(collection->getTags()) : std::string_view();
+        if (!mFilter.matches(descriptor.collection, descriptor.name, descriptor.tags, collectionTags)) {
+            continue;
+        }
+
+        if (!collection) {
+            collection = &addTestCollection(descriptor.collection);
+            collections.emplace(collection->getName(), collection);
+        }
+        auto test = descriptor.factory(descriptor.name);
+        test->mTags += descriptor.tags;
+        collection->addTest(std::move(test));
+        descriptor.instantiated = true;
+    }
+}
+
+void TestController::loadPlugins() {
+    for (auto& plugin : mPlugins.getPlugins()) {
+        if (plugin.handle || !mPlugins.selects(plugin, mFilter)) {
+            continue;
+        }
+
+        plugin.collections[0] = mTestCollections.size();
+        plugin.descriptors[0] = mRegistry.size();
+        plugin.fixtures[0] = mFixtures.size();
+        PluginLoader::open(plugin);
+        plugin.collections[1] = mTestCollections.size();
+        plugin.descriptors[1] = mRegistry.size();
+        plugin.fixtures[1] = mFixtures.size();
+
+        std::vector<PluginLoader::CachedTest> tests;
+        for (size_t index = plugin.collections[0]; index < plugin.collections[1]; index++) {
+            if (TestCollection* collection = mTestCollections[index]) {
+                for (auto test : collection->getTests()) {
+                    tests.push_back({collection->getName(), test->get_name(), test->get_tags() + collection->getTags()});
+                }
+            }
+        }
+        for (size_t index = plugin.descriptors[0]; index < plugin.descriptors[1]; index++) {
+            auto& descriptor = mRegistry[index];
+            tests.push_back({descriptor.collection, descriptor.name, descriptor.tags});
+        }
+        mPlugins.record(plugin, std::move(tests));
+    }
+}
+
+void TestController::unloadPlugins() {
+    for (auto& plugin : mPlugins.getPlugins()) {
+        if (!plugin.handle) {
+            continue;
+        }
+
+        // the tests of the plugin live in its collections, their code goes away with the plugin
+        std::unordered_set<std::string> collections;
+        for (size_t index = plugin.collections[0]; index < plugin.collections[1]; index++) {
+            if (TestCollection* collection = mTestCollections[index]) {
+                collections.insert(collection->getName());
+            }
+        }
+        for (size_t index = plugin.descriptors[0]; index < plugin.descriptors[1]; index++) {
+            collections.insert(mRegistry[index].collection);
+        }
+
+        // an abandoned test may still run the code of the plugin, it stays loaded until the process exits
+        bool abandoned = false;
+        for (auto collection : mTestCollections) {
+            if (collection && collections.contains(collection->getName())) {
+                for (auto test : collection->getTests()) {
+                    abandoned = abandoned || test->was_abandoned();
+                }
+            }
+        }
+        if (abandoned) {
+            std::fprintf(stderr, "PidgeonPulse: keeping %s loaded, one of its abandoned tests may still be running\n",
+                         plugin.path.c_str());
+            for (auto& collection : mOwnedCollections) {
+                if (collection && collections.contains(collection->getName())) {
+                    keepUntilExit(std::move(collection));
+                }
+            }
+            continue;
+        }
+
+        for (size_t index = plugin.descriptors[0]; index < plugin.descriptors[1]; index++) {
+            auto& descriptor = mRegistry[index];
+            descriptor.factory = nullptr;
+            descriptor.instantiated = true;
+        }
+        for (auto& collection : mOwnedCollections) {
+            if (collection && collections.contains(collection->getName())) {
+                collection.reset();
+            }
+        }
+        for (size_t index = plugin.fixtures[0]; index < plugin.fixtures[1]; index++) {
+            mFixtures[index] = nullptr;
+        }
+
+        // static collections of the plugin unregister themselves when it is unloaded
+        PluginLoader::close(plugin);
+    }
 }
 
 void TestController::runTests() {
     auto& controller = TestController::getInstance();
+    controller.loadPlugins();
+    controller.instantiateRegisteredTests();
+    controller.mRunStats = {};
+    for (auto& reporter : controller.mReporters) {
+        reporter->runStarting();
+    }
+
+    std::vector<TestJob> jobs;
     for (auto collection : controller.mTestCollections) {
-        collection->runTests();
+        if (!collection) {
+            continue;
+        }
+        auto tests = collection->takePendingTests();
+        if (!controller.mFilter.empty()) {
+            std::erase_if(tests, [&controller, collection](Testable* test) {
+                return !controller.mFilter.matches(collection->getName(), test->get_name(), test->get_tags(), collection->getTags());
+            });
+            // a collection without selected tests is left out of the report
+            if (tests.empty()) {
+                continue;
+            }
+        }
+        if (tests.empty()) {
+            for (auto& reporter : controller.mReporters) {
+                reporter->collectionStarting(*collection);
+                reporter->collectionFinished(*collection, {});
+            }
+        }
+        for (auto test : tests) {
+            jobs.push_back({collection, test});
+        }
+    }
+    controller.recordDependencies(jobs);
+    controller.selectAffected(jobs);
+    controller.selectShard(jobs);
+    if (controller.mRepeatCount != 1 || controller.mUntilFail) {
+        controller.repeatJobs(jobs);
+    } else {
+        runJobs(std::move(jobs));
+    }
+
+    for (auto& reporter : controller.mReporters) {
+        reporter->runFinished(controller.mRunStats);
+    }
+
+    if (controller.mTimingCache) {
+        controller.mTimingCache->save(controller.mTimingCachePath);
+    }
+    if (controller.mBaseline && controller.mUpdateBaseline) {
+        controller.mBaseline->save(controller.mBaselinePath);
+    }
+    if (controller.mDependencyIndex && !controller.mDependencyIndexPath.empty()) {
+        controller.mDependencyIndex->save(controller.mDependencyIndexPath);
+    }
+    if (!controller.mPluginCachePath.empty()) {
+        controller.mPlugins.saveCache(controller.mPluginCachePath);
+    }
+    controller.unloadPlugins();
+}
+
+void TestController::addReporter(std::unique_ptr<Reporter> reporter) {
+    auto& controller = TestController::getInstance();
+    controller.mReporters.push_back(std::move(reporter));
+}
+
+void TestController::reportTestFinished(const TestJob& job) {
+    // an abandoned test may still use its fixtures, they live until the process exits
+    if (!job.test->was_abandoned()) {
+        forEachFixture(job, [](FixtureBase& fixture) { fixture.release(); });
+    }
+
+    // includes the time spent waiting for the reporters of other tests
+    job.test->mMetrics.reportStart = TestMetrics::Clock::now();
+    std::lock_guard lock(mReportMutex);
+
+    std::optional<BaselineComparison> comparison = compareWithBaseline(job);
+
+    auto& progress = mProgress[job.collection];
+    progress.stats.add(*job.test);
+    mRunStats.add(*job.test);
+
+    if (!job.test->was_skipped() && !job.test->get_result() && mMaxFailures > 0) {
+        if (++mFailureCount >= mMaxFailures) {
+            mStopSource.request_stop();
+        }
+    }
+
+    // a skipped test did not run long enough to say anything about its duration
+    if (mTimingCache && !job.test->was_skipped()) {
+        mTimingCache->record(
+            TimingCache::key(job.collection->getName(), job.test->get_name()),
+            job.test->get_duration().count()
+        );
+    }
+
+    for (auto& reporter : mReporters) {
+        if (comparison) {
+            reporter->baselineCompared(*job.collection, *job.test, *comparison);
+        }
+        reporter->testFinished(*job.collection, *job.test);
+    }
+
+    if (--progress.remaining == 0) {
+        for (auto& reporter : mReporters) {
+            reporter->collectionFinished(*job.collection, progress.stats);
+        }
+        mProgress.erase(job.collection);
+    }
+}
+
+std::optional<BaselineComparison> TestController::compareWithBaseline(const TestJob& job) {
+    // a failed test did not measure anything worth comparing
+    if (!mBaseline || job.test->was_skipped() || !job.test->get_result()) {
+        return std::nullopt;
+    }
+
+    std::vector<double> samples;
+    const char* unit = "s";
+    double noiseFloor = Baseline::DURATION_NOISE_FLOOR;
+    if (auto benchmark = dynamic_cast<const Benchmark*>(job.test)) {
+        // the samples stay in the worker process in isolation mode
+        if (benchmark->get_stats().samples.empty()) {
+            return std::nullopt;
+        }
+        samples = benchmark->get_stats().samples;
+        unit = " ns/op";
+        noiseFloor = 0;
+    } else {
+        samples.push_back(job.test->get_duration().count());
+    }
+
+    uint64_t key = TimingCache::key(job.collection->getName(), job.test->get_name());
+    std::optional<BaselineComparison> comparison;
+    const std::vector<float>* baseline = mBaseline->lookup(key);
+    if (baseline && baseline->size() >= Baseline::MIN_SAMPLES) {
+        comparison = Baseline::compare(*baseline, samples, mBaselineTolerance, noiseFloor);
+    }
+
+    if (mUpdateBaseline) {
+        if (samples.size() > 1) {
+            mBaseline->replace(key, samples);
+        } else {
+            mBaseline->append(key, samples.front());
+        }
+    }
+
+    if (comparison && comparison->regressed) {
+        char message[160];
+        std::snprintf(message, sizeof(message), "regressed by %+.1f%% (median %.6g%s, baseline %.6g%s, p=%.4f)",
+                      comparison->delta() * 100, comparison->current, unit, comparison->baseline, unit,
+                      comparison->pValue);
+        // the run already published its result, the failure is added to it
+        job.test->mFailInfos.push({nullptr, 0, nullptr, "baseline", job.test->mFailInfos.storeText(message)});
+        job.test->mState = job.test->mState | Testable::STATE::FAIL_BIT;
+    }
+    return comparison;
+}
+
+std::chrono::milliseconds TestController::timeoutOf(const TestJob& job) const {
+    if (job.test->get_timeout().count() > 0) {
+        return job.test->get_timeout();
+    }
+    if (job.collection->getTimeout().count() > 0) {
+        return job.collection->getTimeout();
+    }
+    return mTimeout;
+}
+
+void TestController::runWithTimeout(const TestJob& job, std::chrono::milliseconds timeout, const std::stop_token& stopToken) {
+    auto inFlight = std::make_shared<InFlightTest>();
+    inFlight->job = job;
+    inFlight->timeout = timeout;
+    inFlight->worker = getScheduler().currentWorker().value_or(0);
+    inFlight->started = std::chrono::steady_clock::now();
+
+    Watchdog* watchdog;
+    {
+        std::lock_guard lock(mInFlightMutex);
+        mInFlight[job.test] = inFlight;
+        if (!mWatchdog) {
+            mWatchdog = std::make_unique<Watchdog>();
+        }
+        watchdog = mWatchdog.get();
+    }
+
+    // open the run before the watchdog can claim it
+    job.test->mOutcome = Testable::OUTCOME::OPEN;
+    auto timer = watchdog->arm(timeout, [this, inFlight]() { abandonTest(*inFlight); });
+    (*job.test)(stopToken);
+
+    if (!watchdog->disarm(timer)) {
+        // the timer fired, wait until the watchdog tried to claim the test
+        inFlight->decided.wait(false);
+        if (inFlight->abandoned) {
+            // the watchdog reports the test, wait until it replaced this thread
+            inFlight->replaced.wait(false);
+            return;
+        }
+    }
+
+    {
+        std::lock_guard lock(mInFlightMutex);
+        mInFlight.erase(job.test);
+    }
+    reportTestFinished(job);
+}
+
+void TestController::abandonTest(InFlightTest& test) {
+    bool abandoned = test.job.test->abandon(test.timeout);
+    test.abandoned = abandoned;
+    test.decided = true;
+    test.decided.notify_all();
+    if (!abandoned) {
+        // the test finished and was torn down right before its timeout expired
+        return;
+    }
+
+    {
+        std::lock_guard lock(mInFlightMutex);
+        mInFlight.erase(test.job.test);
+
+        auto now = std::chrono::steady_clock::now();
+        std::fprintf(stderr, "PidgeonPulse: %s/%s timed out after %lld ms, abandoning its worker thread\n",
+                     test.job.collection->getName().c_str(), test.job.test->get_name().c_str(),
+                     static_cast<long long>(test.timeout.count()));
+        for (auto& [testable, other] : mInFlight) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - other->started);
+            std::fprintf(stderr, "  still running: %s/%s (for %lld ms)\n",
+                         other->job.collection->getName().c_str(), testable->get_name().c_str(),
+                         static_cast<long long>(elapsed.count()));
+        }
+    }
+
+    mAbandonedTests++;
+    reportTestFinished(test.job);
+
+    // the worker thread waits for replaced before it returns, so it can not pick up another job in between
+    getScheduler().abandonWorker(test.worker);
+    test.replaced = true;
+    test.replaced.notify_all();
+}
+
+void TestController::recordDependencies(const std::vector<TestJob>& jobs) {
+    if (!mDependencyIndex) {
+        return;
+    }
+
+    for (auto& job : jobs) {
+        auto& testDependencies = job.test->get_dependencies();
+        auto& collectionDependencies = job.collection->getDependencies();
+        if (testDependencies.empty() && collectionDependencies.empty()) {
+            continue;
+        }
+        std::vector<std::string> files;
+        files.reserve(testDependencies.size() + collectionDependencies.size());
+        files.insert(files.end(), testDependencies.begin(), testDependencies.end());
+        files.insert(files.end(), collectionDependencies.begin(), collectionDependencies.end());
+        mDependencyIndex->record(job.collection->getName(), job.test->get_name(), std::move(files));
+    }
+}
+
+void TestController::selectAffected(std::vector<TestJob>& jobs) const {
+    if (!mChangedFiles || !mDependencyIndex) {
+        return;
+    }
+
+    std::erase_if(jobs, [this](const TestJob& job) {
+        return !mDependencyIndex->affected(job.collection->getName(), job.test->get_name(), *mChangedFiles);
+    });
+}
+
+void TestController::selectShard(std::vector<TestJob>& jobs) const {
+    if (mShardCount <= 1) {
+        return;
+    }
+
+    std::vector<bool> selected(jobs.size(), false);
+
+    bool byDuration = mShardByDuration && mTimingCache && mTimingCache->size() > 0;
+    if (mShardByDuration && !byDuration) {
+        // the first run of a new timing cache has nothing to balance by yet
+        static std::atomic<bool> warned = false;
+        if (!warned.exchange(true)) {
+            std::fprintf(stderr, "PidgeonPulse: no test timings to balance the shards by, splitting them by count\n");
+        }
+    }
+
+    if (!byDuration) {
+        for (size_t i = mShardIndex; i < jobs.size(); i += mShardCount) {
+            selected[i] = true;
+        }
+    } else {
+        std::vector<std::optional<double>> durations;
+        durations.reserve(jobs.size());
+        double knownSum = 0;
+        size_t knownCount = 0;
+        for (auto& job : jobs) {
+            durations.push_back(mTimingCache->lookup(TimingCache::key(job.collection->getName(), job.test->get_name())));
+            if (durations.back()) {
+                knownSum += *durations.back();
+                knownCount++;
+            }
+        }
+
+        // unknown tests are expected to take as long as an average test
+        double average = knownCount > 0 ? knownSum / knownCount : 0;
+        std::vector<std::pair<double, size_t>> expected;
+        expected.reserve(jobs.size());
+        for (size_t i = 0; i < jobs.size(); i++) {
+            expected.push_back({durations[i].value_or(average), i});
+        }
+        std::sort(expected.begin(), expected.end(), [](auto& a, auto& b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        });
+
+        std::vector<double> load(mShardCount, 0);
+        for (auto& [duration, index] : expected) {
+            size_t shard = std::min_element(load.begin(), load.end()) - load.begin();
+            load[shard] += duration;
+            selected[index] = shard == mShardIndex;
+        }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        if (selected[i]) {
+            jobs[kept++] = jobs[i];
+        }
+    }
+    jobs.resize(kept);
+}
+
+void TestController::orderJobs(std::vector<TestJob>& jobs) const {
+    // a shuffled order has to stay reproducible from the seed
+    if (mShuffle || !mTimingCache || mTimingCache->size() == 0) {
+        return;
+    }
+
+    std::vector<std::pair<double, TestJob>> expected;
+    expected.reserve(jobs.size());
+    for (auto& job : jobs) {
+        auto duration = mTimingCache->lookup(TimingCache::key(job.collection->getName(), job.test->get_name()));
+        expected.push_back({duration.value_or(-1), job});
+    }
+
+    std::stable_sort(expected.begin(), expected.end(), [](auto& a, auto& b) {
+        bool aKnown = a.first >= 0;
+        bool bKnown = b.first >= 0;
+        if (aKnown != bKnown) {
+            return !aKnown;
+        }
+        return a.first > b.first;
+    });
+
+    for (size_t i = 0; i < jobs.size(); i++) {
+        jobs[i] = expected[i].second;
+    }
+}
+
+void TestController::groupByFixture(std::vector<TestJob>& jobs) const {
+    std::vector<std::vector<FixtureBase*>> keys(jobs.size());
+    bool anyFixtures = false;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        auto& key = keys[i];
+        key = jobs[i].test->get_fixtures();
+        key.insert(key.end(), jobs[i].collection->getFixtures().begin(), jobs[i].collection->getFixtures().end());
+        std::sort(key.begin(), key.end());
+        key.erase(std::unique(key.begin(), key.end()), key.end());
+        anyFixtures |= !key.empty();
+    }
+    if (!anyFixtures) {
+        return;
+    }
+
+    struct Group {
+        std::vector<TestJob> jobs;
+        bool live = false;
+    };
+    std::vector<Group> groups;
+    std::map<std::vector<FixtureBase*>, size_t> groupIndex;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        if (keys[i].empty()) {
+            groups.push_back({{jobs[i]}, false});
+            continue;
+        }
+        auto [entry, inserted] = groupIndex.try_emplace(keys[i], groups.size());
+        if (inserted) {
+            bool live = std::any_of(keys[i].begin(), keys[i].end(), [](FixtureBase* fixture) { return fixture->isLive(); });
+            groups.push_back({{}, live});
+        }
+        groups[entry->second].jobs.push_back(jobs[i]);
+    }
+    std::stable_partition(groups.begin(), groups.end(), [](const Group& group) { return group.live; });
+
+    jobs.clear();
+    for (auto& group : groups) {
+        jobs.insert(jobs.end(), group.jobs.begin(), group.jobs.end());
+    }
+}
+
+void TestController::runJobs(std::vector<TestJob> jobs) {
+    auto& controller = TestController::getInstance();
+    controller.orderJobs(jobs);
+    controller.groupByFixture(jobs);
+
+    std::stop_token stopToken;
+    {
+        std::lock_guard lock(controller.mReportMutex);
+        controller.mStopSource = std::stop_source();
+        controller.mFailureCount = 0;
+        stopToken = controller.mStopSource.get_token();
+        for (auto& job : jobs) {
+            controller.forEachFixture(job, [](FixtureBase& fixture) { fixture.retain(); });
+            auto& progress = controller.mProgress[job.collection];
+            if (progress.remaining++ == 0) {
+                for (auto& reporter : controller.mReporters) {
+                    reporter->collectionStarting(*job.collection);
+                }
+            }
+        }
+    }
+
+    // compared timings are measured without other tests competing for the cores
+    auto shared = std::stable_partition(jobs.begin(), jobs.end(), [&controller](const TestJob& job) {
+        return !controller.needsExclusiveRun(job);
+    });
+    std::vector<TestJob> exclusiveJobs(std::make_move_iterator(shared), std::make_move_iterator(jobs.end()));
+    jobs.erase(shared, jobs.end());
+
+    if (controller.mIsolation) {
+        size_t workerCount = controller.mWorkerCount == 0 ? Scheduler::defaultWorkerCount() : controller.mWorkerCount;
+        controller.runIsolated(jobs, workerCount, stopToken);
+        controller.runIsolated(exclusiveJobs, 1, stopToken);
+        return;
+    }
+
+    for (auto& job : jobs) {
+        controller.scheduleJob(job, stopToken);
+    }
+    controller.waitForJobs();
+    for (auto& job : exclusiveJobs) {
+        controller.scheduleJob(job, stopToken);
+        controller.waitForJobs();
+    }
+}
+
+bool TestController::needsExclusiveRun(const TestJob& job) const {
+    if (dynamic_cast<const Benchmark*>(job.test) != nullptr) {
+        return true;
+    }
+    if (!mBaseline) {
+        return false;
+    }
+    // recorded timings have to be measured the way they are compared later
+    if (mUpdateBaseline) {
+        return true;
+    }
+    const std::vector<float>* baseline = mBaseline->lookup(TimingCache::key(job.collection->getName(), job.test->get_name()));
+    return baseline && baseline->size() >= Baseline::MIN_SAMPLES;
+}
+
+void TestController::runIsolated(const std::vector<TestJob>& jobs, size_t workerCount, const std::stop_token& stopToken) {
+    if (jobs.empty()) {
+        return;
+    }
+    std::vector<Testable*> tests;
+    tests.reserve(jobs.size());
+    for (auto& job : jobs) {
+        tests.push_back(job.test);
+    }
+    ForkServer server(tests, [this, &jobs](size_t index) {
+        reportTestFinished(jobs[index]);
+    }, stopToken);
+
+    std::vector<std::chrono::milliseconds> timeouts;
+    timeouts.reserve(jobs.size());
+    for (auto& job : jobs) {
+        timeouts.push_back(timeoutOf(job));
+    }
+    server.setTimeouts(std::move(timeouts));
+    server.run(workerCount);
+}
+
+void TestController::scheduleJob(const TestJob& job, const std::stop_token& stopToken) {
+    Scheduler& scheduler = getScheduler();
+    auto timeout = timeoutOf(job);
+    auto queued = TestMetrics::Clock::now();
+    scheduler.schedule(
+        [this, &scheduler, job, stopToken, timeout, queued]() {
+            job.test->mMetrics.queued = queued;
+            job.test->mMetrics.worker = scheduler.currentWorker().value_or(0);
+            if (stopToken.stop_requested()) {
+                job.test->mark_skipped();
+            } else if (timeout.count() > 0) {
+                runWithTimeout(job, timeout, stopToken);
+                return;
+            } else if (auto async = dynamic_cast<AsyncTest*>(job.test)) {
+                // a suspended test gives its worker back, it is reported once its task finished
+                {
+                    std::lock_guard lock(mAsyncMutex);
+                    mRunningAsync++;
+                }
+                async->start(stopToken, scheduler, [this, job]() {
+                    reportTestFinished(job);
+                    std::lock_guard lock(mAsyncMutex);
+                    if (--mRunningAsync == 0) {
+                        mAsyncIdle.notify_all();
+                    }
+                });
+                return;
+            } else {
+                (*job.test)(stopToken);
+            }
+            reportTestFinished(job);
+        }
+    );
+}
+
+void TestController::waitForJobs() {
+    Scheduler& scheduler = getScheduler();
+    scheduler.wait();
+
+    // the workers run dry while all async tests are suspended
+    {
+        std::unique_lock lock(mAsyncMutex);
+        mAsyncIdle.wait(lock, [this]() { return mRunningAsync == 0; });
+    }
+    scheduler.wait();
+}
+
+void TestController::repeatJobs(const std::vector<TestJob>& jobs) {
+    std::vector<RepeatStats> results;
+    results.reserve(jobs.size());
+    for (auto& job : jobs) {
+        results.push_back({job.collection, job.test});
+    }
+
+    std::vector<size_t> order(jobs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<TestJob> repetition;
+    Random random(Random::deriveSeed(mSeed, "order"));
+
+    mShuffle = true;
+    size_t repetitions = 0;
+    bool failed = false;
+    while ((mRepeatCount == 0 || repetitions < mRepeatCount) && !(mUntilFail && failed) && !order.empty()) {
+        for (size_t i = order.size(); i > 1; i--) {
+            std::swap(order[i - 1], order[random.below(i)]);
+        }
+        repetition.clear();
+        for (size_t index : order) {
+            jobs[index].test->reset();
+            repetition.push_back(jobs[index]);
+        }
+        runJobs(repetition);
+        repetitions++;
+
+        for (size_t index : order) {
+            auto& result = results[index];
+            result.runs++;
+            if (jobs[index].test->was_skipped()) {
+                result.skipped++;
+            } else if (!jobs[index].test->get_result()) {
+                result.failed++;
+                failed = true;
+            }
+        }
+
+        // abandoned tests may still be running, they can not be reset
+        std::erase_if(order, [&jobs](size_t index) { return jobs[index].test->was_abandoned(); });
+        if (mStopSource.stop_requested()) {
+            break;
+        }
+    }
+    mShuffle = false;
+
+    for (auto& reporter : mReporters) {
+        reporter->repeatFinished(results, repetitions, mSeed);
     }
 }
 
 std::string TestController::generateReport() {
     auto& controller = TestController::getInstance();
-    std::string report = "PidgeonPulse Unit Test:\n";
+    StringSink sink;
+    TextReporter reporter(sink);
+    reporter.runStarting();
     for (auto collection : controller.mTestCollections) {
-        report += collection->generateReport();
+        if (collection) {
+            collection->report(reporter);
+        }
     }
-    return report;
+    return sink.str();
 }
 
 TestCollection& TestController::getTestCollection(const std::string& name) {
     auto& controller = TestController::getInstance();
     for (auto collection : controller.mTestCollections) {
-        if (collection->getName() == name) {
+        if (collection && collection->getName() == name) {
             return *collection;
         }
     }
     throw std::runtime_error("TestCollection not found");
 }
+
+void TestController::setWorkerCount(size_t count) {
+    auto& controller = TestController::getInstance();
+    size_t workerCount = count == 0 ? Scheduler::defaultWorkerCount() : count;
+    if (controller.mScheduler && controller.mScheduler->getWorkerCount() != workerCount) {
+        controller.mScheduler.reset();
+    }
+    controller.mWorkerCount = count;
+}
+
+void TestController::setIsolation(bool enabled) {
+    auto& controller = TestController::getInstance();
+    if (enabled && controller.mScheduler) {
+        // the worker threads would be lost in the forked processes
+        controller.mScheduler.reset();
+    }
+    controller.mIsolation = enabled;
+}
+
+void TestController::setTimingCache(const std::string& path) {
+    auto& controller = TestController::getInstance();
+    controller.mTimingCache = std::make_unique<TimingCache>();
+    controller.mTimingCache->load(path);
+    controller.mTimingCachePath = path;
+}
+
+void TestController::setPerfCounters(bool enabled) {
+    PerfCounters::setEnabled(enabled);
+}
+
+void TestController::setBaseline(const std::string& path, double tolerance, bool update) {
+    auto& controller = TestController::getInstance();
+    controller.mBaseline = std::make_unique<Baseline>();
+    controller.mBaseline->load(path);
+    controller.mBaselinePath = path;
+    controller.mBaselineTolerance = tolerance;
+    controller.mUpdateBaseline = update;
+}
+
+void TestController::setDependencyIndex(const std::string& path) {
+    auto& controller = TestController::getInstance();
+    controller.mDependencyIndex = std::make_unique<DependencyIndex>();
+    controller.mDependencyIndex->load(path);
+    controller.mDependencyIndexPath = path;
+}
+
+void TestController::setChangedFiles(const std::vector<std::string>& files) {
+    auto& controller = TestController::getInstance();
+    if (!controller.mDependencyIndex) {
+        controller.mDependencyIndex = std::make_unique<DependencyIndex>();
+    }
+    controller.mChangedFiles.emplace();
+    for (auto& file : files) {
+        controller.mChangedFiles->emplace(DependencyIndex::normalize(file));
+    }
+}
+
+void TestController::setRepeat(size_t count, bool untilFail) {
+    auto& controller = TestController::getInstance();
+    // without a failure to wait for, no limit would never end
+    controller.mRepeatCount = count == 0 && !untilFail ? 1 : count;
+    controller.mUntilFail = untilFail;
+}
+
+void TestController::setShard(size_t index, size_t count, bool balanceByDuration) {
+    if (count == 0 || index >= count) {
+        throw std::invalid_argument("Shard index has to be less than the shard count");
+    }
+    auto& controller = TestController::getInstance();
+    controller.mShardIndex = index;
+    controller.mShardCount = count;
+    controller.mShardByDuration = balanceByDuration;
+}
+
+void TestController::setTimeout(std::chrono::milliseconds timeout) {
+    auto& controller = TestController::getInstance();
+    controller.mTimeout = timeout;
+}
+
+size_t TestController::getAbandonedTestCount() {
+    return TestController::getInstance().mAbandonedTests.load();
+}
+
+const TestStats& TestController::getRunStats() {
+    return TestController::getInstance().mRunStats;
+}
+
+uint64_t TestController::randomSeed() {
+    std::random_device device;
+    return (static_cast<uint64_t>(device()) << 32) ^ device()
+        ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+void TestController::setSeed(uint64_t seed) {
+    auto& controller = TestController::getInstance();
+    controller.mSeed = seed;
+}
+
+uint64_t TestController::getSeed() {
+    return TestController::getInstance().mSeed;
+}
+
+void TestController::addFilter(std::string_view expression) {
+    auto& controller = TestController::getInstance();
+    controller.mFilter.add(expression);
+}
+
+void TestController::registerTest(const char* collection, const char* name, const char* tags,
+                                  std::unique_ptr<Testable> (*factory)(std::string name)) {
+    auto& controller = TestController::getInstance();
+    controller.mRegistry.push_back({collection, name, tags, factory});
+}
+
+void TestController::addPlugin(std::string path) {
+    auto& controller = TestController::getInstance();
+    controller.mPlugins.addModule(std::move(path));
+}
+
+void TestController::addPluginDirectory(const std::string& path) {
+    auto& controller = TestController::getInstance();
+    controller.mPlugins.addDirectory(path);
+}
+
+void TestController::setPluginCache(const std::string& path) {
+    auto& controller = TestController::getInstance();
+    controller.mPlugins.loadCache(path);
+    controller.mPluginCachePath = path;
+}
+
+void TestController::useFixture(FixtureBase& fixture) {
+    auto& controller = TestController::getInstance();
+    controller.mFixtures.push_back(&fixture);
+}
+
+Scheduler* TestController::getHelperScheduler() {
+    auto& controller = TestController::getInstance();
+    if (controller.mIsolation) {
+        return nullptr;
+    }
+    return controller.mScheduler.get();
+}
+
+void TestController::setMaxFailures(size_t count) {
+    auto& controller = TestController::getInstance();
+    controller.mMaxFailures = count;
+}
+
+Scheduler& TestController::getScheduler() {
+    auto& controller = TestController::getInstance();
+    if (!controller.mScheduler) {
+        controller.mScheduler = std::make_unique<Scheduler>(controller.mWorkerCount);
+    }
+    return *controller.mScheduler;
+}
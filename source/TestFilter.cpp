@@ -0,0 +1,174 @@
+#include "TestFilter.hpp"
+
+#include <stdexcept>
+
+namespace PidgeonPulse {
+
+namespace {
+
+/**
+ * @brief Find the comma that ends the first term of a filter expression
+ *
+ * Commas of a regex term inside braces, a bracket expression or after a
+ * backslash belong to the regex, so "re:a{1,3}" stays one term.
+ *
+ * @param expression the filter expression
+ * @return size_t the position of the comma or npos for the last term
+ */
+size_t termEnd(std::string_view expression) {
+    size_t start = expression.starts_with('-') ? 1 : 0;
+    if ( expression.substr(start, 3) != "re:" ) {
+        return expression.find(',');
+    }
+
+    int braces = 0;
+    bool inBrackets = false;
+    for ( size_t i = start + 3; i < expression.size(); i++ ) {
+        char character = expression[i];
+        if ( character == '\\' ) {
+            i++;
+        } else if ( inBrackets ) {
+            inBrackets = character != ']';
+        } else if ( character == '[' ) {
+            inBrackets = true;
+        } else if ( character == '{' ) {
+            braces++;
+        } else if ( character == '}' && braces > 0 ) {
+            braces--;
+        } else if ( character == ',' && braces == 0 ) {
+            return i;
+        }
+    }
+    return std::string_view::npos;
+}
+
+}
+
+bool TestFilter::globMatch(std::string_view pattern, std::string_view text) {
+    // greedy matching that backtracks to the last star only, linear for typical patterns
+    size_t p = 0;
+    size_t t = 0;
+    size_t star = std::string_view::npos;
+    size_t resume = 0;
+    while ( t < text.size() ) {
+        if ( p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t]) ) {
+            p++;
+            t++;
+        } else if ( p < pattern.size() && pattern[p] == '*' ) {
+            star = p++;
+            resume = t;
+        } else if ( star != std::string_view::npos ) {
+            p = star + 1;
+            t = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while ( p < pattern.size() && pattern[p] == '*' ) {
+        p++;
+    }
+    return p == pattern.size();
+}
+
+bool TestFilter::hasTag(std::string_view tags, std::string_view tag) {
+    for ( size_t start = tags.find('['); start != std::string_view::npos; start = tags.find('[', start + 1) ) {
+        size_t end = tags.find(']', start);
+        if ( end == std::string_view::npos ) {
+            return false;
+        }
+        if ( tags.substr(start + 1, end - start - 1) == tag ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TestFilter::add(std::string_view expression) {
+    while ( true ) {
+        size_t separator = termEnd(expression);
+        std::string_view text = expression.substr(0, separator);
+
+        Term term{Term::KIND::GLOB, false, false, {}, {}};
+        if ( text.starts_with('-') ) {
+            term.exclude = true;
+            text.remove_prefix(1);
+        }
+        if ( text.empty() ) {
+            throw std::invalid_argument("Empty filter term");
+        }
+
+        if ( text.starts_with('[') ) {
+            term.kind = Term::KIND::TAGS;
+        } else if ( text.starts_with("re:") ) {
+            text.remove_prefix(3);
+            term.kind = Term::KIND::REGEX;
+            try {
+                term.regex = std::regex(text.begin(), text.end());
+            } catch ( const std::regex_error& ) {
+                throw std::invalid_argument("Invalid filter regex: " + std::string(text));
+            }
+        }
+        term.pattern = text;
+        term.qualified = term.kind != Term::KIND::TAGS && text.find('/') != std::string_view::npos;
+        mHasIncludes |= !term.exclude;
+        mTerms.push_back(std::move(term));
+
+        if ( separator == std::string_view::npos ) {
+            break;
+        }
+        expression.remove_prefix(separator + 1);
+    }
+}
+
+bool TestFilter::matches(const Term& term, std::string_view collection, std::string_view test, std::string_view tags) {
+    switch ( term.kind ) {
+    case Term::KIND::TAGS: {
+        std::string_view required = term.pattern;
+        for ( size_t start = required.find('['); start != std::string_view::npos; start = required.find('[', start + 1) ) {
+            size_t end = required.find(']', start);
+            if ( end == std::string_view::npos || !hasTag(tags, required.substr(start + 1, end - start - 1)) ) {
+                return false;
+            }
+        }
+        return true;
+    }
+    case Term::KIND::GLOB:
+        if ( term.qualified ) {
+            size_t separator = term.pattern.find('/');
+            return globMatch(std::string_view(term.pattern).substr(0, separator), collection)
+                && globMatch(std::string_view(term.pattern).substr(separator + 1), test);
+        }
+        return globMatch(term.pattern, test);
+    case Term::KIND::REGEX:
+        if ( term.qualified ) {
+            std::string path;
+            path.reserve(collection.size() + 1 + test.size());
+            path.append(collection).append(1, '/').append(test);
+            return std::regex_match(path, term.regex);
+        }
+        return std::regex_match(test.begin(), test.end(), term.regex);
+    }
+    return false;
+}
+
+bool TestFilter::matches(std::string_view collection, std::string_view test, std::string_view tags, std::string_view collectionTags) const {
+    std::string combinedTags;
+    if ( !collectionTags.empty() ) {
+        combinedTags.reserve(tags.size() + collectionTags.size());
+        combinedTags.append(tags).append(collectionTags);
+        tags = combinedTags;
+    }
+
+    bool included = !mHasIncludes;
+    for ( const auto& term : mTerms ) {
+        if ( (term.exclude || !included) && matches(term, collection, test, tags) ) {
+            if ( term.exclude ) {
+                return false;
+            }
+            included = true;
+        }
+    }
+    return included;
+}
+
+} // namespace PidgeonPulse
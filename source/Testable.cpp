@@ -1,18 +1,41 @@
 #include "Testable.hpp"
 
+#include <stdexcept>
+#include <time.h>
+
 namespace PidgeonPulse {
 
+namespace {
+
+/**
+ * @brief Get the CPU time the calling thread used so far
+ *
+ * @return std::chrono::nanoseconds the CPU time
+ */
+std::chrono::nanoseconds thread_cpu_time() {
+    timespec time{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+}
+
+}
+
 Testable::Testable(std::string name)
 : mTestName(name), mState(STATE::NOT_RUN) {}
 
 void Testable::setup(){}
 void Testable::teardown(){}
 
-void Testable::fail(const char* file, int line, bool fatal) {
-    mFailInfos.push_back({file, line, nullptr});
-    mState = mState | STATE::FAIL_BIT;
+void Testable::record_failure(const FailInfo& failInfo, STATE bits, bool fatal) {
+    // private to the run until end_run() claims the result, the watchdog never reads them
+    mRunFailInfos.push(failInfo);
+    mRunState = mRunState | bits;
     if(fatal == true)
-        throw FatalException(file, line);
+        throw FatalException(failInfo.file, failInfo.line);
+}
+
+void Testable::fail(const char* file, int line, bool fatal) {
+    record_failure({file, line, nullptr}, STATE::FAIL_BIT, fatal);
 }
 
 void Testable::fail() {
@@ -20,25 +43,97 @@ void Testable::fail() {
 }
 
 void Testable::fail_with_exception(const char* file, int line, const std::exception_ptr& e, bool fatal) {
-    mState = mState | STATE::FAIL_BIT | STATE::EXCEPTION_BIT;
-    mFailInfos.push_back({file, line, e});
-    if(fatal == true)
-        throw FatalException(file, line);
+    record_failure({file, line, e}, STATE::FAIL_BIT | STATE::EXCEPTION_BIT, fatal);
 }
 
 void Testable::fail_with_exception() {
     fail_with_exception(nullptr,0,std::current_exception(), true);
 }
 
-void Testable::assert_true(bool condition) {
+bool Testable::stop_requested() const {
+    return mStopToken.stop_requested();
+}
+
+const std::stop_token& Testable::get_stop_token() const {
+    return mStopToken;
+}
+
+void Testable::skip() {
+    throw SkipException();
+}
+
+void Testable::mark_skipped() {
+    mFailInfos.clear();
+    mStartTime = std::chrono::high_resolution_clock::now();
+    mEndTime = mStartTime;
+    auto now = TestMetrics::Clock::now();
+    mMetrics.setupStart = mMetrics.runStart = mMetrics.runEnd = mMetrics.teardownEnd = now;
+    mMetrics.cpuTime = std::chrono::nanoseconds::zero();
+    mMetrics.cpuTimeMeasured = false;
+    mMetrics.allocations = {};
+    mMetrics.counters = {};
+    mState = STATE::SKIPPED;
+}
+
+bool Testable::abandon(std::chrono::milliseconds timeout) {
+    // a test that hangs in its teardown times out as well
+    OUTCOME expected = mOutcome;
+    while(expected == OUTCOME::OPEN || expected == OUTCOME::TEARDOWN) {
+        if(mOutcome.compare_exchange_weak(expected, OUTCOME::ABANDONED)) {
+            mark_timed_out(timeout);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Testable::was_abandoned() const {
+    return mOutcome == OUTCOME::ABANDONED;
+}
+
+void Testable::mark_timed_out(std::chrono::milliseconds timeout) {
+    // the start time of a test that may still be running belongs to its thread
+    mEndTime = std::chrono::high_resolution_clock::now();
+    mStartTime = mEndTime - timeout;
+
+    // the phases of the thread that still runs the test are not known
+    auto now = TestMetrics::Clock::now();
+    mMetrics.setupStart = mMetrics.runStart = now - timeout;
+    mMetrics.runEnd = mMetrics.teardownEnd = now;
+    mMetrics.cpuTime = std::chrono::nanoseconds::zero();
+    mMetrics.cpuTimeMeasured = false;
+    mMetrics.allocations = {};
+    mMetrics.counters = {};
+
+    char message[64];
+    std::snprintf(message, sizeof(message), "Test timed out after %lld ms", static_cast<long long>(timeout.count()));
+    mFailInfos.push({nullptr, 0, std::make_exception_ptr(std::runtime_error(message))});
+    mState = STATE::TIMED_OUT;
+}
+
+const char* Testable::source_file(const std::source_location& location) {
+    const char* file = location.file_name();
+    const char* separator = strrchr(file, '/');
+    return separator ? separator + 1 : file;
+}
+
+void Testable::fail_assertion(const std::source_location& location, const char* expression, std::string_view message, bool fatal) {
+    const char* file = source_file(location);
+    int line = static_cast<int>(location.line());
+    // a full list only counts the failure, its text would never be read
+    const char* text = mRunFailInfos.full() ? nullptr : mRunFailInfos.storeText(message);
+    record_failure({file, line, nullptr, expression, text}, STATE::FAIL_BIT, fatal);
+}
+
+void Testable::assert_true(bool condition, std::source_location location) {
     if(condition == false) {
-        fail(__FILENAME__, __LINE__, true);
+        fail_assertion(location, "assert_true(condition)", "false", true);
     }
 }
 
-void Testable::assert_false(bool condition) {
+void Testable::assert_false(bool condition, std::source_location location) {
     if(condition == true) {
-        fail(__FILENAME__, __LINE__, true);
+        fail_assertion(location, "assert_false(condition)", "true", true);
     }
 }
 
@@ -65,26 +160,160 @@ bool Testable::threw_exception() const {
     return static_cast<bool>(mState & STATE::EXCEPTION_BIT);
 }
 
-std::vector<Testable::FailInfo> Testable::get_fail_infos() const {
+bool Testable::was_skipped() const {
+    return mState == STATE::SKIPPED;
+}
+
+bool Testable::timed_out() const {
+    return static_cast<bool>(mState & STATE::TIMEOUT_BIT);
+}
+
+void Testable::set_timeout(std::chrono::milliseconds timeout) {
+    mTimeout = timeout;
+}
+
+std::chrono::milliseconds Testable::get_timeout() const {
+    return mTimeout;
+}
+
+void Testable::reset() {
+    mFailInfos.clear();
+    mMetrics = {};
+    mOutcome = OUTCOME::OPEN;
+    mState = STATE::NOT_RUN;
+}
+
+void Testable::add_tag(std::string_view tag) {
+    mTags += '[';
+    mTags += tag;
+    mTags += ']';
+}
+
+const std::string& Testable::get_tags() const {
+    return mTags;
+}
+
+void Testable::use_fixture(FixtureBase& fixture) {
+    mFixtures.push_back(&fixture);
+}
+
+const std::vector<FixtureBase*>& Testable::get_fixtures() const {
+    return mFixtures;
+}
+
+void Testable::add_dependency(std::string path) {
+    mDependencies.push_back(std::move(path));
+}
+
+const std::vector<std::string>& Testable::get_dependencies() const {
+    return mDependencies;
+}
+
+const TestMetrics& Testable::get_metrics() const {
+    return mMetrics;
+}
+
+VirtualClock& Testable::get_clock() {
+    return mClock;
+}
+
+const FailList& Testable::get_fail_infos() const {
     return mFailInfos;
 }
 
-void Testable::operator()() {
+bool Testable::begin_run(std::stop_token stopToken, RunPhase& phase) {
+    mStopToken = std::move(stopToken);
+    // an abandoned run stays abandoned, the watchdog may have claimed it before it began
+    OUTCOME expected = OUTCOME::FINISHED;
+    mOutcome.compare_exchange_strong(expected, OUTCOME::OPEN);
+    mRunFailInfos.clear();
+    mRunState = STATE::NOT_RUN;
+    mClock.reset();
+
+    // the metrics are only published by the thread that claims the result
+    phase.cpuStart = thread_cpu_time();
+    phase.setupStart = TestMetrics::Clock::now();
     setup();
-    mState = STATE::IN_PROGRESS;
+    if(mOutcome != OUTCOME::OPEN) {
+        // abandoned while setting up
+        teardown();
+        return false;
+    }
+    phase.runStart = TestMetrics::Clock::now();
+    phase.startTime = std::chrono::high_resolution_clock::now();
+    mRunState = STATE::IN_PROGRESS;
+    return true;
+}
 
-    mStartTime = std::chrono::high_resolution_clock::now();
-    try {
-        run();
-    } catch(FatalException& e) {
+void Testable::operator()(std::stop_token stopToken) {
+    VirtualClock::Scope clockScope(mClock);
+    RunPhase phase;
+    if(!begin_run(std::move(stopToken), phase))
+        return;
 
-    } catch(...) {
-        fail_with_exception(__FILENAME__, __LINE__, std::current_exception(), false);
+    std::exception_ptr exception;
+    AllocationStats allocations;
+    PerfStats counters;
+    {
+        AllocationTracker::Scope allocationScope;
+        PerfCounters::Scope perfScope;
+        try {
+            run();
+        } catch(...) {
+            exception = std::current_exception();
+        }
+        counters = perfScope.stats();
+        allocations = allocationScope.stats();
+    }
+    end_run(phase, exception, allocations, counters);
+}
+
+void Testable::end_run(const RunPhase& phase, const std::exception_ptr& exception,
+                       const AllocationStats& allocations, const PerfStats& counters) {
+    auto runEnd = TestMetrics::Clock::now();
+
+    bool skipped = false;
+    if(exception) {
+        try {
+            std::rethrow_exception(exception);
+        } catch(FatalException& e) {
+
+        } catch(SkipException& e) {
+            skipped = true;
+        } catch(...) {
+            fail_with_exception(__FILENAME__, __LINE__, exception, false);
+        }
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    // an abandoned test was already reported as timed out, only the winner publishes
+    OUTCOME expected = OUTCOME::OPEN;
+    if(!mOutcome.compare_exchange_strong(expected, OUTCOME::TEARDOWN)) {
+        teardown();
+        return;
     }
-    
-    mEndTime = std::chrono::high_resolution_clock::now();
-    mState = mState | STATE::READY_BIT;
     teardown();
+    expected = OUTCOME::TEARDOWN;
+    if(!mOutcome.compare_exchange_strong(expected, OUTCOME::FINISHED))
+        return;
+
+    mStartTime = phase.startTime;
+    mEndTime = endTime;
+    mFailInfos.swap(mRunFailInfos);
+    mMetrics.setupStart = phase.setupStart;
+    mMetrics.runStart = phase.runStart;
+    mMetrics.runEnd = runEnd;
+    mMetrics.teardownEnd = TestMetrics::Clock::now();
+    mMetrics.cpuTime = phase.threadBound ? thread_cpu_time() - phase.cpuStart : std::chrono::nanoseconds::zero();
+    mMetrics.cpuTimeMeasured = phase.threadBound;
+    mMetrics.allocations = allocations;
+    mMetrics.counters = counters;
+
+    STATE state = mRunState & (STATE::FAIL_BIT | STATE::EXCEPTION_BIT);
+    if(skipped == true)
+        state = state | STATE::SKIP_BIT;
+    mState = state | STATE::READY_BIT;
 }
 
 Testable::STATE operator&(Testable::STATE a, Testable::STATE b) {
@@ -95,7 +324,7 @@ Testable::STATE operator|(Testable::STATE a, Testable::STATE b) {
     return static_cast<Testable::STATE>(static_cast<uint8_t>(a) | static_cast<uint8_t>(b));
 }
 
-std::string Testable::get_name() const {
+const std::string& Testable::get_name() const {
     return mTestName;
 }
 
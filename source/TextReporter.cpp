@@ -0,0 +1,196 @@
+#include "TextReporter.hpp"
+#include "Benchmark.hpp"
+#include "TestCollection.hpp"
+
+namespace PidgeonPulse {
+
+TextReporter::TextReporter(std::unique_ptr<OutputSink> sink)
+: mOwnedSink(std::move(sink)), mSink(*mOwnedSink) {}
+
+TextReporter::TextReporter(OutputSink& sink): mSink(sink) {}
+
+void TextReporter::writeFailReport(const Testable& test) {
+    mSink.write("\tTest failed: ");
+    mSink.write(test.get_name());
+    mSink.write('\n');
+
+    for ( auto& failInfo : test.get_fail_infos() ) {
+        if ( failInfo.file ) {
+            mSink.write("\t File: ");
+            mSink.write(failInfo.file);
+            mSink.write(':');
+            mSink.writeNumber(static_cast<int64_t>(failInfo.line));
+            mSink.write('\n');
+        }
+        if ( failInfo.expression ) {
+            mSink.write("\t Assertion: ");
+            mSink.write(failInfo.expression);
+            mSink.write('\n');
+        }
+        if ( failInfo.message ) {
+            mSink.write("\t Expanded: ");
+            mSink.write(failInfo.message);
+            mSink.write('\n');
+        }
+        if ( failInfo.exception ) {
+            mSink.write("\t Exception: ");
+            mSink.write(exceptionMessage(failInfo.exception));
+            mSink.write('\n');
+        }
+        mSink.write('\n');
+    }
+
+    if ( test.get_fail_infos().dropped() > 0 ) {
+        mSink.write("\t ");
+        mSink.writeNumber(test.get_fail_infos().dropped());
+        mSink.write(" more failures were not recorded\n\n");
+    }
+    writeCounters(test);
+}
+
+void TextReporter::writeBenchmarkReport(const Benchmark& benchmark) {
+    const BenchmarkStats& stats = benchmark.get_stats();
+
+    mSink.write("\tBenchmark: ");
+    mSink.write(benchmark.get_name());
+    mSink.write("\n\t ns/op: ");
+    mSink.writeNumber(stats.median, 2);
+    mSink.write(" min: ");
+    mSink.writeNumber(stats.min, 2);
+    mSink.write(" median: ");
+    mSink.writeNumber(stats.median, 2);
+    mSink.write(" p99: ");
+    mSink.writeNumber(stats.p99, 2);
+    mSink.write(" stddev: ");
+    mSink.writeNumber(stats.stddev, 2);
+    mSink.write(" (");
+    mSink.writeNumber(static_cast<uint64_t>(stats.samples.size()));
+    mSink.write(" samples of ");
+    mSink.writeNumber(stats.iterations);
+    mSink.write(" iterations)\n");
+    writeCounters(benchmark);
+
+    auto comparison = mComparisons.find(&benchmark);
+    if ( comparison != mComparisons.end() ) {
+        mSink.write("\t Baseline: ");
+        mSink.write(comparison->second.delta() < 0 ? "" : "+");
+        mSink.writeNumber(comparison->second.delta() * 100, 2);
+        mSink.write("% against ");
+        mSink.writeNumber(comparison->second.baseline, 2);
+        mSink.write(" ns/op (p=");
+        mSink.writeNumber(comparison->second.pValue, 4);
+        mSink.write(")\n");
+        mComparisons.erase(comparison);
+    }
+}
+
+void TextReporter::writeCounters(const Testable& test) {
+    const PerfStats& counters = test.get_metrics().counters;
+    if ( !counters.measured ) {
+        return;
+    }
+    mSink.write("\t Counters: IPC ");
+    mSink.writeNumber(counters.ipc(), 2);
+    mSink.write(", ");
+    mSink.writeNumber(counters.perKiloInstruction(counters.cacheMisses), 2);
+    mSink.write(" cache and ");
+    mSink.writeNumber(counters.perKiloInstruction(counters.branchMisses), 2);
+    mSink.write(" branch misses per 1000 of ");
+    mSink.writeNumber(counters.instructions);
+    mSink.write(" instructions\n");
+}
+
+void TextReporter::runStarting() {
+    mSink.write("PidgeonPulse Unit Test:\n");
+}
+
+void TextReporter::testFinished(const TestCollection& collection, const Testable& test) {
+    if ( test.was_skipped() ) {
+        return;
+    }
+    if ( !test.get_result() || dynamic_cast<const Benchmark*>(&test) ) {
+        mNotableTests[&collection].push_back(&test);
+    }
+}
+
+void TextReporter::baselineCompared(const TestCollection&, const Testable& test, const BaselineComparison& comparison) {
+    // only benchmarks show their comparison, regressed tests fail with it
+    if ( test.get_result() && dynamic_cast<const Benchmark*>(&test) ) {
+        mComparisons[&test] = comparison;
+    }
+}
+
+void TextReporter::collectionFinished(const TestCollection& collection, const TestStats& stats) {
+    mSink.write("Test Collection: ");
+    mSink.write(collection.getName());
+    mSink.write('\n');
+
+    auto notable = mNotableTests.find(&collection);
+    if ( notable != mNotableTests.end() ) {
+        for ( auto test : notable->second ) {
+            if ( !test->get_result() ) {
+                writeFailReport(*test);
+            } else {
+                writeBenchmarkReport(static_cast<const Benchmark&>(*test));
+            }
+        }
+        mNotableTests.erase(notable);
+    }
+
+    mSink.write("Stats: failed ");
+    mSink.writeNumber(static_cast<uint64_t>(stats.failed));
+    mSink.write(" of ");
+    mSink.writeNumber(static_cast<uint64_t>(stats.total));
+    mSink.write(" tests");
+    if ( stats.skipped > 0 ) {
+        mSink.write(", skipped ");
+        mSink.writeNumber(static_cast<uint64_t>(stats.skipped));
+    }
+    mSink.write('\n');
+    mSink.flush();
+}
+
+void TextReporter::repeatFinished(const std::vector<RepeatStats>& results, size_t repetitions, uint64_t seed) {
+    mSink.write("Repeated ");
+    mSink.writeNumber(static_cast<uint64_t>(repetitions));
+    mSink.write(" times with seed ");
+    mSink.writeNumber(seed);
+    mSink.write(":\n");
+
+    uint64_t flaky = 0;
+    uint64_t failing = 0;
+    for ( auto& result : results ) {
+        if ( result.failed == 0 ) {
+            continue;
+        }
+        if ( result.isFlaky() ) {
+            flaky++;
+            mSink.write("\tFlaky: ");
+        } else {
+            failing++;
+            mSink.write("\tFailing: ");
+        }
+        mSink.write(result.collection->getName());
+        mSink.write('/');
+        mSink.write(result.test->get_name());
+        mSink.write(" passed ");
+        mSink.writeNumber(result.passRate() * 100, 2);
+        mSink.write("% of ");
+        mSink.writeNumber(static_cast<uint64_t>(result.runs - result.skipped));
+        mSink.write(" runs\n");
+    }
+
+    mSink.write("Stats: ");
+    mSink.writeNumber(flaky);
+    mSink.write(" flaky, ");
+    mSink.writeNumber(failing);
+    mSink.write(" failing of ");
+    mSink.writeNumber(static_cast<uint64_t>(results.size()));
+    mSink.write(" tests\n");
+}
+
+void TextReporter::runFinished(const TestStats&) {
+    mSink.flush();
+}
+
+} // namespace PidgeonPulse
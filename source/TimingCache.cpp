@@ -0,0 +1,120 @@
+#include "TimingCache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace PidgeonPulse {
+
+namespace {
+
+constexpr char MAGIC[4] = {'P', 'P', 'T', 'C'};
+constexpr uint32_t VERSION = 1;
+
+#pragma pack(push, 1)
+struct Entry {
+    uint64_t key;
+    float seconds;
+};
+#pragma pack(pop)
+
+}
+
+uint64_t TimingCache::key(std::string_view collection, std::string_view test) {
+    // FNV-1a, with a separator so "a" "bc" and "ab" "c" differ
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto add = [&hash](unsigned char byte) {
+        hash ^= byte;
+        hash *= 0x100000001b3ull;
+    };
+    for ( char character : collection ) add(static_cast<unsigned char>(character));
+    add(0);
+    for ( char character : test ) add(static_cast<unsigned char>(character));
+    return hash;
+}
+
+bool TimingCache::load(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if ( file == nullptr ) {
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    uint64_t count = 0;
+    bool valid = std::fread(magic, sizeof(magic), 1, file) == 1
+        && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0
+        && std::fread(&version, sizeof(version), 1, file) == 1
+        && version == VERSION
+        && std::fread(&count, sizeof(count), 1, file) == 1;
+
+    // a corrupt count must not allocate more entries than the file holds
+    if ( valid ) {
+        long position = std::ftell(file);
+        valid = position >= 0 && std::fseek(file, 0, SEEK_END) == 0;
+        long end = valid ? std::ftell(file) : -1;
+        valid = valid && end >= position && std::fseek(file, position, SEEK_SET) == 0
+            && count <= static_cast<uint64_t>(end - position) / sizeof(Entry);
+    }
+
+    std::vector<Entry> entries;
+    if ( valid ) {
+        entries.resize(count);
+        valid = std::fread(entries.data(), sizeof(Entry), count, file) == count;
+    }
+    std::fclose(file);
+
+    if ( !valid ) {
+        return false;
+    }
+
+    mDurations.reserve(mDurations.size() + entries.size());
+    for ( auto& entry : entries ) {
+        mDurations[entry.key] = entry.seconds;
+    }
+    return true;
+}
+
+bool TimingCache::save(const std::string& path) const {
+    std::string temporaryPath = path + ".tmp";
+    std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+    if ( file == nullptr ) {
+        return false;
+    }
+
+    std::vector<Entry> entries;
+    entries.reserve(mDurations.size());
+    for ( auto& [key, seconds] : mDurations ) {
+        entries.push_back({key, seconds});
+    }
+
+    uint64_t count = entries.size();
+    bool written = std::fwrite(MAGIC, sizeof(MAGIC), 1, file) == 1
+        && std::fwrite(&VERSION, sizeof(VERSION), 1, file) == 1
+        && std::fwrite(&count, sizeof(count), 1, file) == 1
+        && std::fwrite(entries.data(), sizeof(Entry), count, file) == count;
+    written = std::fclose(file) == 0 && written;
+
+    if ( !written || std::rename(temporaryPath.c_str(), path.c_str()) != 0 ) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+void TimingCache::record(uint64_t key, double seconds) {
+    auto [entry, inserted] = mDurations.try_emplace(key, static_cast<float>(seconds));
+    if ( !inserted ) {
+        entry->second = static_cast<float>((entry->second + seconds) / 2);
+    }
+}
+
+std::optional<double> TimingCache::lookup(uint64_t key) const {
+    auto entry = mDurations.find(key);
+    if ( entry == mDurations.end() ) {
+        return std::nullopt;
+    }
+    return entry->second;
+}
+
+} // namespace PidgeonPulse
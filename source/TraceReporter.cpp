@@ -0,0 +1,140 @@
+#include "TraceReporter.hpp"
+#include "TestCollection.hpp"
+
+#include <string>
+
+namespace PidgeonPulse {
+
+TraceReporter::TraceReporter(std::unique_ptr<OutputSink> sink)
+: mOwnedSink(std::move(sink)), mSink(*mOwnedSink) {}
+
+TraceReporter::TraceReporter(OutputSink& sink): mSink(sink) {}
+
+void TraceReporter::beginEvent() {
+    mSink.write(mFirstEvent ? "\n" : ",\n");
+    mFirstEvent = false;
+}
+
+void TraceReporter::writeTimestamp(Clock::time_point time) {
+    std::chrono::duration<double, std::micro> offset = time - mRunStart;
+    mSink.writeNumber(offset.count(), 3);
+}
+
+void TraceReporter::writeHeader(std::string_view name, std::string_view category, std::string_view phase, size_t track, Clock::time_point time) {
+    beginEvent();
+    mSink.write("{\"name\":");
+    mSink.writeJsonString(name);
+    mSink.write(",\"cat\":\"");
+    mSink.write(category);
+    mSink.write("\",\"ph\":\"");
+    mSink.write(phase);
+    mSink.write("\",\"pid\":1,\"tid\":");
+    mSink.writeNumber(static_cast<uint64_t>(track));
+    mSink.write(",\"ts\":");
+    writeTimestamp(time);
+}
+
+void TraceReporter::writeComplete(std::string_view name, std::string_view category, size_t track, Clock::time_point start, Clock::time_point end) {
+    writeHeader(name, category, "X", track, start);
+    mSink.write(",\"dur\":");
+    mSink.writeNumber(std::chrono::duration<double, std::micro>(end - start).count(), 3);
+    mSink.write('}');
+}
+
+void TraceReporter::nameTrack(size_t track) {
+    if ( track < mNamedTracks.size() && mNamedTracks[track] ) {
+        return;
+    }
+    if ( track >= mNamedTracks.size() ) {
+        mNamedTracks.resize(track + 1, false);
+    }
+    mNamedTracks[track] = true;
+
+    beginEvent();
+    mSink.write("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+    mSink.writeNumber(static_cast<uint64_t>(track));
+    mSink.write(",\"args\":{\"name\":");
+    mSink.writeJsonString(track == 0 ? "controller" : "worker " + std::to_string(track - 1));
+    mSink.write("}}");
+}
+
+void TraceReporter::runStarting() {
+    mRunStart = Clock::now();
+    mMainThread = std::this_thread::get_id();
+    mNamedTracks.clear();
+    mFirstEvent = true;
+    mSink.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    nameTrack(0);
+}
+
+void TraceReporter::testFinished(const TestCollection& collection, const Testable& test) {
+    const TestMetrics& metrics = test.get_metrics();
+    size_t track = metrics.worker + 1;
+    nameTrack(track);
+
+    if ( metrics.queued != Clock::time_point() ) {
+        // async events get their own rows, queue waits overlap the previous test of the worker
+        uint64_t id = mNextQueueId++;
+        writeHeader(test.get_name(), "queue", "b", track, metrics.queued);
+        mSink.write(",\"id\":");
+        mSink.writeNumber(id);
+        mSink.write('}');
+        writeHeader(test.get_name(), "queue", "e", track, metrics.setupStart);
+        mSink.write(",\"id\":");
+        mSink.writeNumber(id);
+        mSink.write('}');
+    }
+
+    writeHeader(test.get_name(), "test", "X", track, metrics.setupStart);
+    mSink.write(",\"dur\":");
+    mSink.writeNumber(std::chrono::duration<double, std::micro>(metrics.teardownEnd - metrics.setupStart).count(), 3);
+    mSink.write(",\"args\":{\"collection\":");
+    mSink.writeJsonString(collection.getName());
+    mSink.write(",\"result\":\"");
+    if ( test.was_skipped() ) {
+        mSink.write("skipped");
+    } else {
+        mSink.write(test.get_result() ? "passed" : "failed");
+    }
+    mSink.write("\",\"queue_ms\":");
+    mSink.writeNumber(std::chrono::duration<double, std::milli>(metrics.queueWait()).count(), 3);
+    // metrics that were not measured are left out rather than reported as 0
+    if ( metrics.cpuTimeMeasured ) {
+        mSink.write(",\"cpu_ms\":");
+        mSink.writeNumber(std::chrono::duration<double, std::milli>(metrics.cpuTime).count(), 3);
+    }
+    if ( metrics.allocations.measured ) {
+        mSink.write(",\"allocations\":");
+        mSink.writeNumber(metrics.allocations.allocations);
+        mSink.write(",\"peak_bytes\":");
+        mSink.writeNumber(metrics.allocations.peakBytes);
+    }
+    if ( metrics.counters.measured ) {
+        mSink.write(",\"instructions\":");
+        mSink.writeNumber(metrics.counters.instructions);
+        mSink.write(",\"ipc\":");
+        mSink.writeNumber(metrics.counters.ipc(), 3);
+        mSink.write(",\"cache_mpki\":");
+        mSink.writeNumber(metrics.counters.perKiloInstruction(metrics.counters.cacheMisses), 3);
+        mSink.write(",\"branch_mpki\":");
+        mSink.writeNumber(metrics.counters.perKiloInstruction(metrics.counters.branchMisses), 3);
+    }
+    mSink.write("}}");
+
+    writeComplete("setup", "phase", track, metrics.setupStart, metrics.runStart);
+    writeComplete("run", "phase", track, metrics.runStart, metrics.runEnd);
+    writeComplete("teardown", "phase", track, metrics.runEnd, metrics.teardownEnd);
+
+    if ( metrics.reportStart != Clock::time_point() ) {
+        // results are reported by the worker itself in thread mode and by the controller otherwise
+        size_t reportTrack = std::this_thread::get_id() == mMainThread ? 0 : track;
+        writeComplete("report", "report", reportTrack, metrics.reportStart, Clock::now());
+    }
+}
+
+void TraceReporter::runFinished(const TestStats&) {
+    mSink.write("\n]}\n");
+    mSink.flush();
+}
+
+} // namespace PidgeonPulse
@@ -0,0 +1,113 @@
+#include "VirtualClock.hpp"
+
+#include <algorithm>
+
+namespace PidgeonPulse {
+
+namespace {
+
+thread_local VirtualClock* tCurrentClock = nullptr;
+
+}
+
+SimulatedClock::time_point SimulatedClock::now() {
+    return tCurrentClock ? tCurrentClock->now() : time_point();
+}
+
+VirtualClock::Scope::Scope(VirtualClock& clock): mPrevious(tCurrentClock) {
+    tCurrentClock = &clock;
+}
+
+VirtualClock::Scope::~Scope() {
+    tCurrentClock = mPrevious;
+}
+
+bool VirtualClock::fireNext(TimePoint limit) {
+    Callback callback;
+    {
+        std::lock_guard lock(mMutex);
+        if ( mTimers.empty() || mTimers.begin()->first.first > limit ) {
+            return false;
+        }
+        auto timer = mTimers.begin();
+        mNow = std::max(mNow, timer->first.first);
+        mDeadlines.erase(timer->first.second);
+        callback = std::move(timer->second);
+        mTimers.erase(timer);
+    }
+    // outside of the lock, the callback may use the clock
+    callback();
+    return true;
+}
+
+VirtualClock::TimePoint VirtualClock::now() const {
+    std::lock_guard lock(mMutex);
+    return mNow;
+}
+
+size_t VirtualClock::advance(Duration duration) {
+    return advanceTo(now() + duration);
+}
+
+size_t VirtualClock::advanceTo(TimePoint time) {
+    size_t fired = 0;
+    while ( fireNext(time) ) {
+        fired++;
+    }
+    std::lock_guard lock(mMutex);
+    mNow = std::max(mNow, time);
+    return fired;
+}
+
+void VirtualClock::sleepUntil(TimePoint time) {
+    advanceTo(time);
+}
+
+VirtualClock::TimerId VirtualClock::callAt(TimePoint time, Callback callback) {
+    std::lock_guard lock(mMutex);
+    TimerId id = mNextId++;
+    mTimers.emplace(std::make_pair(time, id), std::move(callback));
+    mDeadlines.emplace(id, time);
+    return id;
+}
+
+bool VirtualClock::cancel(TimerId id) {
+    std::lock_guard lock(mMutex);
+    auto deadline = mDeadlines.find(id);
+    if ( deadline == mDeadlines.end() ) {
+        return false;
+    }
+    mTimers.erase({deadline->second, id});
+    mDeadlines.erase(deadline);
+    return true;
+}
+
+bool VirtualClock::runNext() {
+    return fireNext(TimePoint::max());
+}
+
+size_t VirtualClock::runAll(size_t limit) {
+    size_t fired = 0;
+    while ( fired < limit && runNext() ) {
+        fired++;
+    }
+    return fired;
+}
+
+size_t VirtualClock::pendingTimers() const {
+    std::lock_guard lock(mMutex);
+    return mTimers.size();
+}
+
+void VirtualClock::reset() {
+    std::lock_guard lock(mMutex);
+    mNow = TimePoint();
+    mTimers.clear();
+    mDeadlines.clear();
+}
+
+VirtualClock* VirtualClock::current() {
+    return tCurrentClock;
+}
+
+} // namespace PidgeonPulse
@@ -0,0 +1,98 @@
+#include "Watchdog.hpp"
+
+#include <algorithm>
+
+namespace PidgeonPulse {
+
+Watchdog::Watchdog(Clock::duration tick)
+: mTick(tick), mStart(Clock::now()) {
+    if ( mTick <= Clock::duration::zero() ) {
+        mTick = std::chrono::milliseconds(1);
+    }
+    mThread = std::thread(&Watchdog::run, this);
+}
+
+Watchdog::~Watchdog() {
+    {
+        std::lock_guard lock(mMutex);
+        mStopping = true;
+    }
+    mCondition.notify_all();
+    mThread.join();
+}
+
+uint64_t Watchdog::tickOf(Clock::time_point time) const {
+    auto elapsed = time - mStart;
+    return static_cast<uint64_t>((elapsed + mTick - Clock::duration(1)) / mTick);
+}
+
+Watchdog::TimerId Watchdog::arm(Clock::duration timeout, Callback callback) {
+    uint64_t expiryTick = tickOf(Clock::now() + timeout);
+
+    std::unique_lock lock(mMutex);
+    bool wasIdle = mTimers.empty();
+    if ( wasIdle ) {
+        // the wheel stood still while idle, continue from the current time
+        mCurrentTick = std::max(mCurrentTick, tickOf(Clock::now()));
+    }
+    expiryTick = std::max(expiryTick, mCurrentTick);
+
+    TimerId id = mNextId++;
+    mTimers.emplace(id, Timer{expiryTick, std::move(callback)});
+    mSlots[expiryTick % SLOT_COUNT].push_back(id);
+    lock.unlock();
+
+    if ( wasIdle ) {
+        mCondition.notify_all();
+    }
+    return id;
+}
+
+bool Watchdog::disarm(TimerId id) {
+    // the id stays in its slot and is dropped when the wheel passes it
+    std::lock_guard lock(mMutex);
+    return mTimers.erase(id) > 0;
+}
+
+void Watchdog::run() {
+    std::vector<Callback> expired;
+    std::unique_lock lock(mMutex);
+    while ( true ) {
+        mCondition.wait(lock, [this]() { return mStopping || !mTimers.empty(); });
+        if ( mStopping ) {
+            return;
+        }
+
+        auto tickTime = mStart + mTick * mCurrentTick;
+        if ( mCondition.wait_until(lock, tickTime, [this]() { return mStopping; }) ) {
+            return;
+        }
+
+        auto& slot = mSlots[mCurrentTick % SLOT_COUNT];
+        auto remaining = std::remove_if(slot.begin(), slot.end(), [this, &expired](TimerId id) {
+            auto timer = mTimers.find(id);
+            if ( timer == mTimers.end() ) {
+                return true;
+            }
+            if ( timer->second.expiryTick > mCurrentTick ) {
+                return false;
+            }
+            expired.push_back(std::move(timer->second.callback));
+            mTimers.erase(timer);
+            return true;
+        });
+        slot.erase(remaining, slot.end());
+        mCurrentTick++;
+
+        if ( !expired.empty() ) {
+            lock.unlock();
+            for ( auto& callback : expired ) {
+                callback();
+            }
+            expired.clear();
+            lock.lock();
+        }
+    }
+}
+
+} // namespace PidgeonPulse
@@ -0,0 +1,38 @@
+#include "TestController.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace PidgeonPulse;
+
+// defined by the test binary, releases the test and tells that it returned
+extern "C" std::atomic<bool> pidgeonPulsePluginRelease;
+extern "C" std::atomic<bool> pidgeonPulsePluginReturned;
+
+namespace {
+
+class HangingPluginTest : public Testable {
+public:
+    using Testable::Testable;
+
+    void run() override {
+        while ( !pidgeonPulsePluginRelease ) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    void teardown() override {
+        pidgeonPulsePluginReturned = true;
+        pidgeonPulsePluginReturned.notify_all();
+    }
+};
+
+const bool registered = [] {
+    TestCollection& collection = TestController::addTestCollection("Hanging Plugin");
+    collection.addTest(std::make_unique<HangingPluginTest>("hanging test"));
+    return true;
+}();
+
+}
@@ -0,0 +1,31 @@
+#include "TestController.hpp"
+
+#include <memory>
+
+using namespace PidgeonPulse;
+
+// defined by the test binary, counts how often this module was loaded
+extern "C" int pidgeonPulsePluginLoads;
+
+namespace {
+
+class PluginTest : public Testable {
+public:
+    using Testable::Testable;
+
+    void run() override {
+        assert_eq(1 + 1, 2);
+    }
+};
+
+const bool registered = [] {
+    pidgeonPulsePluginLoads++;
+    TestCollection& collection = TestController::addTestCollection("Plugin");
+    collection.addTag("plugin");
+    collection.addTest(std::make_unique<PluginTest>("loaded test"));
+    return true;
+}();
+
+}
+
+PIDGEON_PULSE_REGISTER_TEST(PluginTest, "Plugin Registry", "registered test", "[plugin]");
@@ -0,0 +1,28 @@
+#include "TestController.hpp"
+
+using namespace PidgeonPulse;
+
+// the tests of the runner the exit status tests start, the runner main comes from the library
+namespace {
+
+class PassingTest : public Testable {
+public:
+    using Testable::Testable;
+    void run() override { assert_true(true); }
+};
+
+class FailingTest : public Testable {
+public:
+    using Testable::Testable;
+    void run() override { assert_eq(1, 2); }
+};
+
+TestCollection& collection = TestController::addTestCollection("Runner");
+
+int registered = []() {
+    collection.addTest(new PassingTest("passing"));
+    collection.addTest(new FailingTest("failing"));
+    return 0;
+}();
+
+}
@@ -0,0 +1,161 @@
+#include <catch2/catch.hpp>
+#include "AllocationTracker.hpp"
+#include "Benchmark.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace PidgeonPulse;
+
+namespace {
+
+class Leaking : public Testable {
+public:
+    std::vector<int*> leaked;
+
+    Leaking(): Testable("leaking") {}
+
+    void run() override {
+        for ( int i = 0; i < 3; i++ ) {
+            leaked.push_back(new int(i));
+        }
+        do_not_optimize(leaked);
+    }
+
+    ~Leaking() override {
+        for ( int* value : leaked ) {
+            delete value;
+        }
+    }
+};
+
+class AllocationAssertions : public Testable {
+private:
+    uint64_t mLimit;
+
+public:
+    AllocationAssertions(uint64_t limit): Testable("assertions"), mLimit(limit) {}
+
+    void run() override {
+        assert_no_allocations([]() {
+            int value = 42;
+            do_not_optimize(value);
+        });
+        assert_max_allocations(mLimit, []() {
+            for ( int i = 0; i < 2; i++ ) {
+                auto value = std::make_unique<int>(i);
+                do_not_optimize(value);
+            }
+        });
+    }
+};
+
+class ManyFailures : public Testable {
+private:
+    std::string mMessage = std::string(FailList::MAX_TEXT_SIZE, 'x');
+
+public:
+    ManyFailures(): Testable("many failures") {}
+
+    void run() override {
+        // more text than an arena block holds, so the thread takes new blocks
+        for ( int i = 0; i < 20; i++ ) {
+            fail_assertion(std::source_location::current(), "expression", mMessage, false);
+        }
+    }
+};
+
+}
+
+TEST_CASE("Test AllocationTracker", "[Allocation]") {
+    if ( !AllocationTracker::available() ) {
+        SUCCEED("the library was built without allocation tracking");
+        return;
+    }
+
+    SECTION("Counts allocations and leaks") {
+        AllocationStats stats;
+        int* leaked = nullptr;
+        {
+            AllocationTracker::Scope scope;
+            auto freed = std::make_unique<std::vector<char>>(1000);
+            do_not_optimize(freed);
+            freed.reset();
+            leaked = new int(1);
+            do_not_optimize(leaked);
+            stats = scope.stats();
+        }
+        delete leaked;
+
+        REQUIRE(stats.allocations == 3);
+        REQUIRE(stats.deallocations == 2);
+        REQUIRE(stats.allocatedBytes >= 1000 + sizeof(int));
+        REQUIRE(stats.peakBytes >= 1000);
+        REQUIRE(stats.leakedBytes() >= static_cast<int64_t>(sizeof(int)));
+        REQUIRE(stats.leakedBytes() < 1000);
+    }
+
+    SECTION("Nested scopes see their own allocations") {
+        AllocationStats outer;
+        AllocationStats inner;
+        {
+            AllocationTracker::Scope outerScope;
+            auto first = std::make_unique<std::vector<char>>(4096);
+            do_not_optimize(first);
+            {
+                AllocationTracker::Scope innerScope;
+                auto second = std::make_unique<int>(2);
+                do_not_optimize(second);
+                inner = innerScope.stats();
+            }
+            outer = outerScope.stats();
+        }
+
+        REQUIRE(inner.allocations == 1);
+        REQUIRE(inner.peakBytes < 4096);
+        REQUIRE(outer.allocations == 3);
+        REQUIRE(outer.peakBytes >= 4096);
+    }
+
+    SECTION("Records the allocations of a test run") {
+        Leaking test;
+        test();
+        const AllocationStats& stats = test.get_metrics().allocations;
+        REQUIRE(stats.measured);
+        REQUIRE(stats.allocations >= 3);
+        REQUIRE(stats.leakedBytes() >= static_cast<int64_t>(3 * sizeof(int)));
+    }
+
+    SECTION("Does not count the recorded failures against the test") {
+        ManyFailures test;
+        test();
+        REQUIRE(test.get_fail_infos().size() == 20);
+        REQUIRE(test.get_metrics().allocations.allocations == 0);
+        REQUIRE(test.get_metrics().allocations.leakedBytes() == 0);
+    }
+
+    SECTION("Asserts the number of allocations") {
+        AllocationAssertions passing(2);
+        passing();
+        REQUIRE(passing.get_result());
+
+        AllocationAssertions failing(1);
+        failing();
+        REQUIRE_FALSE(failing.get_result());
+        REQUIRE(std::string(failing.get_fail_infos()[0].message).starts_with("2 allocations of "));
+    }
+}
+
+TEST_CASE("Test allocation assertions without tracking", "[Allocation]") {
+    if ( AllocationTracker::available() ) {
+        SUCCEED("the library was built with allocation tracking");
+        return;
+    }
+
+    // nothing can be checked, the assertions neither fail nor skip the test
+    AllocationAssertions assertions(0);
+    assertions();
+    REQUIRE(assertions.get_result());
+    REQUIRE_FALSE(assertions.get_metrics().allocations.measured);
+}
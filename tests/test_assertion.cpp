@@ -0,0 +1,119 @@
+#include <catch2/catch.hpp>
+#include "Testable.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace PidgeonPulse;
+
+namespace {
+
+int gFormatCount = 0;
+
+struct Counted {
+    int value;
+    bool operator==(const Counted& other) const { return value == other.value; }
+};
+
+std::ostream& operator<<(std::ostream& os, const Counted& counted) {
+    gFormatCount++;
+    return os << "Counted(" << counted.value << ")";
+}
+
+struct Opaque {
+    bool operator==(const Opaque&) const { return false; }
+};
+
+class AssertionTest : public Testable {
+public:
+    int passingAsserts = 0;
+    int line = 0;
+    bool continued = false;
+
+    using Testable::Testable;
+
+    void run() override {
+        for ( int i = 0; i < 1000; i++ ) {
+            PP_ASSERT(Counted{i} == Counted{i});
+            passingAsserts++;
+        }
+        line = __LINE__ + 1;
+        PP_CHECK(Counted{1} == Counted{2});
+        continued = true;
+        assert_eq(std::string("left"), std::string("right"));
+    }
+};
+
+class FlakyLoopTest : public Testable {
+public:
+    using Testable::Testable;
+
+    void run() override {
+        for ( size_t i = 0; i < FailList::MAX_RECORDED + 100; i++ ) {
+            PP_CHECK(Counted{0} == Counted{1});
+        }
+    }
+};
+
+}
+
+TEST_CASE("Test stringify", "[Assertion]") {
+    REQUIRE(stringify(42) == "42");
+    REQUIRE(stringify(-1.5) == "-1.5");
+    REQUIRE(stringify(true) == "true");
+    REQUIRE(stringify('x') == "'x'");
+    REQUIRE(stringify("text") == "\"text\"");
+    REQUIRE(stringify(std::string("text")) == "\"text\"");
+    REQUIRE(stringify(static_cast<const char*>(nullptr)) == "nullptr");
+    REQUIRE(stringify(std::vector<int>{1, 2, 3}) == "{ 1, 2, 3 }");
+    REQUIRE(stringify(std::vector<int>{}) == "{}");
+    REQUIRE(stringify(Opaque{}) == "{?}");
+}
+
+TEST_CASE("Test decomposed assertions", "[Assertion]") {
+    gFormatCount = 0;
+    AssertionTest test("assertions");
+    test();
+
+    REQUIRE_FALSE(test.get_result());
+    REQUIRE(test.passingAsserts == 1000);
+    REQUIRE(test.continued);
+    // operands are only formatted for the failed check
+    REQUIRE(gFormatCount == 2);
+
+    auto& failInfos = test.get_fail_infos();
+    REQUIRE(failInfos.size() == 2);
+
+    REQUIRE(std::string(failInfos[0].file) == "test_assertion.cpp");
+    REQUIRE(failInfos[0].line == test.line);
+    REQUIRE(std::string(failInfos[0].expression) == "Counted{1} == Counted{2}");
+    REQUIRE(std::string(failInfos[0].message) == "Counted(1) == Counted(2)");
+
+    REQUIRE(std::string(failInfos[1].file) == "test_assertion.cpp");
+    REQUIRE(std::string(failInfos[1].message) == "\"left\" == \"right\"");
+}
+
+TEST_CASE("Test failures beyond the maximum are not formatted", "[Assertion]") {
+    FlakyLoopTest test("flaky loop");
+    for ( int run = 0; run < 2; run++ ) {
+        gFormatCount = 0;
+        test.reset();
+        test();
+
+        REQUIRE(test.get_fail_infos().size() == FailList::MAX_RECORDED);
+        REQUIRE(test.get_fail_infos().dropped() == 100);
+        REQUIRE(gFormatCount == 2 * static_cast<int>(FailList::MAX_RECORDED));
+    }
+}
+
+TEST_CASE("Test MessageBuffer", "[Assertion]") {
+    MessageBuffer buffer;
+    stringify(buffer, std::vector<int>{1, 2});
+    REQUIRE(buffer.text() == "{ 1, 2 }");
+
+    MessageBuffer full;
+    std::string text(MessageBuffer::CAPACITY * 2, 'x');
+    full.append(text);
+    REQUIRE(full.text().size() == MessageBuffer::CAPACITY);
+    REQUIRE(full.text().ends_with("..."));
+}
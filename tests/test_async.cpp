@@ -0,0 +1,186 @@
+#include <catch2/catch.hpp>
+#include "AsyncTest.hpp"
+#include "TestController.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace PidgeonPulse;
+
+namespace {
+
+Task<int> add(int a, int b) {
+    co_await yield_now();
+    co_return a + b;
+}
+
+class IoTest : public AsyncTest {
+private:
+    int mExpected;
+
+public:
+    IoTest(std::string name, int expected = 42): AsyncTest(std::move(name)), mExpected(expected) {}
+
+    Task<> run_async() override {
+        int value = co_await simulate_io(std::chrono::milliseconds(5), 40);
+        value = co_await add(value, 2);
+        assert_eq(value, mExpected);
+    }
+};
+
+class ThrowingTest : public AsyncTest {
+public:
+    using AsyncTest::AsyncTest;
+
+    Task<> run_async() override {
+        co_await yield_now();
+        throw std::runtime_error("broken");
+    }
+};
+
+class SkippingTest : public AsyncTest {
+public:
+    using AsyncTest::AsyncTest;
+
+    Task<> run_async() override {
+        co_await sleep_for(std::chrono::milliseconds(1));
+        skip();
+    }
+};
+
+class CompletionTest : public AsyncTest {
+public:
+    using AsyncTest::AsyncTest;
+
+    Task<> run_async() override {
+        Completion<std::string> completion;
+        std::thread producer([&completion]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            completion.set("done");
+        });
+        std::string value = co_await completion;
+        producer.join();
+        assert_eq(value, std::string("done"));
+    }
+};
+
+class SleepingTest : public AsyncTest {
+public:
+    using AsyncTest::AsyncTest;
+
+    Task<> run_async() override {
+        co_await sleep_for(std::chrono::milliseconds(50));
+        assert_true(true);
+    }
+};
+
+class ClockTest : public AsyncTest {
+public:
+    bool sawOwnClock = true;
+
+    using AsyncTest::AsyncTest;
+
+    Task<> run_async() override {
+        sawOwnClock = sawOwnClock && VirtualClock::current() == &get_clock();
+        co_await sleep_for(std::chrono::milliseconds(1));
+        sawOwnClock = sawOwnClock && VirtualClock::current() == &get_clock();
+        co_await yield_now();
+        sawOwnClock = sawOwnClock && VirtualClock::current() == &get_clock();
+        get_clock().sleepFor(std::chrono::hours(1));
+        assert_true(get_clock().now().time_since_epoch() == std::chrono::hours(1));
+    }
+};
+
+}
+
+TEST_CASE("Test AsyncTest", "[Async]") {
+    SECTION("Runs a coroutine body when called directly") {
+        IoTest test("io");
+        test();
+        REQUIRE(test.get_result());
+        REQUIRE(test.get_duration() >= std::chrono::milliseconds(5));
+    }
+
+    SECTION("Records failed assertions") {
+        IoTest test("io", 43);
+        test();
+        REQUIRE_FALSE(test.get_result());
+        REQUIRE(test.get_fail_infos().size() == 1);
+    }
+
+    SECTION("Records exceptions and skips") {
+        ThrowingTest throwing("throwing");
+        throwing();
+        REQUIRE_FALSE(throwing.get_result());
+        REQUIRE_THROWS_WITH(std::rethrow_exception(throwing.get_fail_infos()[0].exception), "broken");
+
+        SkippingTest skipping("skipping");
+        skipping();
+        REQUIRE(skipping.was_skipped());
+    }
+
+    SECTION("Resumes on a completion set by another thread") {
+        CompletionTest test("completion");
+        test();
+        REQUIRE(test.get_result());
+    }
+}
+
+TEST_CASE("Test async tests share the workers", "[Async]") {
+    constexpr size_t TEST_COUNT = 2000;
+    TestController::setWorkerCount(2);
+
+    TestCollection collection("Async Collection");
+    std::vector<std::unique_ptr<SleepingTest>> tests;
+    for ( size_t i = 0; i < TEST_COUNT; i++ ) {
+        tests.push_back(std::make_unique<SleepingTest>("sleeping " + std::to_string(i)));
+        collection.addTest(tests.back().get());
+    }
+    IoTest failing("failing", 0);
+    collection.addTest(&failing);
+
+    auto start = std::chrono::steady_clock::now();
+    collection.runTests();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    TestController::setWorkerCount(0);
+
+    // two workers sleeping one test after the other would take 50 seconds
+    REQUIRE(elapsed < std::chrono::seconds(10));
+    for ( auto& test : tests ) {
+        REQUIRE(test->get_result());
+    }
+    REQUIRE_FALSE(failing.get_result());
+}
+
+TEST_CASE("Test async tests on the workers", "[Async]") {
+    TestController::setWorkerCount(2);
+
+    TestCollection collection("Async Clock Collection");
+    ClockTest first("first");
+    ClockTest second("second");
+    collection.addTest(&first);
+    collection.addTest(&second);
+    collection.runTests();
+
+    TestController::setWorkerCount(0);
+
+    SECTION("Every resume sees the clock of its test") {
+        REQUIRE(first.get_result());
+        REQUIRE(first.sawOwnClock);
+        REQUIRE(second.get_result());
+        REQUIRE(second.sawOwnClock);
+    }
+
+    SECTION("Metrics of a body that moved between workers are not measured") {
+        const TestMetrics& metrics = first.get_metrics();
+        REQUIRE_FALSE(metrics.cpuTimeMeasured);
+        REQUIRE_FALSE(metrics.allocations.measured);
+        REQUIRE_FALSE(metrics.counters.measured);
+        REQUIRE(metrics.run() >= std::chrono::milliseconds(1));
+    }
+}
@@ -0,0 +1,242 @@
+#include <catch2/catch.hpp>
+#include "Baseline.hpp"
+#include "TestController.hpp"
+#include "TimingCache.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace PidgeonPulse;
+
+namespace {
+
+class Sleeping : public Testable {
+private:
+    std::chrono::milliseconds mDuration;
+
+public:
+    Sleeping(std::string name, std::chrono::milliseconds duration): Testable(std::move(name)), mDuration(duration) {}
+
+    void run() override {
+        std::this_thread::sleep_for(mDuration);
+    }
+};
+
+std::atomic<int> gRunningTests = 0;
+std::atomic<int> gMostRunningTests = 0;
+
+class Busy : public Testable {
+public:
+    using Testable::Testable;
+
+    void run() override {
+        int running = ++gRunningTests;
+        int most = gMostRunningTests;
+        while ( running > most && !gMostRunningTests.compare_exchange_weak(most, running) ) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        gRunningTests--;
+    }
+};
+
+class Gated : public Testable {
+public:
+    int mConcurrentTests = -1;
+
+    using Testable::Testable;
+
+    void setup() override {
+        mConcurrentTests = gRunningTests;
+    }
+
+    void run() override {}
+};
+
+class ComparisonReporter : public Reporter {
+private:
+    std::unordered_map<std::string, BaselineComparison>& mComparisons;
+
+public:
+    explicit ComparisonReporter(std::unordered_map<std::string, BaselineComparison>& comparisons)
+    : mComparisons(comparisons) {}
+
+    void testFinished(const TestCollection&, const Testable&) override {}
+
+    void baselineCompared(const TestCollection&, const Testable& test, const BaselineComparison& comparison) override {
+        mComparisons[test.get_name()] = comparison;
+    }
+};
+
+std::vector<double> range(double first, double step, size_t count) {
+    std::vector<double> samples;
+    for ( size_t i = 0; i < count; i++ ) {
+        samples.push_back(first + step * i);
+    }
+    return samples;
+}
+
+std::vector<float> toFloats(const std::vector<double>& samples) {
+    return std::vector<float>(samples.begin(), samples.end());
+}
+
+}
+
+TEST_CASE("Test Baseline", "[Baseline]") {
+    Baseline baseline;
+    uint64_t key = TimingCache::key("Collection", "test");
+
+    SECTION("Finds a shifted distribution significant") {
+        auto before = toFloats(range(100, 1, 30));
+        REQUIRE(Baseline::slowerPValue(before, range(120, 1, 30)) < 0.001);
+        REQUIRE(Baseline::slowerPValue(before, range(80, 1, 30)) > 0.999);
+        REQUIRE(Baseline::slowerPValue(before, range(100.5, 1, 30)) > Baseline::SIGNIFICANCE);
+    }
+
+    SECTION("Ranks a single sample exactly") {
+        auto before = toFloats(range(1, 1, 31));
+        REQUIRE(Baseline::slowerPValue(before, {100}) == Approx(1.0 / 32));
+        REQUIRE(Baseline::slowerPValue(before, {0}) == Approx(1.0));
+    }
+
+    SECTION("Fails only slowdowns beyond the tolerance") {
+        auto before = toFloats(range(100, 1, 30));
+        BaselineComparison slower = Baseline::compare(before, range(120, 1, 30), 0.1);
+        REQUIRE(slower.delta() == Approx(134.5 / 114.5 - 1));
+        REQUIRE(slower.regressed);
+
+        REQUIRE_FALSE(Baseline::compare(before, range(105, 1, 30), 0.1).regressed);
+        REQUIRE_FALSE(Baseline::compare(before, range(120, 1, 30), 0.3).regressed);
+        REQUIRE_FALSE(Baseline::compare(before, range(120, 1, 30), 0.1, 50).regressed);
+    }
+
+    SECTION("Keeps a window of durations") {
+        for ( size_t i = 0; i < Baseline::WINDOW + 5; i++ ) {
+            baseline.append(key, static_cast<double>(i));
+        }
+        REQUIRE(baseline.lookup(key)->size() == Baseline::WINDOW);
+        REQUIRE(baseline.lookup(key)->front() == 5.0f);
+
+        baseline.replace(key, {1.0, 2.0});
+        REQUIRE(baseline.lookup(key)->size() == 2);
+        REQUIRE(baseline.lookup(TimingCache::key("Collection", "other")) == nullptr);
+    }
+
+    SECTION("Survives a save and load") {
+        const char* path = "test_baseline.baseline";
+        baseline.replace(key, {1.0, 2.0, 3.0});
+        baseline.append(TimingCache::key("Collection", "other"), 0.5);
+        REQUIRE(baseline.save(path));
+
+        Baseline loaded;
+        REQUIRE(loaded.load(path));
+        REQUIRE(loaded.size() == 2);
+        REQUIRE(*loaded.lookup(key) == std::vector<float>{1.0f, 2.0f, 3.0f});
+        std::remove(path);
+    }
+
+    SECTION("Rejects other versions") {
+        const char* path = "test_baseline_version.baseline";
+        std::FILE* file = std::fopen(path, "wb");
+        uint32_t version = 2;
+        uint64_t count = 0;
+        std::fwrite("PPBL", 4, 1, file);
+        std::fwrite(&version, sizeof(version), 1, file);
+        std::fwrite(&count, sizeof(count), 1, file);
+        std::fclose(file);
+
+        REQUIRE_FALSE(baseline.load(path));
+        REQUIRE_FALSE(baseline.load("does-not-exist.baseline"));
+        std::remove(path);
+    }
+}
+
+TEST_CASE("Test baseline regressions", "[Baseline]") {
+    TestController::reset();
+    static std::unordered_map<std::string, BaselineComparison> comparisons;
+    comparisons.clear();
+    TestController::addReporter(std::make_unique<ComparisonReporter>(comparisons));
+
+    const char* path = "test_baseline_run.baseline";
+    TestCollection& collection = TestController::addTestCollection("Baseline");
+    Sleeping slow("slow", std::chrono::milliseconds(20));
+    Sleeping fast("fast", std::chrono::milliseconds(0));
+    Sleeping unknown("unknown", std::chrono::milliseconds(0));
+    collection.addTest(&slow);
+    collection.addTest(&fast);
+    collection.addTest(&unknown);
+
+    SECTION("Fails tests that got slower") {
+        Baseline baseline;
+        for ( size_t i = 0; i < Baseline::WINDOW; i++ ) {
+            baseline.append(TimingCache::key("Baseline", "slow"), 0.001);
+            baseline.append(TimingCache::key("Baseline", "fast"), 1.0);
+        }
+        REQUIRE(baseline.save(path));
+
+        TestController::setBaseline(path, 0.1);
+        TestController::runTests();
+
+        REQUIRE_FALSE(slow.get_result());
+        REQUIRE(comparisons.at("slow").regressed);
+        REQUIRE(comparisons.at("slow").delta() > 0.1);
+        REQUIRE(std::strstr(slow.get_fail_infos()[0].message, "regressed by +") != nullptr);
+
+        REQUIRE(fast.get_result());
+        REQUIRE_FALSE(comparisons.at("fast").regressed);
+        REQUIRE(comparisons.count("unknown") == 0);
+    }
+
+    SECTION("Records the run when updating") {
+        std::remove(path);
+        TestController::setBaseline(path, 0.1, true);
+        TestController::runTests();
+
+        REQUIRE(slow.get_result());
+        Baseline saved;
+        REQUIRE(saved.load(path));
+        REQUIRE(saved.size() == 3);
+        REQUIRE(saved.lookup(TimingCache::key("Baseline", "slow"))->size() == 1);
+    }
+
+    std::remove(path);
+    TestController::reset();
+}
+
+TEST_CASE("Test only tests with a baseline run on their own", "[Baseline]") {
+    TestController::reset();
+    const char* path = "test_baseline_exclusive.baseline";
+    Baseline baseline;
+    for ( size_t i = 0; i < Baseline::WINDOW; i++ ) {
+        baseline.append(TimingCache::key("Exclusive Baseline", "gated"), 1.0);
+    }
+    REQUIRE(baseline.save(path));
+
+    TestController::setBaseline(path, 0.1);
+    TestController::setWorkerCount(4);
+    TestCollection& collection = TestController::addTestCollection("Exclusive Baseline");
+    Gated gated("gated");
+    collection.addTest(&gated);
+    std::vector<std::unique_ptr<Busy>> tests;
+    for ( int i = 0; i < 8; i++ ) {
+        tests.push_back(std::make_unique<Busy>("busy " + std::to_string(i)));
+        collection.addTest(tests.back().get());
+    }
+    gMostRunningTests = 0;
+    TestController::runTests();
+
+    REQUIRE(gated.get_result());
+    REQUIRE(gated.mConcurrentTests == 0);
+    // the tests without a baseline still share the workers
+    REQUIRE(gMostRunningTests > 1);
+
+    TestController::setWorkerCount(0);
+    std::remove(path);
+    TestController::reset();
+}
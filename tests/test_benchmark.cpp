@@ -0,0 +1,107 @@
+#include <catch2/catch.hpp>
+#include "Benchmark.hpp"
+#include "TestController.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace PidgeonPulse;
+
+namespace {
+
+class SumBenchmark : public Benchmark {
+public:
+    uint64_t mCalls = 0;
+
+    SumBenchmark(BenchmarkOptions options): Benchmark("sum", options) {}
+
+    void iteration() override {
+        uint64_t sum = 0;
+        for ( uint64_t i = 0; i < 64; i++ ) {
+            sum += i;
+        }
+        do_not_optimize(sum);
+        mCalls++;
+    }
+};
+
+std::atomic<int> gRunningTests = 0;
+
+class BusyTest : public Testable {
+public:
+    using Testable::Testable;
+
+    void run() override {
+        gRunningTests++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        gRunningTests--;
+    }
+};
+
+class ExclusiveBenchmark : public SumBenchmark {
+public:
+    int mConcurrentTests = -1;
+
+    ExclusiveBenchmark(BenchmarkOptions options): SumBenchmark(options) {}
+
+    void setup() override {
+        mConcurrentTests = gRunningTests;
+    }
+};
+
+}
+
+TEST_CASE("Test Benchmark", "[Benchmark]") {
+    BenchmarkOptions options;
+    options.samples = 10;
+    options.warmup_time = std::chrono::milliseconds(1);
+    options.sample_time = std::chrono::microseconds(200);
+
+    SumBenchmark benchmark(options);
+    benchmark();
+
+    SECTION("Takes the configured number of samples") {
+        REQUIRE(benchmark.result_ready());
+        REQUIRE(benchmark.get_stats().samples.size() == 10);
+        REQUIRE(benchmark.get_stats().iterations > 0);
+    }
+
+    SECTION("Produces ordered statistics") {
+        const BenchmarkStats& stats = benchmark.get_stats();
+        REQUIRE(stats.min > 0);
+        REQUIRE(stats.min <= stats.median);
+        REQUIRE(stats.median <= stats.p99);
+        REQUIRE(stats.stddev >= 0);
+    }
+
+    SECTION("Runs the calibrated iterations for every sample") {
+        REQUIRE(benchmark.mCalls >= benchmark.get_stats().iterations * 10);
+    }
+}
+
+TEST_CASE("Test benchmarks run without other tests in flight", "[Benchmark]") {
+    BenchmarkOptions options;
+    options.samples = 2;
+    options.warmup_time = std::chrono::milliseconds(1);
+    options.sample_time = std::chrono::microseconds(200);
+    TestController::setWorkerCount(4);
+
+    TestCollection collection("Exclusive Collection");
+    ExclusiveBenchmark benchmark(options);
+    collection.addTest(&benchmark);
+    std::vector<std::unique_ptr<BusyTest>> tests;
+    for ( int i = 0; i < 8; i++ ) {
+        tests.push_back(std::make_unique<BusyTest>("busy " + std::to_string(i)));
+        collection.addTest(tests.back().get());
+    }
+    collection.runTests();
+
+    TestController::setWorkerCount(0);
+
+    REQUIRE(benchmark.get_result());
+    REQUIRE(benchmark.mConcurrentTests == 0);
+}
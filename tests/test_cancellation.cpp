@@ -0,0 +1,85 @@
+#include <catch2/catch.hpp>
+#include "TestController.hpp"
+
+#include <stdexcept>
+
+using namespace PidgeonPulse;
+
+namespace {
+
+class PassingTest : public Testable {
+public:
+    using Testable::Testable;
+    void run() override {}
+};
+
+class FailingTest : public Testable {
+public:
+    using Testable::Testable;
+    void run() override { fail("file.cpp", 1, true); }
+};
+
+class StoppableTest : public Testable {
+public:
+    bool sawStop = false;
+
+    using Testable::Testable;
+    void run() override {
+        sawStop = stop_requested();
+        if ( sawStop ) {
+            skip();
+        }
+    }
+};
+
+}
+
+TEST_CASE("Test stop token of a Testable", "[Cancellation]") {
+    StoppableTest test("stoppable");
+
+    SECTION("Runs normally without a stop request") {
+        test();
+        REQUIRE_FALSE(test.sawStop);
+        REQUIRE(test.get_result());
+        REQUIRE_FALSE(test.was_skipped());
+    }
+
+    SECTION("Is reported as skipped once it stopped") {
+        std::stop_source source;
+        source.request_stop();
+        test(source.get_token());
+        REQUIRE(test.sawStop);
+        REQUIRE(test.was_skipped());
+        REQUIRE_FALSE(test.get_result());
+
+        TestStats stats;
+        stats.add(test);
+        REQUIRE(stats.skipped == 1);
+        REQUIRE(stats.failed == 0);
+    }
+}
+
+TEST_CASE("Test fail fast", "[Cancellation]") {
+    TestController::setWorkerCount(1);
+    TestController::setMaxFailures(1);
+
+    TestCollection collection("Fail Fast Collection");
+    PassingTest first("first");
+    FailingTest failing("failing");
+    PassingTest second("second");
+    PassingTest third("third");
+    collection.addTest(&first);
+    collection.addTest(&failing);
+    collection.addTest(&second);
+    collection.addTest(&third);
+    collection.runTests();
+
+    TestController::setMaxFailures(0);
+    TestController::setWorkerCount(0);
+
+    REQUIRE(first.get_result());
+    REQUIRE_FALSE(failing.get_result());
+    REQUIRE_FALSE(failing.was_skipped());
+    REQUIRE(second.was_skipped());
+    REQUIRE(third.was_skipped());
+}
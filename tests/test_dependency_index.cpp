@@ -0,0 +1,95 @@
+#include <catch2/catch.hpp>
+#include "DependencyIndex.hpp"
+#include "TestController.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+
+using namespace PidgeonPulse;
+
+namespace {
+
+std::atomic<int> gRun = 0;
+
+class DependentTest : public Testable {
+public:
+    DependentTest(std::string name, std::string dependency): Testable(std::move(name)) {
+        add_dependency(std::move(dependency));
+    }
+
+    void run() override { gRun++; }
+};
+
+class UnknownTest : public Testable {
+public:
+    using Testable::Testable;
+
+    void run() override { gRun++; }
+};
+
+}
+
+TEST_CASE("Test DependencyIndex", "[DependencyIndex]") {
+    DependencyIndex index;
+    std::unordered_set<std::string> changed{"source/Parser.cpp"};
+
+    SECTION("Normalizes paths") {
+        REQUIRE(DependencyIndex::normalize("././source/a.cpp") == "source/a.cpp");
+        REQUIRE(DependencyIndex::normalize("source/a.cpp") == "source/a.cpp");
+    }
+
+    SECTION("Unknown tests are affected") {
+        REQUIRE(index.lookup("Collection", "test") == nullptr);
+        REQUIRE(index.affected("Collection", "test", changed));
+    }
+
+    SECTION("Selects tests by their files and directories") {
+        index.record("Collection", "parser", {"./source/Parser.cpp", "include/Parser.hpp"});
+        index.record("Collection", "lexer", {"source/Lexer.cpp"});
+        index.record("Collection", "all", {"source/"});
+        REQUIRE(index.lookup("Collection", "parser")->front() == "source/Parser.cpp");
+        REQUIRE(index.affected("Collection", "parser", changed));
+        REQUIRE_FALSE(index.affected("Collection", "lexer", changed));
+        REQUIRE(index.affected("Collection", "all", changed));
+    }
+
+    SECTION("Survives a save and load") {
+        const char* path = "test_dependency_index.deps";
+        index.record("Collection", "parser", {"source/Parser.cpp", "include/Parser.hpp"});
+        index.record("Collection", "empty", {});
+        REQUIRE(index.save(path));
+
+        DependencyIndex loaded;
+        REQUIRE(loaded.load(path));
+        REQUIRE(loaded.size() == 2);
+        REQUIRE(*loaded.lookup("Collection", "parser") == std::vector<std::string>{"source/Parser.cpp", "include/Parser.hpp"});
+        REQUIRE(loaded.lookup("Collection", "empty")->empty());
+        std::remove(path);
+    }
+
+    SECTION("Rejects missing files") {
+        REQUIRE_FALSE(index.load("does-not-exist.deps"));
+    }
+}
+
+TEST_CASE("Test changed files select the affected tests", "[DependencyIndex]") {
+    TestController::reset();
+    TestCollection& collection = TestController::addTestCollection("Affected");
+    DependentTest parser("parser", "source/Parser.cpp");
+    DependentTest lexer("lexer", "source/Lexer.cpp");
+    UnknownTest unknown("unknown");
+    collection.addTest(&parser);
+    collection.addTest(&lexer);
+    collection.addTest(&unknown);
+
+    TestController::setWorkerCount(1);
+    TestController::setChangedFiles({"./source/Parser.cpp"});
+    TestController::runTests();
+
+    REQUIRE(gRun == 2);
+    REQUIRE(parser.result_ready());
+    REQUIRE_FALSE(lexer.result_ready());
+    REQUIRE(unknown.result_ready());
+    TestController::setWorkerCount(0);
+}
@@ -0,0 +1,95 @@
+#include <catch2/catch.hpp>
+#include "FailList.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace PidgeonPulse;
+
+TEST_CASE("Test FailList", "[FailList]") {
+    FailList list;
+
+    SECTION("Keeps failures in order beyond the inline capacity") {
+        for ( int i = 0; i < 100; i++ ) {
+            list.push({"file.cpp", i, nullptr});
+        }
+        REQUIRE(list.size() == 100);
+
+        int expected = 0;
+        for ( auto& failInfo : list ) {
+            REQUIRE(failInfo.line == expected++);
+        }
+        REQUIRE(expected == 100);
+        REQUIRE(list[FailList::INLINE_CAPACITY + FailList::CHUNK_CAPACITY].line == int(FailList::INLINE_CAPACITY + FailList::CHUNK_CAPACITY));
+    }
+
+    SECTION("Counts failures beyond the maximum") {
+        for ( size_t i = 0; i < FailList::MAX_RECORDED + 10; i++ ) {
+            list.push({"file.cpp", 0, nullptr});
+        }
+        REQUIRE(list.size() == FailList::MAX_RECORDED);
+        REQUIRE(list.dropped() == 10);
+    }
+
+    SECTION("Can be reused after clearing") {
+        for ( int i = 0; i < 50; i++ ) {
+            list.push({"file.cpp", i, std::make_exception_ptr(std::runtime_error("failure"))});
+        }
+        list.clear();
+        REQUIRE(list.empty());
+        REQUIRE(list.begin() == list.end());
+
+        for ( int i = 0; i < 50; i++ ) {
+            list.push({"other.cpp", -i, nullptr});
+        }
+        REQUIRE(list.size() == 50);
+        int expected = 0;
+        for ( auto& failInfo : list ) {
+            REQUIRE(failInfo.line == expected--);
+            REQUIRE_FALSE(failInfo.exception);
+        }
+    }
+
+    SECTION("Truncates stored texts") {
+        REQUIRE(std::string(list.storeText("1 == 2")) == "1 == 2");
+
+        std::string text(FailList::MAX_TEXT_SIZE + 100, 'x');
+        std::string stored = list.storeText(text);
+        REQUIRE(stored.size() == FailList::MAX_TEXT_SIZE);
+        REQUIRE(stored.substr(stored.size() - 3) == "...");
+    }
+
+    SECTION("Reuses the text blocks after clearing") {
+        std::string text(FailList::MAX_TEXT_SIZE, 'x');
+        std::vector<const char*> first;
+        for ( int i = 0; i < 10; i++ ) {
+            first.push_back(list.storeText(text));
+        }
+        list.clear();
+        for ( int i = 0; i < 10; i++ ) {
+            REQUIRE(list.storeText(text) == first[i]);
+        }
+    }
+
+    SECTION("Hands its blocks to the next list when destroyed") {
+        const FailInfo* chunkSlot = nullptr;
+        const char* text = nullptr;
+        {
+            FailList first;
+            for ( size_t i = 0; i <= FailList::INLINE_CAPACITY; i++ ) {
+                first.push({"file.cpp", 0, std::make_exception_ptr(std::runtime_error("failure"))});
+            }
+            chunkSlot = &first[FailList::INLINE_CAPACITY];
+            text = first.storeText("1 == 2");
+        }
+
+        FailList second;
+        for ( size_t i = 0; i <= FailList::INLINE_CAPACITY; i++ ) {
+            second.push({"other.cpp", 1, nullptr});
+        }
+        REQUIRE(&second[FailList::INLINE_CAPACITY] == chunkSlot);
+        REQUIRE_FALSE(second[FailList::INLINE_CAPACITY].exception);
+        REQUIRE(second.storeText("3 == 4") == text);
+    }
+}
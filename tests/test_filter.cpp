@@ -0,0 +1,133 @@
+#include <catch2/catch.hpp>
+#include "TestController.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+using namespace PidgeonPulse;
+
+namespace {
+
+std::atomic<int> gConstructed = 0;
+std::atomic<int> gRun = 0;
+
+class CountingTest : public Testable {
+public:
+    CountingTest(std::string name): Testable(std::move(name)) { gConstructed++; }
+
+    void run() override { gRun++; }
+};
+
+}
+
+PIDGEON_PULSE_REGISTER_TEST(CountingTest, "Registry", "fast one", "[fast]");
+PIDGEON_PULSE_REGISTER_TEST(CountingTest, "Registry", "fast two", "[fast][io]");
+PIDGEON_PULSE_REGISTER_TEST(CountingTest, "Registry", "slow one", "[slow]");
+PIDGEON_PULSE_REGISTER_TEST(CountingTest, "Other", "fast three", "[fast]");
+
+TEST_CASE("Test TestFilter", "[TestFilter]") {
+    SECTION("Test globMatch") {
+        REQUIRE(TestFilter::globMatch("*", ""));
+        REQUIRE(TestFilter::globMatch("test*", "test one"));
+        REQUIRE(TestFilter::globMatch("*one", "test one"));
+        REQUIRE(TestFilter::globMatch("t?st*o*e", "test one"));
+        REQUIRE_FALSE(TestFilter::globMatch("test", "test one"));
+        REQUIRE_FALSE(TestFilter::globMatch("*two", "test one"));
+    }
+
+    SECTION("Test hasTag") {
+        REQUIRE(TestFilter::hasTag("[fast][io]", "io"));
+        REQUIRE_FALSE(TestFilter::hasTag("[fast][io]", "i"));
+        REQUIRE_FALSE(TestFilter::hasTag("", "fast"));
+    }
+
+    SECTION("Test empty filter") {
+        TestFilter filter;
+        REQUIRE(filter.empty());
+        REQUIRE(filter.matches("Collection", "test"));
+    }
+
+    SECTION("Test names") {
+        TestFilter filter;
+        filter.add("Math/add*,sub");
+        REQUIRE(filter.matches("Math", "add two"));
+        REQUIRE(filter.matches("Strings", "sub"));
+        REQUIRE_FALSE(filter.matches("Strings", "add two"));
+        REQUIRE_FALSE(filter.matches("Math", "mul"));
+    }
+
+    SECTION("Test regex") {
+        TestFilter filter;
+        filter.add("re:Ma.*/(add|sub) [0-9]+");
+        REQUIRE(filter.matches("Math", "add 12"));
+        REQUIRE_FALSE(filter.matches("Math", "add twelve"));
+        REQUIRE_THROWS_AS(filter.add("re:(unclosed"), std::invalid_argument);
+    }
+
+    SECTION("Test commas in regex terms") {
+        TestFilter filter;
+        filter.add("re:C/a{1,3}$,re:C/[,;]x,re:C/b\\,c,sub");
+        REQUIRE(filter.matches("C", "aa"));
+        REQUIRE_FALSE(filter.matches("C", "aaaa"));
+        REQUIRE(filter.matches("C", ",x"));
+        REQUIRE(filter.matches("C", "b,c"));
+        REQUIRE(filter.matches("Strings", "sub"));
+        REQUIRE_FALSE(filter.matches("C", "b"));
+    }
+
+    SECTION("Test tags and excludes") {
+        TestFilter filter;
+        filter.add("[fast][io],-*slow*");
+        REQUIRE(filter.matches("Collection", "read", "[io][fast]"));
+        REQUIRE(filter.matches("Collection", "read", "[io]", "[fast]"));
+        REQUIRE_FALSE(filter.matches("Collection", "read", "[io]"));
+        REQUIRE_FALSE(filter.matches("Collection", "read slowly", "[io][fast]"));
+
+        TestFilter excludeOnly;
+        excludeOnly.add("-[slow]");
+        REQUIRE(excludeOnly.matches("Collection", "test", "[fast]"));
+        REQUIRE_FALSE(excludeOnly.matches("Collection", "test", "[slow]"));
+        REQUIRE_THROWS_AS(excludeOnly.add("a,,b"), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Test registered tests are only constructed when selected", "[TestFilter]") {
+    TestController::setWorkerCount(1);
+    TestController::addFilter("Registry/*,-[io]");
+    TestController::runTests();
+
+    REQUIRE(gConstructed == 2);
+    REQUIRE(gRun == 2);
+
+    // already instantiated tests are not constructed again
+    TestController::runTests();
+    REQUIRE(gConstructed == 2);
+    TestController::setWorkerCount(0);
+}
+
+TEST_CASE("Test reports leave out tests that were filtered out", "[TestFilter]") {
+    TestController::reset();
+    TestController::setWorkerCount(1);
+    TestCollection collection("C");
+    CountingTest a("a");
+    CountingTest b("b");
+    collection.addTest(&a);
+    collection.addTest(&b);
+    TestController::addFilter("C/a");
+    TestController::runTests();
+
+    REQUIRE(a.get_result());
+    REQUIRE_FALSE(b.result_ready());
+    std::string report;
+    REQUIRE_NOTHROW(report = TestController::generateReport());
+    REQUIRE(report.find("Test Collection: C\nStats: failed 0 of 1 tests\n") != std::string::npos);
+
+    TestStats stats;
+    stats.add(a);
+    stats.add(b);
+    REQUIRE(stats.total == 1);
+
+    TestController::setWorkerCount(0);
+    TestController::reset();
+}
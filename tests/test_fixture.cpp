@@ -0,0 +1,125 @@
+#include <catch2/catch.hpp>
+#include "TestController.hpp"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace PidgeonPulse;
+
+namespace {
+
+struct Dataset {
+    static inline std::atomic<int> created = 0;
+    static inline std::atomic<int> destroyed = 0;
+
+    std::vector<int> values{1, 2, 3};
+
+    Dataset() { created++; }
+    ~Dataset() { destroyed++; }
+};
+
+class DatasetTest : public Testable {
+private:
+    Fixture<Dataset>& mDataset;
+
+public:
+    DatasetTest(std::string name, Fixture<Dataset>& dataset)
+    : Testable(std::move(name)), mDataset(dataset) {
+        use_fixture(dataset);
+    }
+
+    void run() override {
+        PP_ASSERT(mDataset.get().values.size() == 3u);
+    }
+};
+
+std::mutex gOrderMutex;
+std::vector<std::string> gOrder;
+
+class RecordingTest : public Testable {
+private:
+    Fixture<std::string>& mFixture;
+
+public:
+    RecordingTest(std::string name, Fixture<std::string>& fixture)
+    : Testable(std::move(name)), mFixture(fixture) {
+        use_fixture(fixture);
+    }
+
+    void run() override {
+        std::lock_guard lock(gOrderMutex);
+        gOrder.push_back(mFixture.get());
+    }
+};
+
+}
+
+TEST_CASE("Test Fixture", "[Fixture]") {
+    Dataset::created = 0;
+    Dataset::destroyed = 0;
+    Fixture<Dataset> dataset;
+
+    SECTION("Is created on first use only") {
+        REQUIRE_FALSE(dataset.isLive());
+        REQUIRE(Dataset::created == 0);
+        REQUIRE(dataset.get().values.size() == 3);
+        REQUIRE(&dataset.get() == &dataset.get());
+        REQUIRE(dataset.isLive());
+        REQUIRE(Dataset::created == 1);
+    }
+
+    SECTION("Is shared by concurrent tests and torn down after the last one") {
+        TestController::setWorkerCount(4);
+        TestCollection collection("Fixture Collection");
+        std::vector<std::unique_ptr<DatasetTest>> tests;
+        for ( int i = 0; i < 32; i++ ) {
+            tests.push_back(std::make_unique<DatasetTest>("dataset " + std::to_string(i), dataset));
+            collection.addTest(tests.back().get());
+        }
+        collection.runTests();
+        TestController::setWorkerCount(0);
+
+        for ( auto& test : tests ) {
+            REQUIRE(test->get_result());
+        }
+        REQUIRE(Dataset::created == 1);
+        REQUIRE(Dataset::destroyed == 1);
+        REQUIRE_FALSE(dataset.isLive());
+        REQUIRE(dataset.getUsers() == 0);
+    }
+
+    SECTION("Can be used by a whole collection") {
+        TestCollection collection("Collection Fixture Collection");
+        collection.useFixture(dataset);
+        REQUIRE(collection.getFixtures().size() == 1);
+    }
+}
+
+TEST_CASE("Test tests are grouped by fixture", "[Fixture]") {
+    gOrder.clear();
+    Fixture<std::string> first([]() { return std::make_unique<std::string>("first"); });
+    Fixture<std::string> second([]() { return std::make_unique<std::string>("second"); });
+    bool firstLiveDuringSecond = true;
+    Fixture<std::string> probe([&first, &firstLiveDuringSecond]() {
+        firstLiveDuringSecond = first.isLive();
+        return std::make_unique<std::string>("probe");
+    });
+
+    TestController::setWorkerCount(1);
+    TestCollection collection("Grouped Collection");
+    RecordingTest a1("a1", first);
+    RecordingTest b1("b1", second);
+    RecordingTest a2("a2", first);
+    RecordingTest p1("p1", probe);
+    RecordingTest b2("b2", second);
+    for ( Testable* test : std::initializer_list<Testable*>{&a1, &b1, &a2, &p1, &b2} ) {
+        collection.addTest(test);
+    }
+    collection.runTests();
+    TestController::setWorkerCount(0);
+
+    REQUIRE(gOrder == std::vector<std::string>{"first", "first", "second", "second", "probe"});
+    // the first fixture was torn down once its last test finished
+    REQUIRE_FALSE(firstLiveDuringSecond);
+}
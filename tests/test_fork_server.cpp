@@ -0,0 +1,114 @@
+#include <catch2/catch.hpp>
+#include "ForkServer.hpp"
+
+#include <csignal>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace PidgeonPulse;
+
+namespace {
+
+class PassingTest : public Testable {
+public:
+    using Testable::Testable;
+    void run() override {}
+};
+
+class FailingTest : public Testable {
+public:
+    using Testable::Testable;
+    void run() override { throw std::runtime_error("failure from the worker"); }
+};
+
+class SleepingTest : public Testable {
+public:
+    using Testable::Testable;
+    void run() override { std::this_thread::sleep_for(std::chrono::seconds(60)); }
+};
+
+class CrashingTest : public Testable {
+public:
+    using Testable::Testable;
+    void run() override { std::raise(SIGSEGV); }
+};
+
+std::string exceptionMessage(const std::exception_ptr& exception) {
+    try {
+        std::rethrow_exception(exception);
+    } catch ( const std::exception& e ) {
+        return e.what();
+    }
+}
+
+}
+
+TEST_CASE("Test ForkServer", "[ForkServer]") {
+    PassingTest passing("passing");
+    FailingTest failing("failing");
+    CrashingTest crashing("crashing");
+    PassingTest afterCrash("after crash");
+
+    std::vector<Testable*> tests{&passing, &failing, &crashing, &afterCrash};
+    size_t finished = 0;
+    ForkServer server(tests, [&finished](size_t) { finished++; });
+    server.run(2);
+
+    SECTION("Reports every test as finished") {
+        REQUIRE(finished == tests.size());
+        for ( auto test : tests ) {
+            REQUIRE(test->result_ready());
+        }
+    }
+
+    SECTION("Transfers failures and their exceptions") {
+        REQUIRE_FALSE(failing.get_result());
+        REQUIRE(failing.threw_exception());
+        auto& failInfos = failing.get_fail_infos();
+        REQUIRE(failInfos.size() == 1);
+        REQUIRE(exceptionMessage(failInfos[0].exception) == "failure from the worker");
+    }
+
+    SECTION("Reports a crashing test with its signal") {
+        REQUIRE_FALSE(crashing.get_result());
+        auto& failInfos = crashing.get_fail_infos();
+        REQUIRE(failInfos.size() == 1);
+        REQUIRE(exceptionMessage(failInfos[0].exception).find("signal " + std::to_string(SIGSEGV)) != std::string::npos);
+    }
+
+    SECTION("Keeps running tests after a crash") {
+        REQUIRE(afterCrash.result_ready());
+    }
+}
+
+TEST_CASE("Test ForkServer ignores the crash handlers of the host", "[ForkServer]") {
+    // a handler the worker inherited would turn the crash into a clean exit
+    struct sigaction handler{};
+    struct sigaction previous{};
+    handler.sa_handler = [](int) { _exit(0); };
+    sigaction(SIGSEGV, &handler, &previous);
+    CrashingTest crashing("crashing");
+    std::vector<Testable*> tests{&crashing};
+    ForkServer server(tests);
+    server.run(1);
+    sigaction(SIGSEGV, &previous, nullptr);
+
+    REQUIRE_FALSE(crashing.get_result());
+    REQUIRE(exceptionMessage(crashing.get_fail_infos()[0].exception).find("signal " + std::to_string(SIGSEGV)) != std::string::npos);
+}
+
+TEST_CASE("Test ForkServer timeouts", "[ForkServer]") {
+    SleepingTest sleeping("sleeping");
+    PassingTest passing("passing");
+
+    std::vector<Testable*> tests{&sleeping, &passing};
+    ForkServer server(tests);
+    server.setTimeouts({std::chrono::milliseconds(50), std::chrono::milliseconds(0)});
+    server.run(1);
+
+    REQUIRE(sleeping.timed_out());
+    REQUIRE_FALSE(sleeping.get_result());
+    REQUIRE(exceptionMessage(sleeping.get_fail_infos()[0].exception) == "Test timed out after 50 ms");
+    REQUIRE(passing.get_result());
+}
@@ -0,0 +1,91 @@
+#include <catch2/catch.hpp>
+#include "TestController.hpp"
+
+#include <atomic>
+#include <vector>
+
+using namespace PidgeonPulse;
+
+namespace {
+
+std::atomic<int> gRunCount = 0;
+
+class AdditionTest : public ParameterizedTest<std::tuple<int, int, int>> {
+public:
+    using ParameterizedTest::ParameterizedTest;
+    void run() override {
+        gRunCount++;
+        auto [a, b, sum] = get_params();
+        PP_ASSERT(a + b == sum);
+    }
+};
+
+class EvenTest : public ParameterizedTest<int> {
+public:
+    using ParameterizedTest::ParameterizedTest;
+    void run() override {
+        gRunCount++;
+        PP_ASSERT(get_params() % 2 == 0);
+    }
+};
+
+}
+
+TEST_CASE("Test cartesian product", "[Parameterized]") {
+    constexpr auto combinations = cartesianProduct(std::array{1, 2, 3}, std::array{'a', 'b'});
+    static_assert(combinations.size() == 6);
+    static_assert(combinations[0] == std::tuple{1, 'a'});
+    static_assert(combinations[1] == std::tuple{1, 'b'});
+    static_assert(combinations[5] == std::tuple{3, 'b'});
+
+    REQUIRE(stringify(combinations[2]) == "(2, 'a')");
+}
+
+TEST_CASE("Test parameterized tests", "[Parameterized]") {
+    gRunCount = 0;
+    TestCollection collection("Parameterized Collection");
+
+    SECTION("Every parameter set is its own test") {
+        collection.addParameterizedTests<AdditionTest>("add", std::vector<std::tuple<int, int, int>>{
+            {1, 2, 3}, {2, 2, 5}, {0, 0, 0}
+        });
+
+        auto tests = collection.takePendingTests();
+        REQUIRE(tests.size() == 3);
+        REQUIRE(tests[0]->get_name() == "add(1, 2, 3)");
+        REQUIRE(tests[1]->get_name() == "add(2, 2, 5)");
+
+        for ( auto* test : tests ) {
+            (*test)();
+        }
+        REQUIRE(gRunCount == 3);
+        REQUIRE(tests[0]->get_result());
+        REQUIRE_FALSE(tests[1]->get_result());
+        REQUIRE(tests[2]->get_result());
+    }
+
+    SECTION("Parameter sets can be a tuple or a cartesian product") {
+        collection.addParameterizedTests<EvenTest>("even", std::tuple{2, short(4), 7L});
+        constexpr auto sums = cartesianProduct(std::array{1, 2}, std::array{3, 4}, std::array{4, 5, 6});
+        collection.addParameterizedTests<AdditionTest>("sum", sums);
+
+        auto tests = collection.takePendingTests();
+        REQUIRE(tests.size() == 15);
+        REQUIRE(tests[2]->get_name() == "even7");
+        REQUIRE(tests[3]->get_name() == "sum(1, 3, 4)");
+
+        TestStats stats;
+        for ( auto* test : tests ) {
+            (*test)();
+            stats.add(*test);
+        }
+        REQUIRE(gRunCount == 15);
+        REQUIRE(stats.failed == 9);
+    }
+
+    SECTION("Instances are scheduled as separate jobs") {
+        collection.addParameterizedTests<EvenTest>("even", std::vector<int>(64, 2));
+        collection.runTests();
+        REQUIRE(gRunCount == 64);
+    }
+}
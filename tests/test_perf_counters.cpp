@@ -0,0 +1,57 @@
+#include <catch2/catch.hpp>
+#include "Benchmark.hpp"
+#include "PerfCounters.hpp"
+
+using namespace PidgeonPulse;
+
+namespace {
+
+class Busy : public Testable {
+public:
+    Busy(): Testable("busy") {}
+
+    void run() override {
+        uint64_t sum = 0;
+        for ( uint64_t i = 0; i < 100000; i++ ) {
+            sum += i;
+            do_not_optimize(sum);
+        }
+    }
+};
+
+}
+
+TEST_CASE("Test PerfCounters", "[PerfCounters]") {
+    SECTION("Measures nothing while disabled") {
+        PerfCounters::setEnabled(false);
+        PerfCounters::Scope scope;
+        REQUIRE_FALSE(scope.stats().measured);
+    }
+
+    SECTION("Measures the run of a test if the kernel allows it") {
+        PerfCounters::setEnabled(true);
+        Busy test;
+        test();
+        PerfCounters::setEnabled(false);
+
+        REQUIRE(test.get_result());
+        const PerfStats& counters = test.get_metrics().counters;
+        if ( counters.measured ) {
+            REQUIRE(counters.instructions >= 100000);
+            REQUIRE(counters.cycles > 0);
+            REQUIRE(counters.ipc() > 0);
+        } else {
+            REQUIRE(counters.instructions == 0);
+        }
+    }
+
+    SECTION("Derives rates") {
+        PerfStats stats;
+        stats.cycles = 1000;
+        stats.instructions = 2000;
+        stats.cacheMisses = 4;
+        REQUIRE(stats.ipc() == Approx(2.0));
+        REQUIRE(stats.perKiloInstruction(stats.cacheMisses) == Approx(2.0));
+        REQUIRE(PerfStats().ipc() == 0);
+    }
+}
@@ -0,0 +1,104 @@
+#include <catch2/catch.hpp>
+#include "TestController.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace PidgeonPulse;
+
+extern "C" int pidgeonPulsePluginLoads;
+int pidgeonPulsePluginLoads = 0;
+
+extern "C" std::atomic<bool> pidgeonPulsePluginRelease;
+extern "C" std::atomic<bool> pidgeonPulsePluginReturned;
+std::atomic<bool> pidgeonPulsePluginRelease = false;
+std::atomic<bool> pidgeonPulsePluginReturned = false;
+
+namespace {
+
+class NameReporter : public Reporter {
+private:
+    std::vector<std::string>& mNames;
+
+public:
+    explicit NameReporter(std::vector<std::string>& names): mNames(names) {}
+
+    void testFinished(const TestCollection& collection, const Testable& test) override {
+        if ( test.get_result() ) {
+            mNames.push_back(collection.getName() + "/" + test.get_name());
+        }
+    }
+};
+
+void runWithPlugin(std::vector<std::string>& names, const char* filter) {
+    TestController::reset();
+    TestController::addReporter(std::make_unique<NameReporter>(names));
+    TestController::addPlugin(PIDGEON_PULSE_TEST_PLUGIN);
+    TestController::setPluginCache("test_plugin.cache");
+    if ( filter ) {
+        TestController::addFilter(filter);
+    }
+    TestController::setWorkerCount(1);
+    TestController::runTests();
+}
+
+}
+
+TEST_CASE("Test plugins", "[Plugin]") {
+    std::remove("test_plugin.cache");
+    pidgeonPulsePluginLoads = 0;
+
+    std::vector<std::string> names;
+    runWithPlugin(names, nullptr);
+    REQUIRE(pidgeonPulsePluginLoads == 1);
+    REQUIRE(names == std::vector<std::string>{"Plugin/loaded test", "Plugin Registry/registered test"});
+
+    // unloaded with its collections once the run finished
+    REQUIRE_THROWS_AS(TestController::getTestCollection("Plugin"), std::runtime_error);
+
+    SECTION("Skips plugins without selected tests") {
+        names.clear();
+        runWithPlugin(names, "Other/*");
+        REQUIRE(pidgeonPulsePluginLoads == 1);
+        REQUIRE(names.empty());
+    }
+
+    SECTION("Loads plugins with selected tests") {
+        names.clear();
+        runWithPlugin(names, "[plugin]");
+        REQUIRE(pidgeonPulsePluginLoads == 2);
+        REQUIRE(names.size() == 2);
+    }
+
+    SECTION("Rejects missing directories") {
+        REQUIRE_THROWS_AS(TestController::addPluginDirectory("does-not-exist"), std::runtime_error);
+    }
+
+    TestController::reset();
+    std::remove("test_plugin.cache");
+}
+
+TEST_CASE("Test plugins with abandoned tests stay loaded", "[Plugin]") {
+    TestController::reset();
+    TestController::addPlugin(PIDGEON_PULSE_HANGING_PLUGIN);
+    TestController::setTimeout(std::chrono::milliseconds(50));
+    TestController::setWorkerCount(1);
+    TestController::runTests();
+
+    // the test still runs the code of the plugin in its collection
+    TestCollection& collection = TestController::getTestCollection("Hanging Plugin");
+    for ( auto test : collection.getTests() ) {
+        REQUIRE(test->timed_out());
+    }
+
+    pidgeonPulsePluginRelease = true;
+    pidgeonPulsePluginReturned.wait(false);
+    TestController::setTimeout(std::chrono::milliseconds(0));
+    TestController::setWorkerCount(0);
+    TestController::reset();
+}
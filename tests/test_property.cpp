@@ -0,0 +1,180 @@
+#include <catch2/catch.hpp>
+#include "PropertyTest.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace PidgeonPulse;
+
+namespace {
+
+struct Point {
+    int x = 0;
+    int y = 0;
+};
+
+std::ostream& operator<<(std::ostream& stream, const Point& point) {
+    return stream << "Point(" << point.x << ", " << point.y << ")";
+}
+
+auto points() {
+    return mapped(
+        tuples(integers(-100, 100), integers(-100, 100)),
+        [](const std::tuple<int, int>& coordinates) { return Point{std::get<0>(coordinates), std::get<1>(coordinates)}; },
+        [](const Point& point) { return std::tuple<int, int>{point.x, point.y}; }
+    );
+}
+
+class SmallNumberTest : public PropertyTest<IntegerGenerator<int>> {
+public:
+    SmallNumberTest(): PropertyTest("small number", integers(0, 1000000)) {}
+    bool property(const int& value) const override { return value < 1000; }
+};
+
+class NoZTest : public PropertyTest<StringGenerator> {
+public:
+    NoZTest(): PropertyTest("no z", strings(0, 20, "abz")) {}
+    bool property(const std::string& value) const override { return value.find('z') == std::string::npos; }
+};
+
+class SmallSumTest : public PropertyTest<VectorGenerator<IntegerGenerator<int>>> {
+public:
+    SmallSumTest(): PropertyTest("small sum", vectors(integers(0, 100), 0, 10)) {}
+    bool property(const std::vector<int>& value) const override {
+        return std::accumulate(value.begin(), value.end(), 0) < 100;
+    }
+};
+
+class PointTest : public PropertyTest<decltype(points())> {
+public:
+    PointTest(): PropertyTest("point", points()) {}
+    bool property(const Point& point) const override { return point.x < 10 || point.y > -10; }
+};
+
+class OrderedTest : public PropertyTest<TupleGenerator<IntegerGenerator<int>, IntegerGenerator<int>>> {
+public:
+    OrderedTest(): PropertyTest("ordered", tuples(integers(-1000, 1000), integers(-1000, 1000))) {}
+    bool property(const std::tuple<int, int>& value) const override {
+        auto [a, b] = value;
+        return std::max(a, b) >= std::min(a, b);
+    }
+};
+
+std::string failureMessage(const Testable& test) {
+    const auto& failInfos = test.get_fail_infos();
+    return failInfos.size() > 0 && failInfos[0].message ? failInfos[0].message : "";
+}
+
+}
+
+TEST_CASE("Test Random", "[Property]") {
+    Random first(42);
+    Random second(42);
+    Random other(43);
+
+    bool differs = false;
+    for ( int i = 0; i < 100; i++ ) {
+        uint64_t value = first.next();
+        REQUIRE(value == second.next());
+        differs |= value != other.next();
+        REQUIRE(other.below(10) < 10);
+    }
+    REQUIRE(differs);
+    REQUIRE(Random::deriveSeed(1, "a") != Random::deriveSeed(1, "b"));
+}
+
+TEST_CASE("Test generators", "[Property]") {
+    Random random(7);
+
+    SECTION("Integers stay in their range and shrink towards 0") {
+        auto generator = integers(-5, 5);
+        int value = 0;
+        for ( int i = 0; i < 1000; i++ ) {
+            generator.generate(random, value);
+            REQUIRE(value >= -5);
+            REQUIRE(value <= 5);
+        }
+
+        std::vector<int> candidates;
+        integers(-100, 100).shrink(-40, candidates);
+        REQUIRE(candidates == std::vector<int>{0, -20, -30, -35, -38, -39});
+
+        candidates.clear();
+        integers(10, 100).shrink(10, candidates);
+        REQUIRE(candidates.empty());
+    }
+
+    SECTION("Strings reuse their buffer") {
+        auto generator = strings(4, 8, "xy");
+        std::string value;
+        value.reserve(8);
+        const char* buffer = value.data();
+        for ( int i = 0; i < 100; i++ ) {
+            generator.generate(random, value);
+            REQUIRE(value.size() >= 4);
+            REQUIRE(value.size() <= 8);
+            REQUIRE(value.find_first_not_of("xy") == std::string::npos);
+        }
+        REQUIRE(value.data() == buffer);
+
+        std::vector<std::string> candidates;
+        generator.shrink("xyyxy", candidates);
+        REQUIRE(candidates.front() == "xyyx");
+        REQUIRE(std::find(candidates.begin(), candidates.end(), "xxyxy") != candidates.end());
+    }
+}
+
+TEST_CASE("Test property tests", "[Property]") {
+    SECTION("A property that holds passes") {
+        OrderedTest test;
+        test.set_cases(10000);
+        test();
+        REQUIRE(test.get_result());
+    }
+
+    SECTION("Failing values are shrunk") {
+        SmallNumberTest number;
+        number.set_seed(42);
+        number();
+        REQUIRE_FALSE(number.get_result());
+        REQUIRE_THAT(failureMessage(number), Catch::Contains("with seed 42") && Catch::EndsWith(": 1000"));
+
+        NoZTest noZ;
+        noZ();
+        REQUIRE_FALSE(noZ.get_result());
+        REQUIRE_THAT(failureMessage(noZ), Catch::EndsWith(": \"z\""));
+
+        PointTest point;
+        point();
+        REQUIRE_FALSE(point.get_result());
+        REQUIRE_THAT(failureMessage(point), Catch::EndsWith(": Point(10, -10)"));
+    }
+
+    SECTION("The same seed reproduces the same failure") {
+        SmallSumTest first;
+        SmallSumTest second;
+        first.set_seed(1234);
+        second.set_seed(1234);
+        first();
+        second();
+        REQUIRE_FALSE(first.get_result());
+        REQUIRE(failureMessage(first) == failureMessage(second));
+    }
+
+    SECTION("Shrinking on the thread pool finds the same value") {
+        SmallSumTest sequential;
+        sequential.set_seed(99);
+        sequential();
+
+        TestController::setWorkerCount(4);
+        TestCollection collection("Property Collection");
+        SmallSumTest parallel;
+        parallel.set_seed(99);
+        collection.addTest(&parallel);
+        collection.runTests();
+        TestController::setWorkerCount(0);
+
+        REQUIRE_FALSE(parallel.get_result());
+        REQUIRE(failureMessage(parallel) == failureMessage(sequential));
+    }
+}
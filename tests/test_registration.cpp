@@ -0,0 +1,124 @@
+#include <catch2/catch.hpp>
+#include "AppendList.hpp"
+#include "Singleton.hpp"
+#include "TestController.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace PidgeonPulse;
+
+namespace {
+
+class Counted : public Singleton<Counted> {
+public:
+    static inline std::atomic<int> created = 0;
+    static inline std::atomic<int> destroyed = 0;
+
+    Counted() { created++; }
+    ~Counted() { destroyed++; }
+};
+
+class NamedTest : public Testable {
+public:
+    using Testable::Testable;
+
+    void run() override {}
+};
+
+}
+
+TEST_CASE("Test AppendList", "[Registration]") {
+    AppendList<size_t> list;
+    REQUIRE(list.empty());
+
+    constexpr size_t THREADS = 8;
+    constexpr size_t PER_THREAD = 10000;
+    std::vector<std::thread> threads;
+    for ( size_t thread = 0; thread < THREADS; thread++ ) {
+        threads.emplace_back([&list, thread]() {
+            for ( size_t i = 0; i < PER_THREAD; i++ ) {
+                list.push_back(thread * PER_THREAD + i);
+            }
+        });
+    }
+    for ( auto& thread : threads ) {
+        thread.join();
+    }
+
+    REQUIRE(list.size() == THREADS * PER_THREAD);
+    std::vector<bool> seen(THREADS * PER_THREAD, false);
+    for ( size_t value : list ) {
+        REQUIRE_FALSE(seen[value]);
+        seen[value] = true;
+    }
+
+    list.clear();
+    REQUIRE(list.empty());
+    REQUIRE(list.push_back(7) == 0);
+    REQUIRE(list[0] == 7);
+}
+
+TEST_CASE("Test Singleton", "[Registration]") {
+    Counted::destroy();
+    Counted::created = 0;
+    Counted::destroyed = 0;
+    REQUIRE(Counted::tryGetInstance() == nullptr);
+
+    std::vector<std::thread> threads;
+    std::vector<Counted*> instances(8);
+    for ( size_t i = 0; i < instances.size(); i++ ) {
+        threads.emplace_back([&instances, i]() { instances[i] = &Counted::getInstance(); });
+    }
+    for ( auto& thread : threads ) {
+        thread.join();
+    }
+    REQUIRE(Counted::created == 1);
+    for ( auto instance : instances ) {
+        REQUIRE(instance == Counted::tryGetInstance());
+    }
+
+    Counted::reset();
+    REQUIRE(Counted::created == 2);
+    REQUIRE(Counted::destroyed == 1);
+
+    Counted::destroy();
+    REQUIRE(Counted::destroyed == 2);
+    REQUIRE(Counted::tryGetInstance() == nullptr);
+}
+
+TEST_CASE("Test concurrent registration", "[Registration]") {
+    TestController::reset();
+
+    constexpr size_t THREADS = 8;
+    constexpr size_t PER_THREAD = 500;
+    TestCollection& shared = TestController::addTestCollection("Shared");
+    std::vector<std::thread> threads;
+    for ( size_t thread = 0; thread < THREADS; thread++ ) {
+        threads.emplace_back([&shared, thread]() {
+            TestCollection& own = TestController::addTestCollection("Own " + std::to_string(thread));
+            for ( size_t i = 0; i < PER_THREAD; i++ ) {
+                shared.addTest(std::make_unique<NamedTest>("test " + std::to_string(i)));
+                own.addTest(std::make_unique<NamedTest>("test " + std::to_string(i)));
+            }
+        });
+    }
+    for ( auto& thread : threads ) {
+        thread.join();
+    }
+
+    REQUIRE(shared.takePendingTests().size() == THREADS * PER_THREAD);
+    REQUIRE(TestController::getTestCollection("Own 3").takePendingTests().size() == PER_THREAD);
+
+    {
+        // a collection owned by the caller leaves the controller with its destructor
+        TestCollection local("Local");
+        REQUIRE(&TestController::getTestCollection("Local") == &local);
+    }
+    REQUIRE_THROWS(TestController::getTestCollection("Local"));
+
+    TestController::reset();
+    REQUIRE_THROWS(TestController::getTestCollection("Shared"));
+}
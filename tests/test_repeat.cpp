@@ -0,0 +1,119 @@
+#include <catch2/catch.hpp>
+#include "TestController.hpp"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace PidgeonPulse;
+
+namespace {
+
+class EveryNthFails : public Testable {
+private:
+    size_t mPeriod;
+
+public:
+    std::atomic<size_t> runs = 0;
+
+    EveryNthFails(std::string name, size_t period): Testable(std::move(name)), mPeriod(period) {}
+
+    void run() override {
+        PP_CHECK(++runs % mPeriod != 0u);
+    }
+};
+
+struct RepeatResults {
+    std::vector<RepeatStats> results;
+    size_t repetitions = 0;
+    uint64_t seed = 0;
+
+    const RepeatStats& of(const Testable& test) const {
+        for ( auto& result : results ) {
+            if ( result.test == &test ) {
+                return result;
+            }
+        }
+        FAIL("no results for " << test.get_name());
+        return results.front();
+    }
+};
+
+class RepeatReporter : public Reporter {
+private:
+    RepeatResults& mResults;
+
+public:
+    explicit RepeatReporter(RepeatResults& results): mResults(results) {}
+
+    void testFinished(const TestCollection&, const Testable&) override {}
+
+    void repeatFinished(const std::vector<RepeatStats>& results, size_t repetitions, uint64_t seed) override {
+        mResults.results = results;
+        mResults.repetitions = repetitions;
+        mResults.seed = seed;
+    }
+};
+
+}
+
+TEST_CASE("Test Testable reset", "[Repeat]") {
+    EveryNthFails test("fails first", 1);
+    test();
+    REQUIRE_FALSE(test.get_result());
+    REQUIRE(test.get_fail_infos().size() == 1);
+
+    test.reset();
+    REQUIRE_FALSE(test.result_ready());
+    REQUIRE(test.get_fail_infos().empty());
+
+    test();
+    REQUIRE(test.get_fail_infos().size() == 1);
+    REQUIRE(test.runs == 2);
+}
+
+TEST_CASE("Test repeated runs", "[Repeat]") {
+    TestController::reset();
+    static RepeatResults results;
+    TestController::addReporter(std::make_unique<RepeatReporter>(results));
+    TestController::setWorkerCount(2);
+    TestController::setSeed(42);
+
+    SECTION("Reports the pass rate of every test") {
+        TestCollection& collection = TestController::addTestCollection("Repeat");
+        EveryNthFails flaky("flaky", 3);
+        EveryNthFails stable("stable", 1000);
+        collection.addTest(&flaky);
+        collection.addTest(&stable);
+
+        TestController::setRepeat(6);
+        TestController::runTests();
+
+        REQUIRE(results.repetitions == 6);
+        REQUIRE(results.seed == 42);
+        REQUIRE(results.of(flaky).runs == 6);
+        REQUIRE(results.of(flaky).failed == 2);
+        REQUIRE(results.of(flaky).isFlaky());
+        REQUIRE(results.of(flaky).passRate() == Approx(4.0 / 6));
+        REQUIRE(results.of(stable).runs == 6);
+        REQUIRE(results.of(stable).failed == 0);
+        REQUIRE_FALSE(results.of(stable).isFlaky());
+    }
+
+    SECTION("Stops after the first failure") {
+        TestCollection& collection = TestController::addTestCollection("Until Fail");
+        EveryNthFails flaky("flaky", 4);
+        collection.addTest(&flaky);
+
+        TestController::setRepeat(0, true);
+        TestController::runTests();
+
+        REQUIRE(results.repetitions == 4);
+        REQUIRE(results.of(flaky).failed == 1);
+        REQUIRE(flaky.runs == 4);
+    }
+
+    TestController::setRepeat(1);
+    TestController::setWorkerCount(0);
+}
@@ -0,0 +1,218 @@
+#include <catch2/catch.hpp>
+#include "TestCollection.hpp"
+#include "TextReporter.hpp"
+#include "JUnitReporter.hpp"
+#include "JsonReporter.hpp"
+#include "TraceReporter.hpp"
+#include "TestController.hpp"
+
+#include <thread>
+#include <time.h>
+
+using namespace PidgeonPulse;
+
+namespace {
+
+class PassingTest : public Testable {
+public:
+    using Testable::Testable;
+    void run() override {}
+};
+
+class FailingTest : public Testable {
+public:
+    using Testable::Testable;
+    void run() override { fail("file.cpp", 42, true); }
+};
+
+class PhasedTest : public Testable {
+public:
+    using Testable::Testable;
+    void setup() override { std::this_thread::sleep_for(std::chrono::milliseconds(20)); }
+    void run() override {
+        // burn CPU time, a sleep would not count, and other processes can not take it away
+        timespec start{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+        timespec now = start;
+        while ( (now.tv_sec - start.tv_sec) * 1000000000L + (now.tv_nsec - start.tv_nsec) < 10000000L ) {
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        }
+    }
+};
+
+}
+
+TEST_CASE("Test OutputSink", "[Reporter]") {
+    StringSink sink;
+
+    SECTION("Formats numbers") {
+        sink.writeNumber(uint64_t(42));
+        sink.write(' ');
+        sink.writeNumber(int64_t(-7));
+        sink.write(' ');
+        sink.writeNumber(1.5, 2);
+        REQUIRE(sink.str() == "42 -7 1.50");
+    }
+
+    SECTION("Writes text larger than its buffer") {
+        std::string text(200 * 1024, 'x');
+        sink.write(text);
+        sink.write('y');
+        REQUIRE(sink.str() == text + "y");
+    }
+}
+
+TEST_CASE("Test TextReporter", "[Reporter]") {
+    StringSink sink;
+    TextReporter reporter(sink);
+
+    TestCollection collection("Reporter Collection");
+    PassingTest passing("passing");
+    FailingTest failing("failing");
+    passing();
+    failing();
+
+    reporter.runStarting();
+    reporter.collectionStarting(collection);
+    TestStats stats;
+    for ( Testable* test : {static_cast<Testable*>(&passing), static_cast<Testable*>(&failing)} ) {
+        stats.add(*test);
+        reporter.testFinished(collection, *test);
+    }
+
+    SECTION("Writes nothing before the collection finished") {
+        REQUIRE(sink.str() == "PidgeonPulse Unit Test:\n");
+    }
+
+    SECTION("Writes the failed tests and stats of a finished collection") {
+        reporter.collectionFinished(collection, stats);
+        reporter.runFinished(stats);
+        REQUIRE(sink.str() ==
+            "PidgeonPulse Unit Test:\n"
+            "Test Collection: Reporter Collection\n"
+            "\tTest failed: failing\n"
+            "\t File: file.cpp:42\n"
+            "\n"
+            "Stats: failed 1 of 2 tests\n");
+    }
+}
+
+TEST_CASE("Test JUnitReporter", "[Reporter]") {
+    StringSink sink;
+    JUnitReporter reporter(sink);
+
+    TestCollection collection("Escaped <&> Collection");
+    FailingTest failing("failing \"quoted\"");
+    failing();
+
+    reporter.runStarting();
+    reporter.testFinished(collection, failing);
+    reporter.runFinished({});
+    std::string report = sink.str();
+
+    SECTION("Escapes XML special characters") {
+        REQUIRE(report.find("classname=\"Escaped &lt;&amp;&gt; Collection\"") != std::string::npos);
+        REQUIRE(report.find("name=\"failing &quot;quoted&quot;\"") != std::string::npos);
+    }
+
+    SECTION("Writes failures with their location") {
+        REQUIRE(report.find("<failure message=\"Test failed\">file.cpp:42</failure>") != std::string::npos);
+        REQUIRE(report.find("</testsuites>") != std::string::npos);
+    }
+}
+
+TEST_CASE("Test JsonReporter", "[Reporter]") {
+    StringSink sink;
+    JsonReporter reporter(sink);
+
+    TestCollection collection("Json\tCollection");
+    PassingTest passing("passing \"quoted\" \\ \x01");
+    passing();
+
+    reporter.testFinished(collection, passing);
+    TestStats stats;
+    stats.add(passing);
+    reporter.runFinished(stats);
+    std::string report = sink.str();
+
+    SECTION("Escapes JSON strings") {
+        REQUIRE(report.find("\"collection\":\"Json\\tCollection\"") != std::string::npos);
+        REQUIRE(report.find("\"name\":\"passing \\\"quoted\\\" \\\\ \\u0001\"") != std::string::npos);
+    }
+
+    SECTION("Writes one line per event") {
+        REQUIRE(report.find("\"result\":\"passed\"") != std::string::npos);
+        REQUIRE(report.find("\n{\"type\":\"run\",\"total\":1,\"failed\":0,\"skipped\":0}\n") != std::string::npos);
+    }
+}
+
+TEST_CASE("Test TestMetrics", "[Reporter]") {
+    PhasedTest test("phased");
+    test();
+
+    const TestMetrics& metrics = test.get_metrics();
+    REQUIRE(metrics.setup() >= std::chrono::milliseconds(20));
+    REQUIRE(metrics.run() >= std::chrono::milliseconds(10));
+    REQUIRE(metrics.teardown() >= std::chrono::nanoseconds::zero());
+    REQUIRE(metrics.cpuTimeMeasured);
+    REQUIRE(metrics.cpuTime >= std::chrono::milliseconds(5));
+    // the setup only slept
+    REQUIRE(metrics.cpuTime < metrics.setup() + metrics.run());
+    REQUIRE(metrics.queueWait() == std::chrono::nanoseconds::zero());
+
+    SECTION("The scheduler fills in the queue wait and the worker") {
+        TestController::setWorkerCount(1);
+        TestCollection collection("Metrics Collection");
+        PhasedTest first("first");
+        PhasedTest second("second");
+        collection.addTest(&first);
+        collection.addTest(&second);
+        collection.runTests();
+        TestController::setWorkerCount(0);
+
+        // with a single worker one of them waited for the other
+        auto waited = std::max(first.get_metrics().queueWait(), second.get_metrics().queueWait());
+        REQUIRE(waited >= std::chrono::milliseconds(30));
+        REQUIRE(first.get_metrics().worker == 0);
+        REQUIRE(first.get_metrics().reportStart >= first.get_metrics().teardownEnd);
+    }
+}
+
+TEST_CASE("Test TraceReporter", "[Reporter]") {
+    StringSink sink;
+    TraceReporter reporter(sink);
+
+    TestCollection collection("Trace Collection");
+    PassingTest passing("passing \"quoted\"");
+    FailingTest failing("failing");
+    passing();
+    failing();
+
+    reporter.runStarting();
+    reporter.testFinished(collection, passing);
+    reporter.testFinished(collection, failing);
+    reporter.runFinished({});
+    std::string trace = sink.str();
+
+    SECTION("Writes a complete trace document") {
+        REQUIRE(trace.starts_with("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+        REQUIRE(trace.ends_with("\n]}\n"));
+        REQUIRE(trace.find(",\n]") == std::string::npos);
+    }
+
+    SECTION("Writes one track per worker") {
+        REQUIRE(trace.find("\"args\":{\"name\":\"controller\"}") != std::string::npos);
+        REQUIRE(trace.find("\"args\":{\"name\":\"worker 0\"}") != std::string::npos);
+    }
+
+    SECTION("Writes the phases of every test") {
+        REQUIRE(trace.find("{\"name\":\"passing \\\"quoted\\\"\",\"cat\":\"test\",\"ph\":\"X\",\"pid\":1,\"tid\":1,") != std::string::npos);
+        REQUIRE(trace.find("\"result\":\"failed\"") != std::string::npos);
+        REQUIRE(trace.find("{\"name\":\"setup\",\"cat\":\"phase\"") != std::string::npos);
+        REQUIRE(trace.find("{\"name\":\"run\",\"cat\":\"phase\"") != std::string::npos);
+        REQUIRE(trace.find("{\"name\":\"teardown\",\"cat\":\"phase\"") != std::string::npos);
+        // the tests were neither queued nor reported by a controller
+        REQUIRE(trace.find("\"cat\":\"queue\"") == std::string::npos);
+        REQUIRE(trace.find("\"cat\":\"report\"") == std::string::npos);
+    }
+}
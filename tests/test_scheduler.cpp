@@ -0,0 +1,52 @@
+#include <catch2/catch.hpp>
+#include "Scheduler.hpp"
+
+#include <atomic>
+
+using PidgeonPulse::Scheduler;
+
+TEST_CASE("Test Scheduler", "[Scheduler]") {
+    SECTION("Runs every scheduled job") {
+        Scheduler scheduler(4);
+        std::atomic<int> counter = 0;
+        for ( int i = 0; i < 1000; i++ ) {
+            scheduler.schedule([&counter]() { counter++; });
+        }
+        scheduler.wait();
+        REQUIRE(counter == 1000);
+    }
+
+    SECTION("Runs jobs scheduled from within a job") {
+        Scheduler scheduler(2);
+        std::atomic<int> counter = 0;
+        for ( int i = 0; i < 10; i++ ) {
+            scheduler.schedule([&scheduler, &counter]() {
+                for ( int j = 0; j < 10; j++ ) {
+                    scheduler.schedule([&counter]() { counter++; });
+                }
+            });
+        }
+        scheduler.wait();
+        REQUIRE(counter == 100);
+    }
+
+    SECTION("Idle workers steal from a busy one") {
+        Scheduler scheduler(4);
+        std::atomic<int> counter = 0;
+        scheduler.schedule([&scheduler, &counter]() {
+            for ( int i = 0; i < 100; i++ ) {
+                scheduler.schedule([&counter]() { counter++; });
+            }
+            while ( counter < 100 ) {
+                std::this_thread::yield();
+            }
+        });
+        scheduler.wait();
+        REQUIRE(counter == 100);
+    }
+
+    SECTION("Uses the hardware concurrency by default") {
+        Scheduler scheduler;
+        REQUIRE(scheduler.getWorkerCount() == Scheduler::defaultWorkerCount());
+    }
+}
@@ -0,0 +1,177 @@
+#include <catch2/catch.hpp>
+#include "TestController.hpp"
+#include "TimingCache.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace PidgeonPulse;
+
+namespace {
+
+std::mutex gOrderMutex;
+std::vector<std::string> gOrder;
+
+class OrderedTest : public Testable {
+public:
+    using Testable::Testable;
+
+    void run() override {
+        std::lock_guard lock(gOrderMutex);
+        gOrder.push_back(get_name());
+    }
+};
+
+}
+
+TEST_CASE("Test TimingCache", "[TimingCache]") {
+    TimingCache cache;
+    uint64_t slow = TimingCache::key("Collection", "slow");
+    uint64_t fast = TimingCache::key("Collection", "fast");
+
+    SECTION("Distinguishes collection and test names") {
+        REQUIRE(TimingCache::key("a", "bc") != TimingCache::key("ab", "c"));
+        REQUIRE(slow != fast);
+    }
+
+    SECTION("Knows only recorded tests") {
+        cache.record(slow, 2.0);
+        REQUIRE(cache.lookup(slow).value() == Approx(2.0));
+        REQUIRE_FALSE(cache.lookup(fast).has_value());
+    }
+
+    SECTION("Smooths repeated measurements") {
+        cache.record(slow, 2.0);
+        cache.record(slow, 4.0);
+        REQUIRE(cache.lookup(slow).value() == Approx(3.0));
+    }
+
+    SECTION("Survives a save and load") {
+        const char* path = "test_timing_cache.timings";
+        cache.record(slow, 2.0);
+        cache.record(fast, 0.5);
+        REQUIRE(cache.save(path));
+
+        TimingCache loaded;
+        REQUIRE(loaded.load(path));
+        REQUIRE(loaded.size() == 2);
+        REQUIRE(loaded.lookup(slow).value() == Approx(2.0));
+        REQUIRE(loaded.lookup(fast).value() == Approx(0.5));
+        std::remove(path);
+    }
+
+    SECTION("Rejects missing files") {
+        REQUIRE_FALSE(cache.load("does-not-exist.timings"));
+    }
+
+    SECTION("Rejects a count beyond the end of the file") {
+        const char* path = "test_timing_cache_corrupt.timings";
+        std::FILE* file = std::fopen(path, "wb");
+        uint32_t version = 1;
+        uint64_t count = UINT64_MAX / 2;
+        std::fwrite("PPTC", 4, 1, file);
+        std::fwrite(&version, sizeof(version), 1, file);
+        std::fwrite(&count, sizeof(count), 1, file);
+        std::fclose(file);
+
+        REQUIRE_FALSE(cache.load(path));
+        REQUIRE(cache.size() == 0);
+        std::remove(path);
+    }
+}
+
+TEST_CASE("Test tests run longest first", "[TimingCache]") {
+    const char* path = "test_timing_order.timings";
+    TimingCache cache;
+    cache.record(TimingCache::key("Order", "fast"), 0.1);
+    cache.record(TimingCache::key("Order", "slow"), 3.0);
+    cache.record(TimingCache::key("Order", "medium"), 1.0);
+    REQUIRE(cache.save(path));
+
+    TestController::reset();
+    TestController::setTimingCache(path);
+    TestController::setWorkerCount(1);
+    TestCollection collection("Order");
+    OrderedTest fast("fast");
+    OrderedTest unknown("unknown");
+    OrderedTest medium("medium");
+    OrderedTest slow("slow");
+    collection.addTest(&fast);
+    collection.addTest(&unknown);
+    collection.addTest(&medium);
+    collection.addTest(&slow);
+    gOrder.clear();
+    collection.runTests();
+
+    // tests without a timing may be the slowest of all, they start first
+    REQUIRE(gOrder == std::vector<std::string>{"unknown", "slow", "medium", "fast"});
+
+    TestController::setWorkerCount(0);
+    TestController::reset();
+    std::remove(path);
+}
+
+namespace {
+
+/**
+ * @brief Run one shard of the "Shard" collection and get the names of the tests it ran
+ */
+std::vector<std::string> runShard(size_t index, size_t count, const TimingCache* timings) {
+    const char* path = "test_shard.timings";
+    TestController::reset();
+    TestController::setShard(index, count, timings != nullptr);
+    if (timings) {
+        // the run records its own timings, every shard has to start from the same ones
+        REQUIRE(timings->save(path));
+        TestController::setTimingCache(path);
+    }
+    TestController::setWorkerCount(1);
+    TestCollection collection("Shard");
+    std::vector<std::unique_ptr<OrderedTest>> tests;
+    for (const char* name : {"a", "b", "c", "d", "e", "f", "g"}) {
+        tests.push_back(std::make_unique<OrderedTest>(name));
+        collection.addTest(tests.back().get());
+    }
+    TestController::addFilter("Shard/*");
+    gOrder.clear();
+    TestController::runTests();
+    TestController::setWorkerCount(0);
+    TestController::reset();
+    std::remove(path);
+
+    std::sort(gOrder.begin(), gOrder.end());
+    return gOrder;
+}
+
+}
+
+TEST_CASE("Test shards split the tests", "[TimingCache]") {
+    TimingCache cache;
+    cache.record(TimingCache::key("Shard", "a"), 3.0);
+    cache.record(TimingCache::key("Shard", "b"), 1.0);
+    cache.record(TimingCache::key("Shard", "c"), 1.0);
+    cache.record(TimingCache::key("Shard", "d"), 1.0);
+
+    const TimingCache* byCount = nullptr;
+    for (const TimingCache* timings : {byCount, &std::as_const(cache)}) {
+        // every test runs in exactly one shard, and always in the same one
+        std::vector<std::string> all;
+        for (size_t index = 0; index < 3; index++) {
+            auto shard = runShard(index, 3, timings);
+            REQUIRE(runShard(index, 3, timings) == shard);
+            all.insert(all.end(), shard.begin(), shard.end());
+        }
+        std::sort(all.begin(), all.end());
+        REQUIRE(all == std::vector<std::string>{"a", "b", "c", "d", "e", "f", "g"});
+    }
+
+    // the unknown tests count as long as the average of 1.5 seconds
+    REQUIRE(runShard(0, 2, &cache) == std::vector<std::string>{"a", "d", "g"});
+    REQUIRE(runShard(1, 2, &cache) == std::vector<std::string>{"b", "c", "e", "f"});
+}
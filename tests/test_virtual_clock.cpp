@@ -0,0 +1,112 @@
+#include <catch2/catch.hpp>
+#include "Testable.hpp"
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+using namespace PidgeonPulse;
+using namespace std::chrono_literals;
+
+namespace {
+
+/**
+ * @brief Code under test that backs off exponentially through the current clock
+ */
+int retryWithBackoff(const std::function<bool()>& attempt, int maxAttempts) {
+    std::chrono::milliseconds delay = 100ms;
+    for ( int i = 1; i <= maxAttempts; i++ ) {
+        if ( attempt() ) {
+            return i;
+        }
+        VirtualClock::current()->sleepFor(delay);
+        delay *= 2;
+    }
+    return 0;
+}
+
+class BackoffTest : public Testable {
+public:
+    VirtualClock::TimePoint finishedAt;
+
+    BackoffTest(): Testable("backoff") {}
+
+    void run() override {
+        int calls = 0;
+        int attempts = retryWithBackoff([&calls]() { return ++calls == 20; }, 30);
+        assert_eq(attempts, 20);
+        finishedAt = get_clock().now();
+        assert_true(SimulatedClock::now() == finishedAt);
+    }
+};
+
+static_assert(std::chrono::is_clock_v<SimulatedClock>);
+
+}
+
+TEST_CASE("Test VirtualClock", "[VirtualClock]") {
+    VirtualClock clock;
+
+    SECTION("Sleeping jumps without waiting") {
+        auto start = std::chrono::steady_clock::now();
+        clock.sleepFor(1h);
+        REQUIRE(clock.now().time_since_epoch() == 1h);
+        REQUIRE(std::chrono::steady_clock::now() - start < 1s);
+    }
+
+    SECTION("Fires timers in order of their deadline, then of setting them") {
+        std::vector<int> order;
+        std::vector<VirtualClock::Duration> times;
+        clock.callAfter(30ms, [&]() { order.push_back(3); });
+        clock.callAfter(10ms, [&]() { order.push_back(1); times.push_back(clock.now().time_since_epoch()); });
+        clock.callAfter(10ms, [&]() {
+            order.push_back(2);
+            // due within the same advance
+            clock.callAfter(5ms, [&]() { order.push_back(4); times.push_back(clock.now().time_since_epoch()); });
+        });
+        auto cancelled = clock.callAfter(20ms, [&]() { order.push_back(-1); });
+        clock.callAfter(1s, [&]() { order.push_back(5); });
+
+        REQUIRE(clock.cancel(cancelled));
+        REQUIRE_FALSE(clock.cancel(cancelled));
+        REQUIRE(clock.advance(50ms) == 4);
+        REQUIRE(order == std::vector<int>{1, 2, 4, 3});
+        REQUIRE(times == std::vector<VirtualClock::Duration>{10ms, 15ms});
+        REQUIRE(clock.now().time_since_epoch() == 50ms);
+        REQUIRE(clock.pendingTimers() == 1);
+
+        REQUIRE(clock.runNext());
+        REQUIRE(order.back() == 5);
+        REQUIRE(clock.now().time_since_epoch() == 1s);
+        REQUIRE_FALSE(clock.runNext());
+    }
+
+    SECTION("Bounds timers that keep setting new ones") {
+        int ticks = 0;
+        std::function<void()> tick = [&]() {
+            ticks++;
+            clock.callAfter(1s, tick);
+        };
+        clock.callAfter(1s, tick);
+        REQUIRE(clock.runAll(100) == 100);
+        REQUIRE(ticks == 100);
+        REQUIRE(clock.now().time_since_epoch() == 100s);
+    }
+
+    SECTION("Every test run gets its own clock from zero") {
+        REQUIRE(VirtualClock::current() == nullptr);
+        REQUIRE(SimulatedClock::now().time_since_epoch() == VirtualClock::Duration::zero());
+
+        BackoffTest test;
+        auto start = std::chrono::steady_clock::now();
+        test();
+        REQUIRE(test.get_result());
+        // 100ms doubled 19 times, more than a day of sleeping
+        REQUIRE(test.finishedAt.time_since_epoch() == 100ms * ((1 << 19) - 1));
+        REQUIRE(std::chrono::steady_clock::now() - start < 1s);
+
+        test();
+        REQUIRE(test.finishedAt.time_since_epoch() == 100ms * ((1 << 19) - 1));
+        REQUIRE(VirtualClock::current() == nullptr);
+    }
+}
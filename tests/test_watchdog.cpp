@@ -0,0 +1,179 @@
+#include <catch2/catch.hpp>
+#include "TestController.hpp"
+#include "Watchdog.hpp"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace PidgeonPulse;
+using namespace std::chrono_literals;
+
+namespace {
+
+class HangingTest : public Testable {
+public:
+    std::atomic<bool> release = false;
+    std::atomic<bool> returned = false;
+
+    using Testable::Testable;
+    void run() override {
+        while ( !release ) {
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+    void teardown() override {
+        returned = true;
+        returned.notify_all();
+    }
+};
+
+class FailingLoopTest : public Testable {
+public:
+    std::atomic<bool> release = false;
+    std::atomic<bool> returned = false;
+
+    using Testable::Testable;
+    void run() override {
+        while ( !release ) {
+            fail(__FILE__, __LINE__, false);
+        }
+    }
+    void teardown() override {
+        returned = true;
+        returned.notify_all();
+    }
+};
+
+class HangingTeardownTest : public Testable {
+public:
+    std::atomic<bool> release = false;
+    std::atomic<bool> returned = false;
+
+    using Testable::Testable;
+    void run() override {}
+    void teardown() override {
+        while ( !release ) {
+            std::this_thread::sleep_for(1ms);
+        }
+        returned = true;
+        returned.notify_all();
+    }
+};
+
+class PassingTest : public Testable {
+public:
+    using Testable::Testable;
+    void run() override {}
+};
+
+}
+
+TEST_CASE("Test Watchdog", "[Watchdog]") {
+    Watchdog watchdog(1ms);
+
+    SECTION("Fires an armed timer") {
+        std::atomic<bool> fired = false;
+        watchdog.arm(5ms, [&fired]() { fired = true; fired.notify_all(); });
+        fired.wait(false);
+        REQUIRE(fired);
+    }
+
+    SECTION("Does not fire a disarmed timer") {
+        std::atomic<int> fired = 0;
+        auto timer = watchdog.arm(20ms, [&fired]() { fired++; });
+        REQUIRE(watchdog.disarm(timer));
+        watchdog.arm(40ms, [&fired]() { fired += 10; fired.notify_all(); });
+        fired.wait(0);
+        REQUIRE(fired == 10);
+        REQUIRE_FALSE(watchdog.disarm(timer));
+    }
+
+    SECTION("Fires timers beyond one turn of the wheel") {
+        std::atomic<bool> fired = false;
+        auto start = Watchdog::Clock::now();
+        watchdog.arm(300ms, [&fired]() { fired = true; fired.notify_all(); });
+        fired.wait(false);
+        REQUIRE(Watchdog::Clock::now() - start >= 300ms);
+    }
+}
+
+TEST_CASE("Test timeouts in thread mode", "[Watchdog]") {
+    TestController::setWorkerCount(1);
+
+    TestCollection collection("Timeout Collection");
+    collection.setTimeout(50ms);
+    HangingTest hanging("hanging");
+    PassingTest passing("passing");
+    collection.addTest(&hanging);
+    collection.addTest(&passing);
+    collection.runTests();
+
+    REQUIRE(hanging.timed_out());
+    REQUIRE_FALSE(hanging.get_result());
+    REQUIRE(hanging.get_fail_infos().size() == 1);
+    // the replacement worker ran the remaining test
+    REQUIRE(passing.get_result());
+    REQUIRE(TestController::getAbandonedTestCount() == 1);
+
+    // let the abandoned thread return before the test goes out of scope
+    hanging.release = true;
+    hanging.returned.wait(false);
+    TestController::setWorkerCount(0);
+}
+
+TEST_CASE("Test a test failing while the watchdog abandons it", "[Watchdog]") {
+    TestController::setWorkerCount(2);
+
+    // each round races the failures of the test against the watchdog
+    std::vector<std::unique_ptr<FailingLoopTest>> tests;
+    for ( int round = 0; round < 10; round++ ) {
+        TestCollection collection("Failing Timeout Collection " + std::to_string(round));
+        collection.setTimeout(5ms);
+        tests.push_back(std::make_unique<FailingLoopTest>("failing"));
+        collection.addTest(tests.back().get());
+        collection.runTests();
+
+        REQUIRE(tests.back()->timed_out());
+        REQUIRE(tests.back()->get_fail_infos().size() == 1);
+        REQUIRE(tests.back()->get_fail_infos().dropped() == 0);
+    }
+
+    for ( auto& test : tests ) {
+        test->release = true;
+        test->returned.wait(false);
+        // the returning thread publishes nothing
+        REQUIRE(test->timed_out());
+        REQUIRE(test->get_fail_infos().size() == 1);
+    }
+    TestController::setWorkerCount(0);
+}
+
+TEST_CASE("Test a test hanging in its teardown times out", "[Watchdog]") {
+    TestController::setWorkerCount(1);
+    size_t abandoned = TestController::getAbandonedTestCount();
+
+    TestCollection collection("Teardown Timeout Collection");
+    collection.setTimeout(50ms);
+    // the thread touches the test once more after its teardown, so it lives until the process exits
+    static auto* hanging = new HangingTeardownTest("hanging teardown");
+    PassingTest passing("passing");
+    collection.addTest(hanging);
+    collection.addTest(&passing);
+
+    auto start = std::chrono::steady_clock::now();
+    collection.runTests();
+    REQUIRE(std::chrono::steady_clock::now() - start < 5s);
+
+    REQUIRE(hanging->timed_out());
+    REQUIRE(hanging->get_fail_infos().size() == 1);
+    REQUIRE(passing.get_result());
+    REQUIRE(TestController::getAbandonedTestCount() == abandoned + 1);
+
+    hanging->release = true;
+    hanging->returned.wait(false);
+    REQUIRE(hanging->timed_out());
+    TestController::setWorkerCount(0);
+}
@@ -0,0 +1,274 @@
+/**
+ * @file MergeReports.cpp
+ * @author TL044CN
+ * @brief Combines the reports of several shards into one report
+ * @version 0.1
+ * @date 2024-04-26
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * Usage: PidgeonPulse_merge <output> <shard report>...
+ *
+ * All shard reports have to be written by the same reporter.
+ * Text, JUnit XML and JSON Lines reports are supported.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+enum class Format {
+    TEXT,
+    JUNIT,
+    JSON
+};
+
+/**
+ * @brief The merged results of one collection
+ */
+struct Collection {
+    std::string body;
+    uint64_t total = 0;
+    uint64_t failed = 0;
+    uint64_t skipped = 0;
+};
+
+/**
+ * @brief Collections in the order they were first seen
+ */
+struct Collections {
+    std::vector<std::string> order;
+    std::map<std::string, Collection> byName;
+
+    Collection& get(const std::string& name) {
+        auto [entry, inserted] = byName.try_emplace(name);
+        if ( inserted ) {
+            order.push_back(name);
+        }
+        return entry->second;
+    }
+};
+
+/**
+ * @brief The merged flaky and failing tests of one repeated run
+ */
+struct RepeatBlock {
+    std::string entries;
+    uint64_t flaky = 0;
+    uint64_t failing = 0;
+    uint64_t total = 0;
+};
+
+/**
+ * @brief Repeated runs by their header in the order they were first seen
+ *
+ * Shards that were repeated as often and with the same seed share one block,
+ * the others keep their own.
+ */
+struct RepeatBlocks {
+    std::vector<std::string> order;
+    std::map<std::string, RepeatBlock> byHeader;
+
+    RepeatBlock& get(const std::string& header) {
+        auto [entry, inserted] = byHeader.try_emplace(header);
+        if ( inserted ) {
+            order.push_back(header);
+        }
+        return entry->second;
+    }
+};
+
+Format detectFormat(const std::string& path) {
+    std::ifstream file(path);
+    char character;
+    while ( file.get(character) ) {
+        if ( character == '<' ) return Format::JUNIT;
+        if ( character == '{' ) return Format::JSON;
+        if ( character != ' ' && character != '\n' && character != '\r' && character != '\t' ) return Format::TEXT;
+    }
+    return Format::TEXT;
+}
+
+uint64_t numberAfter(std::string_view line, std::string_view key) {
+    size_t position = line.find(key);
+    if ( position == std::string_view::npos ) {
+        return 0;
+    }
+    return std::strtoull(line.data() + position + key.size(), nullptr, 10);
+}
+
+/**
+ * @brief Get the raw, still escaped value of a JSON string field
+ */
+std::string stringAfter(std::string_view line, std::string_view key) {
+    size_t start = line.find(key);
+    if ( start == std::string_view::npos ) {
+        return {};
+    }
+    start += key.size();
+    size_t end = start;
+    while ( end < line.size() && line[end] != '"' ) {
+        end += line[end] == '\\' ? 2 : 1;
+    }
+    return std::string(line.substr(start, end - start));
+}
+
+bool mergeText(const std::vector<std::string>& inputs, std::ofstream& output) {
+    Collections collections;
+    RepeatBlocks repeats;
+    for ( auto& path : inputs ) {
+        std::ifstream file(path);
+        std::string line;
+        Collection* current = nullptr;
+        RepeatBlock* repeat = nullptr;
+        while ( std::getline(file, line) ) {
+            if ( line.starts_with("Test Collection: ") ) {
+                current = &collections.get(line.substr(17));
+                repeat = nullptr;
+            } else if ( line.starts_with("Repeated ") && !current ) {
+                repeat = &repeats.get(line);
+            } else if ( line.starts_with("Stats: ") && repeat ) {
+                repeat->flaky += numberAfter(line, "Stats: ");
+                repeat->failing += numberAfter(line, " flaky, ");
+                repeat->total += numberAfter(line, " of ");
+                repeat = nullptr;
+            } else if ( repeat ) {
+                repeat->entries += line;
+                repeat->entries += '\n';
+            } else if ( line.starts_with("Stats: failed ") && current ) {
+                current->failed += numberAfter(line, "failed ");
+                current->total += numberAfter(line, " of ");
+                current->skipped += numberAfter(line, ", skipped ");
+                current = nullptr;
+            } else if ( current ) {
+                current->body += line;
+                current->body += '\n';
+            }
+        }
+    }
+
+    output << "PidgeonPulse Unit Test:\n";
+    for ( auto& name : collections.order ) {
+        auto& collection = collections.byName[name];
+        output << "Test Collection: " << name << '\n' << collection.body
+               << "Stats: failed " << collection.failed << " of " << collection.total << " tests";
+        if ( collection.skipped > 0 ) {
+            output << ", skipped " << collection.skipped;
+        }
+        output << '\n';
+    }
+    for ( auto& header : repeats.order ) {
+        auto& repeat = repeats.byHeader[header];
+        output << header << '\n' << repeat.entries << "Stats: " << repeat.flaky << " flaky, "
+               << repeat.failing << " failing of " << repeat.total << " tests\n";
+    }
+    return true;
+}
+
+bool mergeJson(const std::vector<std::string>& inputs, std::ofstream& output) {
+    Collections collections;
+    uint64_t total = 0;
+    uint64_t failed = 0;
+    uint64_t skipped = 0;
+    std::vector<std::string> repetitions;
+    for ( auto& path : inputs ) {
+        std::ifstream file(path);
+        std::string line;
+        while ( std::getline(file, line) ) {
+            if ( line.starts_with("{\"type\":\"collection\"") ) {
+                auto& collection = collections.get(stringAfter(line, "\"name\":\""));
+                collection.total += numberAfter(line, "\"total\":");
+                collection.failed += numberAfter(line, "\"failed\":");
+                collection.skipped += numberAfter(line, "\"skipped\":");
+            } else if ( line.starts_with("{\"type\":\"run\"") ) {
+                total += numberAfter(line, "\"total\":");
+                failed += numberAfter(line, "\"failed\":");
+                skipped += numberAfter(line, "\"skipped\":");
+            } else if ( line.starts_with("{\"type\":\"repetitions\"") ) {
+                // shards repeated as often with the same seed share one record
+                if ( std::find(repetitions.begin(), repetitions.end(), line) == repetitions.end() ) {
+                    repetitions.push_back(line);
+                }
+            } else if ( !line.empty() ) {
+                // test, baseline and repeat records belong to exactly one test
+                output << line << '\n';
+            }
+        }
+    }
+
+    for ( auto& name : collections.order ) {
+        auto& collection = collections.byName[name];
+        output << "{\"type\":\"collection\",\"name\":\"" << name << "\",\"total\":" << collection.total
+               << ",\"failed\":" << collection.failed << ",\"skipped\":" << collection.skipped << "}\n";
+    }
+    for ( auto& line : repetitions ) {
+        output << line << '\n';
+    }
+    output << "{\"type\":\"run\",\"total\":" << total << ",\"failed\":" << failed
+           << ",\"skipped\":" << skipped << "}\n";
+    return true;
+}
+
+bool mergeJUnit(const std::vector<std::string>& inputs, std::ofstream& output) {
+    output << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+              "<testsuites name=\"PidgeonPulse\">\n"
+              "  <testsuite name=\"PidgeonPulse\">\n";
+    for ( auto& path : inputs ) {
+        std::ifstream file(path);
+        std::string line;
+        while ( std::getline(file, line) ) {
+            // everything except the document, testsuites and testsuite elements is a testcase
+            if ( line.starts_with("<") || line.starts_with("  <testsuite") || line.starts_with("  </testsuite") ) {
+                continue;
+            }
+            output << line << '\n';
+        }
+    }
+    output << "  </testsuite>\n"
+              "</testsuites>\n";
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if ( argc < 3 ) {
+        std::fprintf(stderr, "Usage: %s <output> <shard report>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::string> inputs(argv + 2, argv + argc);
+    Format format = detectFormat(inputs.front());
+    for ( auto& input : inputs ) {
+        if ( !std::ifstream(input) ) {
+            std::fprintf(stderr, "Could not open %s\n", input.c_str());
+            return EXIT_FAILURE;
+        }
+        if ( detectFormat(input) != format ) {
+            std::fprintf(stderr, "%s was written by a different reporter\n", input.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::ofstream output(argv[1]);
+    if ( !output ) {
+        std::fprintf(stderr, "Could not open %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    bool merged = false;
+    switch ( format ) {
+    case Format::TEXT: merged = mergeText(inputs, output); break;
+    case Format::JUNIT: merged = mergeJUnit(inputs, output); break;
+    case Format::JSON: merged = mergeJson(inputs, output); break;
+    }
+
+    return merged && output.good() ? EXIT_SUCCESS : EXIT_FAILURE;
+}